@@ -25,7 +25,9 @@ HEADERS += curve.h \
     googlesatmapadapter.h \
     openaerialmapadapter.h \
     fixedimageoverlay.h \
-    emptymapadapter.h
+    emptymapadapter.h \
+    tilecache.h \
+    geometryindex.h
 SOURCES += curve.cpp \
     geometry.cpp \
     imagemanager.cpp \
@@ -49,4 +51,6 @@ SOURCES += curve.cpp \
     googlesatmapadapter.cpp \
     openaerialmapadapter.cpp \
     fixedimageoverlay.cpp \
-    emptymapadapter.cpp
+    emptymapadapter.cpp \
+    tilecache.cpp \
+    geometryindex.cpp
@@ -0,0 +1,166 @@
+/*
+*
+* This file is part of QMapControl,
+* an open-source cross-platform map widget
+*
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with QMapControl. If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*/
+
+
+#include "geometryindex.h"
+#include <cmath>
+
+namespace qmapcontrol
+{
+    GeometryIndex::GeometryIndex(qreal cellsize)
+        : cellsize(cellsize), nextSequence(0)
+    {
+    }
+
+    qint64 GeometryIndex::cellOf(const QPointF& coordinate) const
+    {
+        return cellKey(int(floor(coordinate.x() / cellsize)), int(floor(coordinate.y() / cellsize)));
+    }
+
+    void GeometryIndex::insert(Geometry* geometry, const QPointF& coordinate)
+    {
+        qint64 cell = cellOf(coordinate);
+        QHash<Geometry*, Entry>::iterator it = entries.find(geometry);
+        if (it == entries.end())
+        {
+            Entry entry;
+            entry.sequence = nextSequence++;
+            entry.coordinate = coordinate;
+            entry.cell = cell;
+            entry.bounded = true;
+            entries.insert(geometry, entry);
+            cells[cell].append(geometry);
+            return;
+        }
+
+        if (!it->bounded)
+        {
+            unbounded.remove(it->sequence);
+            it->bounded = true;
+            cells[cell].append(geometry);
+        }
+        else if (it->cell != cell)
+        {
+            QHash<qint64, QList<Geometry*> >::iterator old = cells.find(it->cell);
+            old->removeOne(geometry);
+            if (old->isEmpty())
+                cells.erase(old);
+            cells[cell].append(geometry);
+        }
+        it->coordinate = coordinate;
+        it->cell = cell;
+    }
+
+    void GeometryIndex::insertUnbounded(Geometry* geometry)
+    {
+        if (entries.contains(geometry))
+            remove(geometry);
+
+        Entry entry;
+        entry.sequence = nextSequence++;
+        entry.cell = 0;
+        entry.bounded = false;
+        entries.insert(geometry, entry);
+        unbounded.insert(entry.sequence, geometry);
+    }
+
+    void GeometryIndex::remove(Geometry* geometry)
+    {
+        QHash<Geometry*, Entry>::iterator it = entries.find(geometry);
+        if (it == entries.end())
+            return;
+
+        if (it->bounded)
+        {
+            QHash<qint64, QList<Geometry*> >::iterator cell = cells.find(it->cell);
+            cell->removeOne(geometry);
+            if (cell->isEmpty())
+                cells.erase(cell);
+        }
+        else
+        {
+            unbounded.remove(it->sequence);
+        }
+        entries.erase(it);
+    }
+
+    void GeometryIndex::clear()
+    {
+        entries.clear();
+        cells.clear();
+        unbounded.clear();
+    }
+
+    int GeometryIndex::count() const
+    {
+        return entries.count();
+    }
+
+    QList<Geometry*> GeometryIndex::query(const QRectF& area) const
+    {
+        QRectF rect = area.normalized();
+        QMap<quint32, Geometry*> found = unbounded;
+
+        int left = int(floor(rect.left() / cellsize));
+        int right = int(floor(rect.right() / cellsize));
+        int top = int(floor(rect.top() / cellsize));
+        int bottom = int(floor(rect.bottom() / cellsize));
+
+        // A large area covers more cells than are occupied, then only the occupied ones are visited
+        qint64 covered = qint64(right - left + 1) * qint64(bottom - top + 1);
+        QList<const QList<Geometry*>*> candidates;
+        if (covered <= cells.count())
+        {
+            for (int x = left; x <= right; x++)
+            {
+                for (int y = top; y <= bottom; y++)
+                {
+                    QHash<qint64, QList<Geometry*> >::const_iterator cell = cells.find(cellKey(x, y));
+                    if (cell != cells.end())
+                        candidates.append(&cell.value());
+                }
+            }
+        }
+        else
+        {
+            QHash<qint64, QList<Geometry*> >::const_iterator cell;
+            for (cell = cells.begin(); cell != cells.end(); ++cell)
+            {
+                int x = int(cell.key() >> 32);
+                int y = qint32(cell.key() & 0xffffffff);
+                if (x >= left && x <= right && y >= top && y <= bottom)
+                    candidates.append(&cell.value());
+            }
+        }
+
+        for (int i = 0; i < candidates.count(); i++)
+        {
+            foreach (Geometry* geometry, *candidates.at(i))
+            {
+                const Entry entry = entries.value(geometry);
+                if (rect.contains(entry.coordinate))
+                    found.insert(entry.sequence, geometry);
+            }
+        }
+        return found.values();
+    }
+}
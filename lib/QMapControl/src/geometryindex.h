@@ -0,0 +1,88 @@
+/*
+*
+* This file is part of QMapControl,
+* an open-source cross-platform map widget
+*
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with QMapControl. If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*/
+
+
+#ifndef GEOMETRYINDEX_H
+#define GEOMETRYINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QPointF>
+#include <QRectF>
+
+namespace qmapcontrol
+{
+    class Geometry;
+
+    //! Grid over world coordinates to find the geometries of an area
+    /*!
+     * Geometries with a single coordinate are sorted into square cells of
+     * cellsize degrees, so looking up an area only visits the cells it covers.
+     * Geometries without a single coordinate (e.g. LineStrings) are returned by
+     * every query. Queries return the geometries in insertion order, which is
+     * the order they are painted in.
+     */
+    class GeometryIndex
+    {
+    public:
+        explicit GeometryIndex(qreal cellsize = 0.001);
+
+        //! adds a geometry at a coordinate or moves it there if it is already in the index
+        void insert(Geometry* geometry, const QPointF& coordinate);
+
+        //! adds a geometry that is returned for every area
+        void insertUnbounded(Geometry* geometry);
+
+        void remove(Geometry* geometry);
+        void clear();
+        int count() const;
+
+        //! returns the geometries inside area and all unbounded geometries
+        /*!
+         * @param area the area in world coordinates, it does not need to be normalized
+         */
+        QList<Geometry*> query(const QRectF& area) const;
+
+    private:
+        struct Entry
+        {
+            quint32 sequence;
+            QPointF coordinate;
+            qint64 cell;
+            bool bounded;
+        };
+
+        qint64 cellOf(const QPointF& coordinate) const;
+        static qint64 cellKey(int x, int y)
+        {
+            return (qint64(x) << 32) | quint32(y);
+        }
+
+        qreal cellsize;
+        quint32 nextSequence;
+        QHash<Geometry*, Entry> entries;
+        QHash<qint64, QList<Geometry*> > cells;
+        QMap<quint32, Geometry*> unbounded;
+    };
+}
+#endif
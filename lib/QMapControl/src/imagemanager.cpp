@@ -24,18 +24,69 @@
 */
 
 #include "imagemanager.h"
+#include <QRunnable>
 namespace qmapcontrol
 {
+    namespace
+    {
+        //! reads one tile from the disk store and hands it back to the ImageManager
+        class DiskLoadTask : public QRunnable
+        {
+        public:
+            DiskLoadTask(QObject* manager, const TileCache& cache, const QString& url,
+                         const QString& provider, int x, int y, int z)
+                :manager(manager), cache(cache), url(url), provider(provider), x(x), y(y), z(z)
+            {
+            }
+
+            void run()
+            {
+                QImage tile;
+                cache.load(provider, z, x, y, tile);
+                QMetaObject::invokeMethod(manager, "diskLoadFinished", Qt::QueuedConnection,
+                                          Q_ARG(QString, url), Q_ARG(QImage, tile));
+            }
+
+        private:
+            QObject* manager;
+            const TileCache& cache;
+            QString url;
+            QString provider;
+            int x;
+            int y;
+            int z;
+        };
+
+        //! deletes the tiles written by older versions
+        class LegacyCleanupTask : public QRunnable
+        {
+        public:
+            LegacyCleanupTask(const QDir& path)
+                :path(path)
+            {
+            }
+
+            void run()
+            {
+                int removed = TileCache::removeLegacyTiles(path);
+                if (removed > 0)
+                {
+                    qDebug() << "QMapControl: removed" << removed << "tiles of the old cache layout from" << path.absolutePath();
+                }
+            }
+
+        private:
+            QDir path;
+        };
+    }
+
     ImageManager* ImageManager::m_Instance = 0;
     ImageManager::ImageManager(QObject* parent)
-        :QObject(parent), emptyPixmap(QPixmap(1,1)), net(new MapNetwork(this)), doPersistentCaching(false)
+        :QObject(parent), emptyPixmap(QPixmap(1,1)), net(new MapNetwork(this)), offline(false)
     {
         emptyPixmap.fill(Qt::transparent);
-
-        if (QPixmapCache::cacheLimit() <= 20000)
-        {
-            QPixmapCache::setCacheLimit(20000);	// in kb
-        }
+        // one reader is enough to keep up with the disk
+        diskPool.setMaxThreadCount(1);
     }
 
 
@@ -45,58 +96,114 @@ namespace qmapcontrol
 	{
 	    delete ImageManager::m_Instance;
 	}
+        diskPool.waitForDone();
         delete net;
     }
 
-    QPixmap ImageManager::getImage(const QString& host, const QString& url)
+    QPixmap ImageManager::getImage(const MapAdapter* mapadapter, int x, int y, int z)
     {
         //qDebug() << "ImageManager::getImage";
         QPixmap pm;
-        //pm.fill(Qt::black);
+        const QString provider = mapadapter->host() + mapadapter->serverPath;
 
-        //is image cached (memory) or currently loading?
-        if (!QPixmapCache::find(url, pm) && !net->imageIsLoading(url))
-            //	if (!images.contains(url) && !net->imageIsLoading(url))
+        //is image cached in memory?
+        if (cache.find(provider, z, x, y, pm))
         {
-            //image cached (persistent)?
-            if (doPersistentCaching && tileExist(url))
-            {
-                loadTile(url,pm);
-                QPixmapCache::insert(url.toAscii().toBase64(), pm);
-            }
-            else
+            return pm;
+        }
+
+        //currently loading or known to be unavailable offline?
+        const QString url = mapadapter->query(x, y, z);
+        if (diskRequests.contains(url) || missingTiles.contains(url) || net->imageIsLoading(url))
+        {
+            return emptyPixmap;
+        }
+
+        TileRequest request;
+        request.provider = provider;
+        request.host = mapadapter->host();
+        request.x = x;
+        request.y = y;
+        request.z = z;
+
+        //image cached persistent? the answer arrives in diskLoadFinished()
+        if (cache.isPersistent())
+        {
+            diskRequests.insert(url, request);
+            diskPool.start(new DiskLoadTask(this, cache, url, provider, x, y, z));
+        }
+        else
+        {
+            loadFromNetwork(url, request);
+        }
+        return emptyPixmap;
+    }
+
+    void ImageManager::loadFromNetwork(const QString& url, const TileRequest& request)
+    {
+        //no network allowed?
+        if (offline || net->imageIsLoading(url))
+        {
+            return;
+        }
+        //load from net, add empty image
+        requests.insert(url, request);
+        net->loadImage(request.host, url);
+    }
+
+    void ImageManager::diskLoadFinished(const QString& url, const QImage& tile)
+    {
+        if (!diskRequests.contains(url))
+        {
+            // aborted meanwhile
+            return;
+        }
+        TileRequest request = diskRequests.take(url);
+
+        if (tile.isNull())
+        {
+            if (offline)
             {
-                //load from net, add empty image
-                net->loadImage(host, url);
-                //QPixmapCache::insert(url, emptyPixmap);
-                return emptyPixmap;
+                // do not read the disk again on every repaint
+                missingTiles.insert(url);
             }
+            loadFromNetwork(url, request);
+            return;
+        }
+
+        cache.insertInMemory(request.provider, request.z, request.x, request.y, QPixmap::fromImage(tile));
+        if (!prefetch.contains(url))
+        {
+            emit(imageReceived());
+        }
+        else
+        {
+
+#ifdef Q_WS_QWS
+            prefetch.remove(prefetch.indexOf(url));
+#endif
         }
-        return pm;
     }
 
-    QPixmap ImageManager::prefetchImage(const QString& host, const QString& url)
+    QPixmap ImageManager::prefetchImage(const MapAdapter* mapadapter, int x, int y, int z)
     {
 #ifdef Q_WS_QWS
         // on mobile devices we don´t want the display resfreshing when tiles are received which are
         // prefetched... This is a performance issue, because mobile devices are very slow in
         // repainting the screen
-        prefetch.append(url);
+        prefetch.append(mapadapter->query(x, y, z));
 #endif
-        return getImage(host, url);
+        return getImage(mapadapter, x, y, z);
     }
 
-    void ImageManager::receivedImage(const QPixmap pixmap, const QString& url)
+    void ImageManager::receivedImage(const QPixmap pixmap, const QString& url, const QByteArray& data)
     {
         //qDebug() << "ImageManager::receivedImage";
-        QPixmapCache::insert(url, pixmap);
-        //images[url] = pixmap;
-
-        // needed?
-        if (doPersistentCaching && !tileExist(url) )
-            saveTile(url,pixmap);
-
-        //((Layer*)this->parent())->imageReceived();
+        if (requests.contains(url))
+        {
+            TileRequest request = requests.take(url);
+            cache.insert(request.provider, request.z, request.x, request.y, pixmap, data);
+        }
 
         if (!prefetch.contains(url))
         {
@@ -115,13 +222,13 @@ namespace qmapcontrol
     {
         emit(loadingFinished());
         //((Layer*)this->parent())->removeZoomImage();
-        //qDebug() << "size of image-map: " << images.size();
-        //qDebug() << "size: " << QPixmapCache::cacheLimit();
     }
 
     void ImageManager::abortLoading()
     {
         net->abortLoading();
+        requests.clear();
+        diskRequests.clear();
     }
     void ImageManager::setProxy(QString host, int port)
     {
@@ -130,53 +237,23 @@ namespace qmapcontrol
 
     void ImageManager::setCacheDir(const QDir& path)
     {
-        doPersistentCaching = true;
-        cacheDir = path;
-        if (!cacheDir.exists())
-        {
-            cacheDir.mkpath(cacheDir.absolutePath());
-        }
+        cache.setCacheDir(path);
+        missingTiles.clear();
+        diskPool.start(new LegacyCleanupTask(path));
     }
 
-    bool ImageManager::saveTile(QString tileName,QPixmap tileData)
+    void ImageManager::setMemoryCacheLimit(int bytes)
     {
-        tileName.replace("/","-");
-
-        QFile file(cacheDir.absolutePath() + "/" + tileName.toAscii().toBase64());
-
-        //qDebug() << "writing: " << file.fileName();
-        if (!file.open(QIODevice::ReadWrite )){
-            qDebug()<<"error reading file";
-            return false;
-        }
-        QByteArray bytes;
-        QBuffer buffer(&bytes);
-        buffer.open(QIODevice::WriteOnly);
-        tileData.save(&buffer, "PNG");
-        // FIXME This is weird - why first write in buffer and then in file?
-        file.write(bytes);
-        file.close();
-        return true;
+        cache.setMemoryLimit(bytes);
     }
-    bool ImageManager::loadTile(QString tileName,QPixmap &tileData)
-    {
-        tileName.replace("/","-");
-        QFile file(cacheDir.absolutePath() + "/" + tileName.toAscii().toBase64());
-        if (!file.open(QIODevice::ReadOnly )) {
-            return false;
-        }
-        tileData.loadFromData( file.readAll() );
 
-        file.close();
-        return true;
-    }
-    bool ImageManager::tileExist(QString tileName)
+    void ImageManager::setOfflineMode(bool offline)
     {
-        tileName.replace("/","-");
-        QFile file(cacheDir.absolutePath() + "/" + tileName.toAscii().toBase64());
-        if (file.exists())
-            return true;
-        else
-            return false;
+        this->offline = offline;
+        missingTiles.clear();
+        if (offline)
+        {
+            abortLoading();
+        }
     }
 }
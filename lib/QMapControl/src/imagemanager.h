@@ -27,13 +27,16 @@
 #define IMAGEMANAGER_H
 
 #include <QObject>
-#include <QPixmapCache>
+#include <QHash>
+#include <QSet>
 #include <QDebug>
 #include <QMutex>
-#include <QFile>
-#include <QBuffer>
 #include <QDir>
+#include <QImage>
+#include <QThreadPool>
 #include "mapnetwork.h"
+#include "mapadapter.h"
+#include "tilecache.h"
 
 namespace qmapcontrol
 {
@@ -57,18 +60,27 @@ namespace qmapcontrol
 
         ~ImageManager();
         
-        //! returns a QPixmap of the asked image
+        //! returns a QPixmap of the asked tile
         /*!
-         * If this component doesn´t have the image a network query gets started to load it.
-         * @param host the host of the image
-         * @param path the path to the image
-         * @return the pixmap of the asked image
+         * Only the memory cache is checked here, as this is called while painting. On a
+         * miss the tile is read from disk in a worker thread, and if this component doesn´t
+         * have the tile a network query gets started to load it, unless offline mode is enabled.
+         * imageReceived() is emitted once the tile is available.
+         * @param mapadapter the MapAdapter providing the tile
+         * @param x the tile column
+         * @param y the tile row
+         * @param z the zoom level
+         * @return the pixmap of the asked tile
          */
-        QPixmap getImage(const QString& host, const QString& path);
+        QPixmap getImage(const MapAdapter* mapadapter, int x, int y, int z);
 
-        QPixmap prefetchImage(const QString& host, const QString& path);
+        QPixmap prefetchImage(const MapAdapter* mapadapter, int x, int y, int z);
 
-        void receivedImage(const QPixmap pixmap, const QString& url);
+        /*!
+         * This method is called by MapNetwork when a tile was downloaded.
+         * @param data the encoded tile as received, it is stored on disk unchanged
+         */
+        void receivedImage(const QPixmap pixmap, const QString& url, const QByteArray& data);
 
         /*!
          * This method is called by MapNetwork, after all images in its queue were loaded.
@@ -101,21 +113,51 @@ namespace qmapcontrol
          */
         void setCacheDir(const QDir& path);
 
+        //! sets the memory budget for decoded tiles in bytes
+        void setMemoryCacheLimit(int bytes);
+
+        //! enables or disables offline mode
+        /*!
+         * In offline mode tiles are only served from memory and disk, no
+         * network queries are started.
+         * @param offline true to disable all network access
+         */
+        void setOfflineMode(bool offline);
+        bool isOfflineMode() const
+        {
+            return offline;
+        }
+
     private:
         ImageManager(QObject* parent = 0);
         ImageManager(const ImageManager&);
         ImageManager& operator=(const ImageManager&);
+        //! identifies a tile which is being loaded from disk or downloaded
+        struct TileRequest
+        {
+            QString provider;
+            QString host;
+            int x;
+            int y;
+            int z;
+        };
+
+        void loadFromNetwork(const QString& url, const TileRequest& request);
+
         QPixmap emptyPixmap;
         MapNetwork* net;
         QVector<QString> prefetch;
-        QDir cacheDir;
-        bool doPersistentCaching;
+        TileCache cache;
+        QHash<QString, TileRequest> requests;
+        QHash<QString, TileRequest> diskRequests;
+        QSet<QString> missingTiles; // not on disk while offline, not looked up again
+        QThreadPool diskPool; // reads tiles from disk off the GUI thread
+        bool offline;
 
         static ImageManager* m_Instance;
 
-        bool saveTile(QString tileName,QPixmap tileData);
-        bool loadTile(QString tileName,QPixmap &tileData);
-        bool tileExist(QString tileName);
+    private slots:
+        void diskLoadFinished(const QString& url, const QImage& tile);
 
     signals:
         void imageReceived();
@@ -24,10 +24,11 @@
 */
 
 #include "layer.h"
+#include "fixedimageoverlay.h"
 namespace qmapcontrol
 {
     Layer::Layer(QString layername, MapAdapter* mapadapter, enum LayerType layertype, bool takeevents)
-        :visible(true), mylayername(layername), mylayertype(layertype), mapAdapter(mapadapter), takeevents(takeevents), myoffscreenViewport(QRect(0,0,0,0))
+        :visible(true), mylayername(layername), mylayertype(layertype), mapAdapter(mapadapter), takeevents(takeevents), myoffscreenViewport(QRect(0,0,0,0)), maxPointSize(0)
     {
        draggingGeometry = false;
         //qDebug() << "creating new Layer: " << layername << ", type: " << contents;
@@ -71,6 +72,18 @@ namespace qmapcontrol
         //qDebug() << geom->getName() << ", " << geom->getPoints().at(0)->getWidget();
 
         geometries.append(geom);
+        // Points with a pixmap are painted at their coordinate only, widgets,
+        // LineStrings and image overlays are not and are always looked at
+        if (paintedAtCoordinate(geom))
+        {
+            geometryIndex.insert(geom, ((Point*)geom)->coordinate());
+            connect(geom, SIGNAL(positionChanged(Geometry*)),
+                    this, SLOT(geometryMoved(Geometry*)));
+        }
+        else
+        {
+            geometryIndex.insertUnbounded(geom);
+        }
         emit(updateRequest(geom->boundingBox()));
         //a geometry can request a redraw, e.g. when its position has been changed
         connect(geom, SIGNAL(updateRequest(QRectF)),
@@ -82,19 +95,42 @@ namespace qmapcontrol
         {
             if (geometry == geometries.at(i))
             {
-                disconnect(geometry);
+                disconnect(geometry, 0, this, 0);
                 geometries.removeAt(i);
                 //delete geometry;
             }
         }
+        geometryIndex.remove(geometry);
     }
 
     void Layer::clearGeometries()
     {
         foreach(Geometry *geometry, geometries){
-            disconnect(geometry);
+            disconnect(geometry, 0, this, 0);
         }
         geometries.clear();
+        geometryIndex.clear();
+    }
+
+    void Layer::geometryMoved(Geometry* geometry)
+    {
+        if (paintedAtCoordinate(geometry))
+        {
+            geometryIndex.insert(geometry, ((Point*)geometry)->coordinate());
+        }
+    }
+
+    bool Layer::paintedAtCoordinate(Geometry* geometry)
+    {
+        // An image overlay spans from its coordinate to its lower right corner
+        return geometry->GeometryType == "Point" && ((Point*)geometry)->widget() == 0 &&
+               dynamic_cast<FixedImageOverlay*>(geometry) == 0;
+    }
+
+    QRectF Layer::displayToCoordinate(const QRect& rect) const
+    {
+        return QRectF(mapAdapter->displayToCoordinate(rect.topLeft()),
+                      mapAdapter->displayToCoordinate(rect.bottomRight())).normalized();
     }
 
     Geometry* Layer::get_Geometry(int index)
@@ -151,16 +187,20 @@ namespace qmapcontrol
                     QPointF c = mapAdapter->displayToCoordinate(QPoint(evnt->x()-screenmiddle.x()+mapmiddle_px.x(),
                                                                        evnt->y()-screenmiddle.y()+mapmiddle_px.y()));
                     Point* tmppoint = new Point(c.x(), c.y());
-                    for (int i=0; i<geometries.count(); i++)
+                    // only points drawn close enough to the click can be touched
+                    QPoint click = mapAdapter->coordinateToDisplay(c);
+                    QRect touchable(click.x()-maxPointSize-1, click.y()-maxPointSize-1, 2*maxPointSize+2, 2*maxPointSize+2);
+                    QList<Geometry*> candidates = geometryIndex.query(displayToCoordinate(touchable));
+                    for (int i=0; i<candidates.count(); i++)
                     {
-                        if (geometries.at(i)->isVisible() && geometries.at(i)->Touches(tmppoint, mapAdapter))
+                        if (candidates.at(i)->isVisible() && candidates.at(i)->Touches(tmppoint, mapAdapter))
 
                             //if (geometries.at(i)->Touches(c, mapAdapter))
                         {
 
-                            emit(geometryClicked(geometries.at(i), QPoint(evnt->x(), evnt->y())));
+                            emit(geometryClicked(candidates.at(i), QPoint(evnt->x(), evnt->y())));
                             draggingGeometry = true;
-                            geometrySelected = geometries.at(i);
+                            geometrySelected = candidates.at(i);
                         }
                     }
                     delete tmppoint;
@@ -213,9 +253,17 @@ namespace qmapcontrol
             offset = mapmiddle_px-screenmiddle;
 
         painter->translate(-mapmiddle_px+screenmiddle);
-        for (int i=0; i<geometries.count(); i++)
+        // Points outside of the viewport are not painted anyway, so they are not even looked at
+        QList<Geometry*> visibleGeometries = geometryIndex.query(displayToCoordinate(viewport.adjusted(-1, -1, 1, 1)));
+        for (int i=0; i<visibleGeometries.count(); i++)
         {
-            geometries.at(i)->draw(painter, mapAdapter, viewport, offset);
+            Geometry* geometry = visibleGeometries.at(i);
+            geometry->draw(painter, mapAdapter, viewport, offset);
+            if (paintedAtCoordinate(geometry))
+            {
+                QSizeF drawn = geometry->boundingBox().size();
+                maxPointSize = qMax(maxPointSize, int(qMax(drawn.width(), drawn.height())));
+            }
         }
         painter->translate(mapmiddle_px-screenmiddle);
 
@@ -269,7 +317,7 @@ namespace qmapcontrol
         {
             painter->drawPixmap(-cross_x+size.width(),
                                 -cross_y+size.height(),
-                                ImageManager::instance()->getImage(mapAdapter->host(), mapAdapter->query(mapmiddle_tile_x, mapmiddle_tile_y, mapAdapter->currentZoom())));
+                                ImageManager::instance()->getImage(mapAdapter, mapmiddle_tile_x, mapmiddle_tile_y, mapAdapter->currentZoom()));
         }
 
         for (int i=-tiles_left+mapmiddle_tile_x; i<=tiles_right+mapmiddle_tile_x; i++)
@@ -283,7 +331,7 @@ namespace qmapcontrol
 
                     painter->drawPixmap(((i-mapmiddle_tile_x)*tilesize)-cross_x+size.width(),
                                         ((j-mapmiddle_tile_y)*tilesize)-cross_y+size.height(),
-                                        ImageManager::instance()->getImage(mapAdapter->host(), mapAdapter->query(i, j, mapAdapter->currentZoom())));
+                                        ImageManager::instance()->getImage(mapAdapter, i, j, mapAdapter->currentZoom()));
                     //if (QCoreApplication::hasPendingEvents())
                     //  QCoreApplication::processEvents();
                 }
@@ -303,25 +351,25 @@ namespace qmapcontrol
         for (int i=left; i<=right; i++)
         {
             if (mapAdapter->isValid(i, j, mapAdapter->currentZoom()))
-                ImageManager::instance()->prefetchImage(mapAdapter->host(), mapAdapter->query(i, j, mapAdapter->currentZoom()));
+                ImageManager::instance()->prefetchImage(mapAdapter, i, j, mapAdapter->currentZoom());
         }
         j = lower;
         for (int i=left; i<=right; i++)
         {
             if (mapAdapter->isValid(i, j, mapAdapter->currentZoom()))
-                ImageManager::instance()->prefetchImage(mapAdapter->host(), mapAdapter->query(i, j, mapAdapter->currentZoom()));
+                ImageManager::instance()->prefetchImage(mapAdapter, i, j, mapAdapter->currentZoom());
         }
         int i = left;
         for (int j=upper+1; j<=lower-1; j++)
         {
             if (mapAdapter->isValid(i, j, mapAdapter->currentZoom()))
-                ImageManager::instance()->prefetchImage(mapAdapter->host(), mapAdapter->query(i, j, mapAdapter->currentZoom()));
+                ImageManager::instance()->prefetchImage(mapAdapter, i, j, mapAdapter->currentZoom());
         }
         i = right;
         for (int j=upper+1; j<=lower-1; j++)
         {
             if (mapAdapter->isValid(i, j, mapAdapter->currentZoom()))
-                ImageManager::instance()->prefetchImage(mapAdapter->host(), mapAdapter->query(i, j, mapAdapter->currentZoom()));
+                ImageManager::instance()->prefetchImage(mapAdapter, i, j, mapAdapter->currentZoom());
         }
     }
 
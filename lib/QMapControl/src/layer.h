@@ -34,6 +34,7 @@
 #include "mapadapter.h"
 #include "layermanager.h"
 #include "geometry.h"
+#include "geometryindex.h"
 #include "point.h"
 
 #include "wmsmapadapter.h"
@@ -146,6 +147,9 @@ namespace qmapcontrol
         void zoomIn() const;
         void zoomOut() const;
         void _draw(QPainter* painter, const QPoint mapmiddle_px) const;
+        QRectF displayToCoordinate(const QRect& rect) const;
+        //! true for points that are painted around their single coordinate and can be indexed by it
+        static bool paintedAtCoordinate(Geometry* geometry);
 
         bool visible;
         QString mylayername;
@@ -154,6 +158,10 @@ namespace qmapcontrol
         QPoint screenmiddle;
 
         QList<Geometry*> geometries;
+        //! finds the geometries of the viewport or around a click without looking at all of them
+        GeometryIndex geometryIndex;
+        //! largest size in pixels a point has been drawn with, the tolerance for hit tests
+        mutable int maxPointSize;
         MapAdapter* mapAdapter;
         bool takeevents;
         mutable QRect myoffscreenViewport;
@@ -206,6 +214,10 @@ namespace qmapcontrol
          */
          Geometry* get_Geometry(int index);
 
+    private slots:
+        //! keeps the index up to date when a point changes its coordinate
+        void geometryMoved(Geometry* geometry);
+
     };
 }
 #endif
@@ -54,6 +54,7 @@ namespace qmapcontrol
     class MapAdapter : public QObject
     {
         friend class Layer;
+        friend class ImageManager;
 
         Q_OBJECT
 
@@ -462,6 +462,15 @@ namespace qmapcontrol
         ImageManager::instance()->setCacheDir(path);
     }
 
+    void MapControl::setOfflineMode(bool offline)
+    {
+        ImageManager::instance()->setOfflineMode(offline);
+        if (!offline)
+        {
+            updateRequestNew();
+        }
+    }
+
     void MapControl::setProxy(QString host, int port)
     {
         ImageManager::instance()->setProxy(host, port);
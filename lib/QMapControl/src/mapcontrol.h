@@ -200,6 +200,14 @@ namespace qmapcontrol
          */
         void enablePersistentCache ( const QDir& path=QDir::homePath() + "/QMapControl.cache" );
 
+        //! Disables all network access for map tiles
+        /*!
+         * In offline mode only tiles from the memory and persistent cache
+         * are shown. Missing tiles stay empty.
+         * @param offline true to disable network access
+         */
+        void setOfflineMode ( bool offline );
+
 
         //! Sets the proxy for HTTP connections
         /*!
@@ -93,7 +93,7 @@ namespace qmapcontrol
                     {
                         loaded += pm.size().width()*pm.size().height()*pm.depth()/8/1024;
                         qDebug() << "QMapControl: Network loaded: " << (loaded);
-                        parent->receivedImage(pm, url);
+                        parent->receivedImage(pm, url, ax);
                     }
                     else if (pm.width() == 0 || pm.height() == 0)
                     {
@@ -0,0 +1,156 @@
+/*
+*
+* This file is part of QMapControl,
+* an open-source cross-platform map widget
+*
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with QMapControl. If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*/
+
+
+#include "tilecache.h"
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+
+namespace qmapcontrol
+{
+    TileCache::TileCache()
+        :memory(64*1024*1024), persistent(false)
+    {
+    }
+
+    QString TileCache::key(const QString& provider, int zoom, int x, int y)
+    {
+        return QString("%1/%2/%3/%4").arg(provider).arg(zoom).arg(x).arg(y);
+    }
+
+    QString TileCache::tilePath(const QString& provider, int zoom, int x, int y) const
+    {
+        QMutexLocker locker(&diskMutex);
+        // Provider strings contain URL characters, use a stable hash as directory name
+        QString dir = providerDirs.value(provider);
+        if (dir.isEmpty())
+        {
+            dir = QCryptographicHash::hash(provider.toUtf8(), QCryptographicHash::Md5).toHex();
+            providerDirs.insert(provider, dir);
+        }
+        return QString("%1/%2/%3/%4/%5.tile").arg(cacheDir.absolutePath()).arg(dir).arg(zoom).arg(x).arg(y);
+    }
+
+    bool TileCache::find(const QString& provider, int zoom, int x, int y, QPixmap& tile)
+    {
+        QPixmap* cached = memory.object(key(provider, zoom, x, y));
+        if (!cached)
+            return false;
+
+        tile = *cached;
+        return true;
+    }
+
+    bool TileCache::load(const QString& provider, int zoom, int x, int y, QImage& tile) const
+    {
+        if (!persistent)
+            return false;
+
+        QFile file(tilePath(provider, zoom, x, y));
+        if (!file.open(QIODevice::ReadOnly))
+            return false;
+
+        if (!tile.loadFromData(file.readAll()))
+        {
+            qDebug() << "QMapControl: removing unreadable cached tile" << file.fileName();
+            file.remove();
+            return false;
+        }
+        return true;
+    }
+
+    void TileCache::insert(const QString& provider, int zoom, int x, int y, const QPixmap& tile, const QByteArray& data)
+    {
+        insertInMemory(provider, zoom, x, y, tile);
+
+        if (!persistent)
+            return;
+
+        QString path = tilePath(provider, zoom, x, y);
+        QDir().mkpath(QFileInfo(path).absolutePath());
+
+        // Write to a temporary file first, so an interrupted write never leaves a broken tile
+        QFile file(path + ".part");
+        if (!file.open(QIODevice::WriteOnly))
+        {
+            qDebug() << "QMapControl: could not write tile" << file.fileName();
+            return;
+        }
+        if (data.isEmpty())
+        {
+            tile.save(&file, "PNG");
+        }
+        else
+        {
+            file.write(data);
+        }
+        file.close();
+
+        QFile::remove(path);
+        file.rename(path);
+    }
+
+    void TileCache::insertInMemory(const QString& provider, int zoom, int x, int y, const QPixmap& tile)
+    {
+        memory.insert(key(provider, zoom, x, y), new QPixmap(tile), tile.width()*tile.height()*tile.depth()/8);
+    }
+
+    void TileCache::setCacheDir(const QDir& path)
+    {
+        QMutexLocker locker(&diskMutex);
+        persistent = true;
+        cacheDir = path;
+        if (!cacheDir.exists())
+        {
+            cacheDir.mkpath(cacheDir.absolutePath());
+        }
+    }
+
+    int TileCache::removeLegacyTiles(const QDir& path)
+    {
+        // Tiles of the current layout live in subdirectories, old tiles
+        // are plain files named like base64("-path-to-tile.png")
+        int removed = 0;
+        foreach (const QString& name, path.entryList(QDir::Files))
+        {
+            const QByteArray encoded = name.toAscii();
+            const QByteArray decoded = QByteArray::fromBase64(encoded);
+            if (decoded.startsWith('-') && decoded.toBase64() == encoded && QFile::remove(path.absoluteFilePath(name)))
+            {
+                removed++;
+            }
+        }
+        return removed;
+    }
+
+    void TileCache::setMemoryLimit(int bytes)
+    {
+        memory.setMaxCost(bytes);
+    }
+
+    void TileCache::clearMemory()
+    {
+        memory.clear();
+    }
+}
@@ -0,0 +1,120 @@
+/*
+*
+* This file is part of QMapControl,
+* an open-source cross-platform map widget
+*
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU Lesser General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU Lesser General Public License for more details.
+*
+* You should have received a copy of the GNU Lesser General Public License
+* along with QMapControl. If not, see <http://www.gnu.org/licenses/>.
+*
+*
+*/
+
+
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QDir>
+#include <QImage>
+#include <QMutex>
+#include <QPixmap>
+#include <QString>
+
+namespace qmapcontrol
+{
+    //! Two level cache for map tiles
+    /*!
+     * Tiles are identified by their provider, zoom level and tile
+     * coordinates. Decoded tiles are kept in memory in least recently used
+     * order up to a byte budget. If a cache directory is set, the encoded
+     * tile data is also stored on disk as <provider>/<zoom>/<x>/<y>.tile,
+     * so tiles remain available without a network connection.
+     *
+     * Only the memory cache is meant to be queried while painting, the disk
+     * store is read with load(), which is safe to call from a worker thread.
+     */
+    class TileCache
+    {
+    public:
+        TileCache();
+
+        //! returns the tile if it is in memory, the disk store is not touched
+        /*!
+         * @return true if the tile was found
+         */
+        bool find(const QString& provider, int zoom, int x, int y, QPixmap& tile);
+
+        //! reads and decodes a tile from the disk store
+        /*!
+         * This may be called from any thread. Unreadable tiles are removed.
+         * @return true if the tile was found
+         */
+        bool load(const QString& provider, int zoom, int x, int y, QImage& tile) const;
+
+        //! stores a tile in memory and, if enabled, on disk
+        /*!
+         * @param data the encoded tile as received from the server. If empty the tile is stored as PNG.
+         */
+        void insert(const QString& provider, int zoom, int x, int y, const QPixmap& tile, const QByteArray& data = QByteArray());
+
+        //! stores a tile in memory only, e.g. after it was loaded from disk
+        void insertInMemory(const QString& provider, int zoom, int x, int y, const QPixmap& tile);
+
+        //! sets the directory for the disk store and enables it
+        void setCacheDir(const QDir& path);
+        bool isPersistent() const
+        {
+            return persistent;
+        }
+
+        //! removes the tiles older versions stored directly in the cache directory
+        /*!
+         * Those were named after the base64 encoded request url, which can
+         * not be mapped back to a tile, so they are deleted instead of migrated.
+         * This may be called from any thread.
+         * @return the number of removed files
+         */
+        static int removeLegacyTiles(const QDir& path);
+
+        //! sets the memory budget in bytes of decoded tiles
+        void setMemoryLimit(int bytes);
+        int memoryLimit() const
+        {
+            return memory.maxCost();
+        }
+        //! returns the bytes of decoded tiles currently in memory
+        int memoryUsed() const
+        {
+            return memory.totalCost();
+        }
+
+        //! removes all tiles from memory, the disk store is kept
+        void clearMemory();
+
+    private:
+        TileCache(const TileCache&);
+        TileCache& operator=(const TileCache&);
+
+        static QString key(const QString& provider, int zoom, int x, int y);
+        QString tilePath(const QString& provider, int zoom, int x, int y) const;
+
+        QCache<QString, QPixmap> memory;
+        QDir cacheDir;
+        bool persistent;
+        mutable QHash<QString, QString> providerDirs;
+        mutable QMutex diskMutex; // guards cacheDir and providerDirs for load()
+    };
+}
+#endif
@@ -26,44 +26,180 @@
 */
 #include "kibertilecache.h"
 
-//TODO add readwrite lock
-
 namespace core {
     KiberTileCache::KiberTileCache()
+        :capacity(22)
+    {
+    }
+
+    KiberTileCache::~KiberTileCache()
     {
-        memoryCacheSize = 0;
-        _MemoryCacheCapacity = 22;
+        Clear();
     }
 
     void KiberTileCache::setMemoryCacheCapacity(const int &value)
     {
-        kiberCacheLock.lockForWrite();
-        _MemoryCacheCapacity=value;
-        kiberCacheLock.unlock();
+        capacity=value;
+        RemoveMemoryOverload();
     }
     int KiberTileCache::MemoryCacheCapacity()
     {
-        kiberCacheLock.lockForRead();
-        return _MemoryCacheCapacity;
-        kiberCacheLock.unlock();
+        return capacity;
+    }
+    double KiberTileCache::MemoryCacheSize()
+    {
+        qint64 bytes=0;
+        for(int i=0;i<shardCount;++i)
+        {
+            QMutexLocker locker(&shards[i].mutex);
+            bytes+=shards[i].bytes;
+        }
+        return bytes/1048576.0;
+    }
+
+    void KiberTileCache::Unlink(Shard &shard,Node* node)
+    {
+        if(node->prev) node->prev->next=node->next; else shard.head=node->next;
+        if(node->next) node->next->prev=node->prev; else shard.tail=node->prev;
+        node->prev=0;
+        node->next=0;
+    }
+    void KiberTileCache::PushFront(Shard &shard,Node* node)
+    {
+        node->prev=0;
+        node->next=shard.head;
+        if(shard.head) shard.head->prev=node; else shard.tail=node;
+        shard.head=node;
+    }
+    void KiberTileCache::Trim(Shard &shard)
+    {
+        const qint64 budget=(qint64)capacity*1048576/shardCount;
+        while(shard.bytes>budget && shard.tail)
+        {
+            Node* last=shard.tail;
+            Unlink(shard,last);
+            shard.nodes.remove(last->tile);
+            shard.bytes-=Cost(last->pic);
+            ++shard.evictions;
+            delete last;
+        }
     }
 
     void KiberTileCache::RemoveMemoryOverload()
     {
-        while(MemoryCacheSize()>MemoryCacheCapacity())
+        for(int i=0;i<shardCount;++i)
         {
-            if(cachequeue.count()>0 && list.count()>0)
-            {
+            QMutexLocker locker(&shards[i].mutex);
+            Trim(shards[i]);
+        }
 #ifdef DEBUG_MEMORY_CACHE
-                qDebug()<<"Cleaning Memory cache="<<" started with "<<cachequeue.count()<<" tile "<<"ocupying "<<memoryCacheSize<<" bytes";
+        qDebug()<<"Cleaning Memory cache="<<" ended with "<<TileCount()<<" tile "<<"ocupying "<<MemoryCacheSize()<<" Mb";
 #endif
-                RawTile first=list.dequeue();
-                memoryCacheSize-=cachequeue.value(first).size();
-                cachequeue.remove(first);
-            }
+    }
+
+    QByteArray KiberTileCache::GetTile(const RawTile &tile)
+    {
+        Shard &shard=ShardOf(tile);
+        QMutexLocker locker(&shard.mutex);
+        Node* node=shard.nodes.value(tile,0);
+        if(!node)
+        {
+            ++shard.misses;
+            return QByteArray();
+        }
+        ++shard.hits;
+        if(node!=shard.head)
+        {
+            Unlink(shard,node);
+            PushFront(shard,node);
+        }
+        return node->pic;
+    }
+    void KiberTileCache::AddTile(const RawTile &tile,const QByteArray &pic)
+    {
+        Shard &shard=ShardOf(tile);
+        QMutexLocker locker(&shard.mutex);
+        Node* node=shard.nodes.value(tile,0);
+        if(node)
+        {
+            // Replace the data of a tile which is already cached
+            shard.bytes-=Cost(node->pic);
+            node->pic=pic;
+            Unlink(shard,node);
         }
+        else
+        {
+            node=new Node(tile,pic);
+            shard.nodes.insert(tile,node);
+        }
+        PushFront(shard,node);
+        shard.bytes+=Cost(pic);
 #ifdef DEBUG_MEMORY_CACHE
-        qDebug()<<"Cleaning Memory cache="<<" ended with "<<cachequeue.count()<<" tile "<<"ocupying "<<memoryCacheSize<<" bytes";
+        qDebug()<<"Current shard memory="<<shard.bytes<<" in "<<shard.nodes.count()<<" tiles";
 #endif
+        Trim(shard);
+    }
+    void KiberTileCache::Clear()
+    {
+        for(int i=0;i<shardCount;++i)
+        {
+            QMutexLocker locker(&shards[i].mutex);
+            qDeleteAll(shards[i].nodes);
+            shards[i].nodes.clear();
+            shards[i].head=0;
+            shards[i].tail=0;
+            shards[i].bytes=0;
+        }
+    }
+
+    int KiberTileCache::TileCount()
+    {
+        int count=0;
+        for(int i=0;i<shardCount;++i)
+        {
+            QMutexLocker locker(&shards[i].mutex);
+            count+=shards[i].nodes.count();
+        }
+        return count;
+    }
+    quint64 KiberTileCache::Hits()
+    {
+        quint64 count=0;
+        for(int i=0;i<shardCount;++i)
+        {
+            QMutexLocker locker(&shards[i].mutex);
+            count+=shards[i].hits;
+        }
+        return count;
+    }
+    quint64 KiberTileCache::Misses()
+    {
+        quint64 count=0;
+        for(int i=0;i<shardCount;++i)
+        {
+            QMutexLocker locker(&shards[i].mutex);
+            count+=shards[i].misses;
+        }
+        return count;
+    }
+    quint64 KiberTileCache::Evictions()
+    {
+        quint64 count=0;
+        for(int i=0;i<shardCount;++i)
+        {
+            QMutexLocker locker(&shards[i].mutex);
+            count+=shards[i].evictions;
+        }
+        return count;
+    }
+    void KiberTileCache::ResetCounters()
+    {
+        for(int i=0;i<shardCount;++i)
+        {
+            QMutexLocker locker(&shards[i].mutex);
+            shards[i].hits=0;
+            shards[i].misses=0;
+            shards[i].evictions=0;
+        }
     }
 }
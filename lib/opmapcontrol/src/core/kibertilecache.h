@@ -29,27 +29,95 @@
 
 #include "rawtile.h"
 #include <QMutex>
-#include <QReadWriteLock>
-#include <QQueue>
+#include <QAtomicInt>
+#include <QHash>
+#include <QByteArray>
 #include <QDebug>
 #include "debugheader.h"
 namespace core {
+    /**
+    * @brief Memory cache of encoded tiles, evicted in least recently used order
+    *
+    * The cache is split into shards selected by the tile hash, each with its own
+    * lock, hash table and recency list, so loader threads rarely wait on each other.
+    * Looking up a tile moves it to the front of its shard, inserting evicts from the
+    * back until the shard is within its share of the byte budget. The budget counts
+    * the tile data and the bookkeeping of every entry.
+    */
     class KiberTileCache
     {
     public:
         KiberTileCache();
+        ~KiberTileCache();
 
+        /**
+        * @brief Sets the memory budget
+        *
+        * @param value budget in Mb
+        */
         void setMemoryCacheCapacity(const int &value);
         int MemoryCacheCapacity();
-        double MemoryCacheSize(){return memoryCacheSize/1048576.0;}
+        /**
+        * @brief Returns the memory in use in Mb
+        */
+        double MemoryCacheSize();
+        /**
+        * @brief Evicts tiles until every shard is within the budget, e.g. after the budget shrank
+        */
         void RemoveMemoryOverload();
-        QReadWriteLock kiberCacheLock;
-        QHash <RawTile,QByteArray> cachequeue;
-        QQueue <RawTile> list;
-        long memoryCacheSize;
+
+        /**
+        * @brief Returns the tile data and marks it as recently used, empty if not cached
+        */
+        QByteArray GetTile(const RawTile &tile);
+        /**
+        * @brief Inserts or replaces a tile, evicting the least recently used ones if necessary
+        */
+        void AddTile(const RawTile &tile,const QByteArray &pic);
+        /**
+        * @brief Removes all tiles, the counters are kept
+        */
+        void Clear();
+
+        int TileCount();
+        quint64 Hits();
+        quint64 Misses();
+        quint64 Evictions();
+        void ResetCounters();
     private:
-        int _MemoryCacheCapacity;
+        KiberTileCache(KiberTileCache const&);
+        KiberTileCache& operator=(KiberTileCache const&);
+
+        struct Node
+        {
+            Node(const RawTile &tile,const QByteArray &pic):tile(tile),pic(pic),prev(0),next(0){}
+            RawTile tile;
+            QByteArray pic;
+            Node* prev;
+            Node* next;
+        };
+        struct Shard
+        {
+            Shard():head(0),tail(0),bytes(0),hits(0),misses(0),evictions(0){}
+            QMutex mutex;
+            QHash<RawTile,Node*> nodes;
+            Node* head;          ///< Most recently used
+            Node* tail;          ///< Least recently used
+            qint64 bytes;
+            quint64 hits;
+            quint64 misses;
+            quint64 evictions;
+        };
+        static const int shardCount=8;
+
+        static qint64 Cost(const QByteArray &pic){return pic.size()+sizeof(Node)+sizeof(Node*)+sizeof(RawTile);}
+        Shard& ShardOf(const RawTile &tile){return shards[qHash(tile)%shardCount];}
+        static void Unlink(Shard &shard,Node* node);
+        static void PushFront(Shard &shard,Node* node);
+        void Trim(Shard &shard);
 
+        Shard shards[shardCount];
+        QAtomicInt capacity;     ///< Budget in Mb
     };
 
 
@@ -265,9 +265,9 @@ namespace core {
         return ret;
     }
 
-    bool OPMaps::ExportToGMDB(const QString &file)
+    bool OPMaps::ExportToGMDB(const QString &file,QList<RawTile> const& tiles)
     {
-        return Cache::Instance()->ImageCache.ExportMapDataToDB(Cache::Instance()->ImageCache.GtileCache()+QDir::separator()+"Data.qmdb",file);
+        return Cache::Instance()->ImageCache.ExportMapDataToDB(Cache::Instance()->ImageCache.GtileCache()+QDir::separator()+"Data.qmdb",file,tiles);
     }
     bool OPMaps::ImportFromGMDB(const QString &file)
     {
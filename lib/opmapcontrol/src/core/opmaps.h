@@ -55,7 +55,12 @@ namespace core {
 
         static OPMaps* Instance();
         bool ImportFromGMDB(const QString &file);
-        bool ExportToGMDB(const QString &file);
+        /**
+        * @brief Exports cached tiles into one database file
+        *
+        * @param tiles the tiles to export, the whole cache if empty
+        */
+        bool ExportToGMDB(const QString &file,QList<RawTile> const& tiles=QList<RawTile>());
         /// <summary>
         /// timeout for map connections
         /// </summary>
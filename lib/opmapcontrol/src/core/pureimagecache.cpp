@@ -54,6 +54,12 @@ namespace core {
         }
     }
 
+    PureImageCache::~PureImageCache()
+    {
+        // Connections of other threads are closed when these threads exit
+        connections.setLocalData(0);
+    }
+
     void PureImageCache::setGtileCache(const QString &value)
     {
         gtilecache=value;
@@ -124,6 +130,15 @@ namespace core {
         {
 #ifdef DEBUG_PUREIMAGECACHE
             qDebug()<<"CreateEmptyDB: "<<query.lastError().driverText();
+#endif //DEBUG_PUREIMAGECACHE
+            db.close();
+            return false;
+        }
+        query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
+        if(query.numRowsAffected()==-1)
+        {
+#ifdef DEBUG_PUREIMAGECACHE
+            qDebug()<<"CreateEmptyDB: "<<query.lastError().driverText();
 #endif //DEBUG_PUREIMAGECACHE
             db.close();
             return false;
@@ -185,127 +200,166 @@ namespace core {
         QSqlDatabase::removeDatabase(QLatin1String("CreateConn"));
         return true;
     }
-    bool PureImageCache::PutImageToCache(const QByteArray &tile, const MapType::Types &type,const Point &pos,const int &zoom)
+    PureImageCache::Connection::Connection(const QString &file,const QString &name)
+        :file(file),name(name),get(0),contains(0),putTile(0),putData(0),transaction(false),open(false)
     {
+        // No shared cache: its table locks would make readers fail while the writer holds a transaction
+        db=QSqlDatabase::addDatabase("QSQLITE",name);
+        db.setDatabaseName(file);
+        if(!db.open())
+        {
 #ifdef DEBUG_PUREIMAGECACHE
-        qDebug()<<"PutImageToCache Start:";//<<pos;
+            qDebug()<<"Connection: Unable to open database"<<file;
 #endif //DEBUG_PUREIMAGECACHE
-        Mcounter.lock();
-        qlonglong id=++ConnCounter;
-        Mcounter.unlock();
+            return;
+        }
         {
-            QSqlDatabase cn;
-            cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
-            QString db=gtilecache+"Data.qmdb";
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if(cn.open())
-            {
-                {
-                    QSqlQuery query(cn);
-                    query.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
-                    query.addBindValue(pos.X());
-                    query.addBindValue(pos.Y());
-                    query.addBindValue(zoom);
-
-                    query.addBindValue((int)type);
-                    query.addBindValue(QDateTime::currentDateTime().toString());
-                    query.exec();
-                }
-                {
-                    QSqlQuery query(cn);
-                    query.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
-                    query.addBindValue(tile);
-                    query.exec();
-                }
-                cn.close();
-            }
+            // Readers do not block the cache writer with a write ahead log
+            QSqlQuery query(db);
+            query.exec("PRAGMA journal_mode=WAL");
+            query.exec("PRAGMA synchronous=NORMAL");
+            // Databases created by older versions have no index
+            query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
         }
-        QSqlDatabase::removeDatabase(QString::number(id));
-        return true;
+        get=new QSqlQuery(db);
+        get->prepare("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=?)");
+        contains=new QSqlQuery(db);
+        contains->prepare("SELECT id FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=?");
+        putTile=new QSqlQuery(db);
+        putTile->prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
+        putData=new QSqlQuery(db);
+        putData->prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
+        open=true;
+    }
+    PureImageCache::Connection::~Connection()
+    {
+        if(transaction)
+            db.commit();
+        delete get;
+        delete contains;
+        delete putTile;
+        delete putData;
+        db.close();
+        // The database handle has to be released before the connection is removed
+        db=QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+    }
+    PureImageCache::Connection* PureImageCache::GetConnection()
+    {
+        QString file=gtilecache+"Data.qmdb";
+        Connection* cn=connections.localData();
+        if(cn==0 || cn->file!=file)
+        {
+            // First access from this thread or the cache location changed
+            Mcounter.lock();
+            qlonglong id=++ConnCounter;
+            Mcounter.unlock();
+            cn=new Connection(file,QString("PureImageCache%1").arg(id));
+            // Deletes the previous connection of this thread
+            connections.setLocalData(cn);
+        }
+        return cn;
+    }
+    void PureImageCache::BeginTransaction()
+    {
+        Connection* cn=GetConnection();
+        if(cn->IsOpen() && !cn->transaction)
+            cn->transaction=cn->db.transaction();
+    }
+    void PureImageCache::CommitTransaction()
+    {
+        Connection* cn=GetConnection();
+        if(cn->IsOpen() && cn->transaction)
+        {
+            cn->db.commit();
+            cn->transaction=false;
+        }
+    }
+    bool PureImageCache::PutImageToCache(const QByteArray &tile, const MapType::Types &type,const Point &pos,const int &zoom)
+    {
+#ifdef DEBUG_PUREIMAGECACHE
+        qDebug()<<"PutImageToCache Start:";//<<pos;
+#endif //DEBUG_PUREIMAGECACHE
+        Connection* cn=GetConnection();
+        if(!cn->IsOpen())
+            return false;
+        cn->putTile->addBindValue(pos.X());
+        cn->putTile->addBindValue(pos.Y());
+        cn->putTile->addBindValue(zoom);
+        cn->putTile->addBindValue((int)type);
+        cn->putTile->addBindValue(QDateTime::currentDateTime().toString());
+        if(!cn->putTile->exec())
+            return false;
+        cn->putData->addBindValue(tile);
+        return cn->putData->exec();
     }
     QByteArray PureImageCache::GetImageFromCache(MapType::Types type, Point pos, int zoom)
     {
         QByteArray ar;
-        QString dir=gtilecache;
-        Mcounter.lock();
-        qlonglong id=++ConnCounter;
-        Mcounter.unlock();
 #ifdef DEBUG_PUREIMAGECACHE
-        qDebug()<<"Cache dir="<<dir<<" Try to GET:"<<pos.X()+","+pos.Y();
+        qDebug()<<"Cache dir="<<gtilecache<<" Try to GET:"<<pos.X()+","+pos.Y();
 #endif //DEBUG_PUREIMAGECACHE
-
+        Connection* cn=GetConnection();
+        if(!cn->IsOpen())
+            return ar;
+        cn->get->addBindValue(pos.X());
+        cn->get->addBindValue(pos.Y());
+        cn->get->addBindValue(zoom);
+        cn->get->addBindValue((int)type);
+        if(cn->get->exec() && cn->get->next())
         {
-            QString db=dir+"Data.qmdb";
-            {
-                QSqlDatabase cn;
-
-                cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
-
-                cn.setDatabaseName(db);
-                cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-                if(cn.open())
-                {
-                    {
-                        QSqlQuery query(cn);
-                        query.exec(QString("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=%1 AND Y=%2 AND Zoom=%3 AND Type=%4)").arg(pos.X()).arg(pos.Y()).arg(zoom).arg((int) type));
-                        query.next();
-                        if(query.isValid())
-                        {
-                            ar=query.value(0).toByteArray();
-                        }
-                    }
-                    cn.close();
-                }
-            }
+            ar=cn->get->value(0).toByteArray();
         }
-        QSqlDatabase::removeDatabase(QString::number(id));
+        cn->get->finish();
         return ar;
     }
+    bool PureImageCache::ContainsTile(MapType::Types type, Point pos, int zoom)
+    {
+        Connection* cn=GetConnection();
+        if(!cn->IsOpen())
+            return false;
+        cn->contains->addBindValue(pos.X());
+        cn->contains->addBindValue(pos.Y());
+        cn->contains->addBindValue(zoom);
+        cn->contains->addBindValue((int)type);
+        bool ret=cn->contains->exec() && cn->contains->next();
+        cn->contains->finish();
+        return ret;
+    }
     void PureImageCache::deleteOlderTiles(int const& days)
     {
         QList<long> add;
-        bool ret=true;
-        QString dir=gtilecache;
+        QString db=gtilecache+"Data.qmdb";
+        if(!QFileInfo(db).exists())
+            return;
+        Connection* cn=GetConnection();
+        if(!cn->IsOpen())
+            return;
         {
-            QString db=dir+"Data.qmdb";
-            ret=QFileInfo(db).exists();
-            if(ret)
+            QSqlQuery query(cn->db);
+            query.exec(QString("SELECT id, X, Y, Zoom, Type, Date FROM Tiles"));
+            while(query.next())
             {
-                QSqlDatabase cn;
-                Mcounter.lock();
-                qlonglong id=++ConnCounter;
-                Mcounter.unlock();
-                cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
-                cn.setDatabaseName(db);
-                cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-                if(cn.open())
-                {
-                    {
-                        QSqlQuery query(cn);
-                        query.exec(QString("SELECT id, X, Y, Zoom, Type, Date FROM Tiles"));
-                        while(query.next())
-                        {
-                            if(QDateTime::fromString(query.value(5).toString()).daysTo(QDateTime::currentDateTime())>days)
-                                add.append(query.value(0).toLongLong());
-                        }
-                        foreach(long i,add)
-                        {
-                            query.exec(QString("DELETE FROM Tiles WHERE id = %1;").arg(i));
-                        }
-                    }
-
-                    cn.close();
-                }
-                QSqlDatabase::removeDatabase(QString::number(id));
+                if(QDateTime::fromString(query.value(5).toString()).daysTo(QDateTime::currentDateTime())>days)
+                    add.append(query.value(0).toLongLong());
+            }
+            bool batch=!cn->transaction;
+            if(batch)
+                cn->db.transaction();
+            query.prepare("DELETE FROM Tiles WHERE id = ?");
+            foreach(long i,add)
+            {
+                query.addBindValue((qlonglong)i);
+                query.exec();
             }
+            if(batch)
+                cn->db.commit();
         }
     }
     // PureImageCache::ExportMapDataToDB("C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data.qmdb","C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data2.qmdb");
-    bool PureImageCache::ExportMapDataToDB(QString sourceFile, QString destFile)
+    bool PureImageCache::ExportMapDataToDB(QString sourceFile, QString destFile, QList<RawTile> const& tiles)
     {
         bool ret=true;
-        QList<long> add;
         if(!QFileInfo(destFile).exists())
         {
 #ifdef DEBUG_PUREIMAGECACHE
@@ -314,47 +368,66 @@ namespace core {
             ret=CreateEmptyDB(destFile);
         }
         if(!ret) return false;
-        QSqlDatabase ca = QSqlDatabase::addDatabase("QSQLITE","ca");
-        ca.setDatabaseName(sourceFile);
-
-        if(ca.open())
         {
             QSqlDatabase cb = QSqlDatabase::addDatabase("QSQLITE","cb");
             cb.setDatabaseName(destFile);
             if(cb.open())
             {
                 QSqlQuery queryb(cb);
-                queryb.exec(QString("ATTACH DATABASE \"%1\" AS Source").arg(sourceFile));
-                QSqlQuery querya(ca);
-                querya.exec("SELECT id, X, Y, Zoom, Type, Date FROM Tiles");
-                while(querya.next())
+                queryb.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
+                ret=queryb.exec(QString("ATTACH DATABASE \"%1\" AS Source").arg(sourceFile));
+                if(ret)
                 {
-                    long id=querya.value(0).toLongLong();
-                    queryb.exec(QString("SELECT id FROM Tiles WHERE X=%1 AND Y=%2 AND Zoom=%3 AND Type=%4;").arg(querya.value(1).toLongLong()).arg(querya.value(2).toLongLong()).arg(querya.value(3).toLongLong()).arg(querya.value(4).toLongLong()));
-                    if(!queryb.next())
+                    QList<qlonglong> add;
+                    if(tiles.isEmpty())
                     {
-                        add.append(id);
+                        queryb.exec("SELECT id FROM Source.Tiles s WHERE NOT EXISTS "
+                                    "(SELECT id FROM main.Tiles t WHERE t.X=s.X AND t.Y=s.Y AND t.Zoom=s.Zoom AND t.Type=s.Type)");
+                        while(queryb.next())
+                        {
+                            add.append(queryb.value(0).toLongLong());
+                        }
                     }
-
-                }
-                long f;
-                foreach(f,add)
-                {
-                    queryb.exec(QString("INSERT INTO Tiles(X, Y, Zoom, Type, Date) SELECT X, Y, Zoom, Type, Date FROM Source.Tiles WHERE id=%1").arg(f));
-                    queryb.exec(QString("INSERT INTO TilesData(id, Tile) Values((SELECT last_insert_rowid()), (SELECT Tile FROM Source.TilesData WHERE id=%1))").arg(f));
+                    else
+                    {
+                        QSqlQuery find(cb);
+                        find.prepare("SELECT s.id FROM Source.Tiles s WHERE s.X=? AND s.Y=? AND s.Zoom=? AND s.Type=? AND NOT EXISTS "
+                                     "(SELECT id FROM main.Tiles t WHERE t.X=s.X AND t.Y=s.Y AND t.Zoom=s.Zoom AND t.Type=s.Type)");
+                        foreach(RawTile tile,tiles)
+                        {
+                            find.addBindValue(tile.Pos().X());
+                            find.addBindValue(tile.Pos().Y());
+                            find.addBindValue(tile.Zoom());
+                            find.addBindValue((int)tile.Type());
+                            if(find.exec() && find.next())
+                            {
+                                add.append(find.value(0).toLongLong());
+                            }
+                            find.finish();
+                        }
+                    }
+                    // One transaction for all tiles, SQLite syncs the file after every statement otherwise
+                    cb.transaction();
+                    QSqlQuery putTile(cb);
+                    putTile.prepare("INSERT INTO main.Tiles(X, Y, Zoom, Type, Date) SELECT X, Y, Zoom, Type, Date FROM Source.Tiles WHERE id=?");
+                    QSqlQuery putData(cb);
+                    putData.prepare("INSERT INTO main.TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), (SELECT Tile FROM Source.TilesData WHERE id=?))");
+                    foreach(qlonglong f,add)
+                    {
+                        putTile.addBindValue(f);
+                        putTile.exec();
+                        putData.addBindValue(f);
+                        putData.exec();
+                    }
+                    ret=cb.commit();
                 }
-                add.clear();
-                ca.close();
+                queryb.finish();
                 cb.close();
-
             }
-            else return false;
+            else ret=false;
         }
-        else return false;
-        QSqlDatabase::removeDatabase("ca");
         QSqlDatabase::removeDatabase("cb");
-        return true;
+        return ret;
 
     }
-
 }
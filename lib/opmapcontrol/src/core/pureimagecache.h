@@ -37,10 +37,12 @@
 #include <QBuffer>
 #include "maptype.h"
 #include "point.h"
+#include "rawtile.h"
 #include <QVariant>
 #include "pureimage.h"
 #include <QList>
 #include <QMutex>
+#include <QThreadStorage>
 
 namespace core {
     class PureImageCache
@@ -48,17 +50,60 @@ namespace core {
 
     public:
         PureImageCache();
+        ~PureImageCache();
         static bool CreateEmptyDB(const QString &file);
         bool PutImageToCache(const QByteArray &tile,const MapType::Types &type,const core::Point &pos, const int &zoom);
         QByteArray GetImageFromCache(MapType::Types type, core::Point pos, int zoom);
+        /**
+        * @brief Returns true if the tile is in the database, without reading its image
+        */
+        bool ContainsTile(MapType::Types type, core::Point pos, int zoom);
         QString GtileCache();
         void setGtileCache(const QString &value);
-        static bool ExportMapDataToDB(QString sourceFile, QString destFile);
+        /**
+        * @brief Copies the tiles of sourceFile that are missing in destFile
+        *
+        * @param tiles only these tiles are copied, all tiles if empty
+        */
+        static bool ExportMapDataToDB(QString sourceFile, QString destFile, QList<RawTile> const& tiles=QList<RawTile>());
         void deleteOlderTiles(int const& days);
+        /**
+        * @brief Groups all following writes of the calling thread into one transaction
+        */
+        void BeginTransaction();
+        /**
+        * @brief Commits the writes grouped since BeginTransaction
+        */
+        void CommitTransaction();
     private:
+        /**
+        * @brief Database connection of one thread together with its prepared statements
+        *
+        * A QSqlDatabase may only be used by the thread which created it, so every
+        * thread accessing the cache keeps its own connection open until it exits.
+        */
+        class Connection
+        {
+        public:
+            Connection(const QString &file,const QString &name);
+            ~Connection();
+            bool IsOpen() const{return open;}
+            QString file;
+            QString name;
+            QSqlDatabase db;
+            QSqlQuery* get;
+            QSqlQuery* contains;
+            QSqlQuery* putTile;
+            QSqlQuery* putData;
+            bool transaction;
+        private:
+            bool open;
+        };
+        Connection* GetConnection();
         QString gtilecache;
         QMutex Mcounter;
         static qlonglong ConnCounter;
+        QThreadStorage<Connection*> connections;
 
     };
 
@@ -85,15 +85,26 @@ void TileCacheQueue::run()
 #endif //DEBUG_TILECACHEQUEUE
         if(tileCacheQueue.count()>0)
         {
-            mutex.lock();
-            task=tileCacheQueue.dequeue();
-            mutex.unlock();
+            // Write everything queued so far in one transaction
+            Cache::Instance()->ImageCache.BeginTransaction();
+            for(int batch=0;batch<maxBatch;++batch)
+            {
+                mutex.lock();
+                if(tileCacheQueue.isEmpty())
+                {
+                    mutex.unlock();
+                    break;
+                }
+                task=tileCacheQueue.dequeue();
+                mutex.unlock();
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug()<<"Cache engine Put:"<<task->GetPosition().X()<<","<<task->GetPosition().Y();
+                qDebug()<<"Cache engine Put:"<<task->GetPosition().X()<<","<<task->GetPosition().Y();
 #endif //DEBUG_TILECACHEQUEUE
-            Cache::Instance()->ImageCache.PutImageToCache(task->GetImg(),task->GetMapType(),task->GetPosition(),task->GetZoom());
+                Cache::Instance()->ImageCache.PutImageToCache(task->GetImg(),task->GetMapType(),task->GetPosition(),task->GetZoom());
+                delete task;
+            }
+            Cache::Instance()->ImageCache.CommitTransaction();
             usleep(44);
-            delete task;
         }
 
         else
@@ -49,6 +49,7 @@ namespace core {
 
     protected:
         QQueue<CacheItemQueue*> tileCacheQueue;
+        static const int maxBatch=64; ///< Maximum number of tiles written in one transaction
     private:
         void run();
         QMutex mutex;
@@ -32,9 +32,37 @@ qlonglong internals::Core::debugcounter=0;
 
 using namespace projections;
 
+namespace {
+    /**
+    * @brief Orders load tasks by their distance to the focus tile. Prefetch
+    *        tasks of the next zoom level are measured from their parent tile
+    *        and always come after the tiles that are on screen.
+    */
+    struct LoadTaskLessThan
+    {
+        LoadTaskLessThan(core::Point const& focus,int zoom):focus(focus),zoom(zoom){}
+        qint64 Priority(internals::LoadTask const& task)const
+        {
+            int shift=qMax(0,task.Zoom-zoom);
+            qint64 dx=(task.Pos.X()>>shift)-focus.X();
+            qint64 dy=(task.Pos.Y()>>shift)-focus.Y();
+            qint64 ret=dx*dx+dy*dy;
+            if(task.Prefetch)
+                ret+=Q_INT64_C(1)<<40;
+            return ret;
+        }
+        bool operator()(internals::LoadTask const& lhs,internals::LoadTask const& rhs)const
+        {
+            return Priority(lhs)<Priority(rhs);
+        }
+        core::Point focus;
+        int zoom;
+    };
+}
+
 namespace internals {
     Core::Core():MouseWheelZooming(false),currentPosition(0,0),currentPositionPixel(0,0),LastLocationInBounds(-1,-1),sizeOfMapArea(0,0)
-            ,minOfTiles(0,0),maxOfTiles(0,0),zoom(0),isDragging(false),TooltipTextPadding(10,10),loaderLimit(5),maxzoom(21),started(false),runningThreads(0)
+            ,minOfTiles(0,0),maxOfTiles(0,0),loadGeneration(0),prefetchLimit(16),zoom(0),isDragging(false),TooltipTextPadding(10,10),loaderLimit(5),maxzoom(21),started(false),runningThreads(0)
     {
         mousewheelzoomtype=MouseWheelZoomType::MousePositionAndCenter;
         SetProjection(new MercatorProjection());
@@ -72,9 +100,12 @@ namespace internals {
             if(tileLoadQueue.count() > 0)
             {
                 task = tileLoadQueue.dequeue();
+                tilesInFlight.insert(task);
+                CountTilesToLoad();
                 {
 
-                    last = (tileLoadQueue.count() == 0);
+                    // prefetch tasks are always sorted behind the visible ones
+                    last = (tileLoadQueue.count() == 0 || tileLoadQueue.first().Prefetch);
 #ifdef DEBUG_CORE
                     qDebug()<<"TileLoadQueue: " << tileLoadQueue.count()<<" Point:"<<task.Pos.ToString()<<" ID="<<debug;;
 #endif //DEBUG_CORE
@@ -83,12 +114,10 @@ namespace internals {
         }
         MtileLoadQueue.unlock();
 
+        bool stale = false;
         if(task.HasValue())
             if(loaderLimit.tryAcquire(1,OPMaps::Instance()->Timeout))
             {
-            MtileToload.lock();
-            --tilesToload;
-            MtileToload.unlock();
 #ifdef DEBUG_CORE
             qDebug()<<"loadLimit semaphore aquired "<<loaderLimit.available()<<" ID="<<debug<<" TASK="<<task.Pos.ToString()<<" "<<task.Zoom;
 #endif //DEBUG_CORE
@@ -98,6 +127,32 @@ namespace internals {
 #ifdef DEBUG_CORE
                 qDebug()<<"task as value, begining get"<<" ID="<<debug;;
 #endif //DEBUG_CORE
+                MtileLoadQueue.lock();
+                stale = (task.Generation != loadGeneration);
+                MtileLoadQueue.unlock();
+                if(!stale && !task.Prefetch)
+                {
+                    // the view has moved on since the tile was queued
+                    MtileDrawingList.lock();
+                    stale = !tileDrawingList.contains(task.Pos);
+                    MtileDrawingList.unlock();
+                }
+
+                if(stale)
+                {
+#ifdef DEBUG_CORE
+                    qDebug()<<"Core::run dropping stale task "<<task.ToString()<<" ID="<<debug;
+#endif //DEBUG_CORE
+                }
+                else if(task.Prefetch)
+                {
+                    // only warms the memory and disk caches for the next zoom level
+                    foreach(MapType::Types tl,OPMaps::Instance()->GetAllLayersOfType(GetMapType()))
+                    {
+                        OPMaps::Instance()->GetImageFrom(tl, task.Pos, task.Zoom);
+                    }
+                }
+                else
                 {
                     Tile* m = Matrix.TileAt(task.Pos);
 
@@ -163,9 +218,13 @@ namespace internals {
                             while(++retry < OPMaps::Instance()->RetryLoadTile);
                         }
 
-                        if(t->Overlays.count() > 0)
+                        // zoom, map type or reload may have invalidated the task while it was loading
+                        MtileLoadQueue.lock();
+                        stale = (task.Generation != loadGeneration);
+                        if(t->Overlays.count() > 0 && !stale)
                         {
                             Matrix.SetTileAt(task.Pos,t);
+                            MtileLoadQueue.unlock();
                             emit OnNeedInvalidation();
 
 #ifdef DEBUG_CORE
@@ -175,6 +234,7 @@ namespace internals {
                         }
                         else
                         {
+                            MtileLoadQueue.unlock();
                             // emit OnTilesStillToLoad(tilesToload);
 
                             delete t;
@@ -189,12 +249,8 @@ namespace internals {
 
                 {
                     // last buddy cleans stuff ;}
-                    if(last)
+                    if(last && !task.Prefetch)
                     {
-                        OPMaps::Instance()->kiberCacheLock.lockForWrite();
-                        OPMaps::Instance()->TilesInMemory.RemoveMemoryOverload();
-                        OPMaps::Instance()->kiberCacheLock.unlock();
-
                         MtileDrawingList.lock();
                         {
                             Matrix.ClearPointsNotIn(tileDrawingList);
@@ -216,9 +272,28 @@ namespace internals {
 #ifdef DEBUG_CORE
             qDebug()<<"loaderLimit release:"+loaderLimit.available()<<" ID="<<debug;
 #endif
-            emit OnTilesStillToLoad(tilesToload<0? 0:tilesToload);
+            MtileToload.lock();
+            int toload = tilesToload;
+            MtileToload.unlock();
+            emit OnTilesStillToLoad(toload);
             loaderLimit.release();
         }
+
+        if(task.HasValue())
+        {
+            bool idle;
+            MtileLoadQueue.lock();
+            if(task.Generation == loadGeneration)
+            {
+                tilesInFlight.remove(task);
+            }
+            idle = !task.Prefetch && !stale && tileLoadQueue.isEmpty() && tilesInFlight.isEmpty();
+            MtileLoadQueue.unlock();
+            if(idle)
+            {
+                EnqueuePrefetch();
+            }
+        }
         MrunningThreads.lock();
         --runningThreads;
         MrunningThreads.unlock();
@@ -243,12 +318,9 @@ namespace internals {
             if(started)
             {
                 MtileLoadQueue.lock();
-                tileLoadQueue.clear();
-                MtileLoadQueue.unlock();
-                MtileToload.lock();
-                tilesToload=0;
-                MtileToload.unlock();
+                DropLoadQueue();
                 Matrix.Clear();
+                MtileLoadQueue.unlock();
                 GoToCurrentPositionOnZoom();
                 UpdateBounds();
                 emit OnMapDrag();
@@ -492,13 +564,10 @@ namespace internals {
 
             MtileLoadQueue.lock();
             {
-                tileLoadQueue.clear();
+                DropLoadQueue();
+                Matrix.Clear();
             }
             MtileLoadQueue.unlock();
-            MtileToload.lock();
-            tilesToload=0;
-            MtileToload.unlock();
-            Matrix.Clear();
 
             emit OnNeedInvalidation();
 
@@ -597,19 +666,102 @@ namespace internals {
     {
         if(started)
         {
-            ProcessLoadTaskCallback.waitForDone();
+            // loads that are still running see the new generation and throw
+            // their result away, so there is no need to wait for them here
             MtileLoadQueue.lock();
             {
-                tileLoadQueue.clear();
-                //tilesToload=0;
+                DropLoadQueue();
             }
             MtileLoadQueue.unlock();
-            MtileToload.lock();
-            tilesToload=0;
-            MtileToload.unlock();
-            //  ProcessLoadTaskCallback.waitForDone();
         }
     }
+    void Core::SetLoadFocus(PointLatLng const& value)
+    {
+        loadFocus=value;
+        if(started)
+        {
+            MtileLoadQueue.lock();
+            if(UpdateLoadFocusTile())
+            {
+                SortLoadQueue();
+            }
+            MtileLoadQueue.unlock();
+        }
+    }
+    void Core::DropLoadQueue()
+    {
+        ++loadGeneration;
+        tileLoadQueue.clear();
+        tilesInFlight.clear();
+        CountTilesToLoad();
+    }
+    void Core::CountTilesToLoad()
+    {
+        // derived from the queue, so dropping or pruning it can not let the count drift
+        int count=0;
+        foreach(LoadTask const& task,tileLoadQueue)
+        {
+            if(!task.Prefetch)
+                ++count;
+        }
+        MtileToload.lock();
+        tilesToload=count;
+        MtileToload.unlock();
+    }
+    bool Core::UpdateLoadFocusTile()
+    {
+        Point focus=centerTileXYLocation;
+        if(!loadFocus.IsEmpty())
+        {
+            focus=Projection()->FromPixelToTileXY(Projection()->FromLatLngToPixel(loadFocus,Zoom()));
+        }
+        bool changed=(focus!=loadFocusTile);
+        loadFocusTile=focus;
+        return changed;
+    }
+    void Core::SortLoadQueue()
+    {
+        qStableSort(tileLoadQueue.begin(),tileLoadQueue.end(),LoadTaskLessThan(loadFocusTile,Zoom()));
+    }
+    void Core::EnqueuePrefetch()
+    {
+        // children are only known for quadtree tile schemes, pergo maps are numbered bottom up
+        if(Zoom()>=MaxZoom() || GetMapType()==MapType::PergoTurkeyMap)
+            return;
+        if(Projection()->GetTileMatrixMaxXY(Zoom()+1).Width()+1!=2*(Projection()->GetTileMatrixMaxXY(Zoom()).Width()+1))
+            return;
+
+        MtileDrawingList.lock();
+        MtileLoadQueue.lock();
+        {
+            QList<LoadTask> parents;
+            foreach(Point p,tileDrawingList)
+            {
+                parents.append(LoadTask(p,Zoom()));
+            }
+            qStableSort(parents.begin(),parents.end(),LoadTaskLessThan(loadFocusTile,Zoom()));
+
+            int queued=0;
+            foreach(LoadTask const& parent,parents)
+            {
+                for(int i=0;i<4 && queued<prefetchLimit;++i)
+                {
+                    LoadTask task(Point(parent.Pos.X()*2+(i&1),parent.Pos.Y()*2+(i>>1)),Zoom()+1,true);
+                    task.Generation=loadGeneration;
+                    if(!tileLoadQueue.contains(task) && !tilesInFlight.contains(task))
+                    {
+                        tileLoadQueue.enqueue(task);
+                        ProcessLoadTaskCallback.start(this);
+                        ++queued;
+                    }
+                }
+                if(queued>=prefetchLimit)
+                    break;
+            }
+        }
+        MtileLoadQueue.unlock();
+        MtileDrawingList.unlock();
+    }
     void Core::UpdateBounds()
     {
         MtileDrawingList.lock();
@@ -623,28 +775,38 @@ namespace internals {
             emit OnTileLoadStart();
 
 
-            foreach(Point p,tileDrawingList)
+            MtileLoadQueue.lock();
             {
-                LoadTask task = LoadTask(p, Zoom());
+                // tiles that scrolled out of view are not worth loading anymore
+                for(int i=tileLoadQueue.count()-1;i>=0;--i)
                 {
-                    MtileLoadQueue.lock();
+                    if(!tileLoadQueue.at(i).Prefetch && !tileDrawingList.contains(tileLoadQueue.at(i).Pos))
                     {
-                        if(!tileLoadQueue.contains(task))
-                        {
-                            MtileToload.lock();
-                            ++tilesToload;
-                            MtileToload.unlock();
-                            tileLoadQueue.enqueue(task);
+                        tileLoadQueue.removeAt(i);
+                    }
+                }
+
+                foreach(Point p,tileDrawingList)
+                {
+                    LoadTask task = LoadTask(p, Zoom());
+                    task.Generation = loadGeneration;
+                    if(!tileLoadQueue.contains(task) && !tilesInFlight.contains(task) && Matrix.TileAt(p)==0)
+                    {
+                        tileLoadQueue.enqueue(task);
 #ifdef DEBUG_CORE
-                            qDebug()<<"Core::UpdateBounds new Task"<<task.Pos.ToString();
+                        qDebug()<<"Core::UpdateBounds new Task"<<task.Pos.ToString();
 #endif //DEBUG_CORE
-                            ProcessLoadTaskCallback.start(this);
-                        }
+                        ProcessLoadTaskCallback.start(this);
                     }
-                    MtileLoadQueue.unlock();
                 }
 
+                CountTilesToLoad();
+
+                // closest to the vehicle (or the view center) first
+                UpdateLoadFocusTile();
+                SortLoadQueue();
             }
+            MtileLoadQueue.unlock();
         }
         MtileDrawingList.unlock();
         UpdateGroundResolution();
@@ -39,6 +39,7 @@
 #include "QThreadPool"
 #include "tilematrix.h"
 #include <QQueue>
+#include <QSet>
 #include "loadtask.h"
 #include "copyrightstrings.h"
 #include "rectlatlng.h"
@@ -184,6 +185,12 @@ namespace internals {
 
         void CancelAsyncTasks();
 
+        /**
+        * @brief Sets the point whose tiles are loaded first, usually the vehicle.
+        *        An empty point falls back to the center of the view.
+        */
+        void SetLoadFocus(PointLatLng const& value);
+
         void FindTilesAround(QList<core::Point> &list);
 
         void UpdateGroundResolution();
@@ -232,6 +239,11 @@ namespace internals {
         Rectangle CurrentRegion;
 
         QQueue<LoadTask> tileLoadQueue;
+        QSet<LoadTask> tilesInFlight;
+        int loadGeneration;
+        PointLatLng loadFocus;
+        core::Point loadFocusTile;
+        int prefetchLimit;
 
         int zoom;
 
@@ -277,6 +289,14 @@ namespace internals {
         void SetCurrentPositionGPixel(core::Point const& value){currentPositionPixel = value;}
         void GoToCurrentPositionOnZoom();
 
+        // these expect MtileLoadQueue to be locked
+        void DropLoadQueue();
+        void CountTilesToLoad();
+        bool UpdateLoadFocusTile();
+        void SortLoadQueue();
+
+        void EnqueuePrefetch();
+
     };
 
 }
@@ -32,4 +32,8 @@ bool operator==(LoadTask const& lhs,LoadTask const& rhs)
 {
     return ((lhs.Pos==rhs.Pos)&&(lhs.Zoom==rhs.Zoom));
 }
+uint qHash(LoadTask const& task)
+{
+    return qHash(task.Pos)^(uint(task.Zoom)<<27);
+}
 }
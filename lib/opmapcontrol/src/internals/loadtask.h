@@ -36,20 +36,29 @@ namespace internals
 struct LoadTask
   {
      friend bool operator==(LoadTask const& lhs,LoadTask const& rhs);
+     friend uint qHash(LoadTask const& task);
   public:
     core::Point Pos;
     int Zoom;
+    /** @brief Only warms the caches, the tile is not put into the matrix */
+    bool Prefetch;
+    /** @brief Load generation the task was queued in, older tasks are stale */
+    int Generation;
 
 
-    LoadTask(Point pos, int zoom)
+    LoadTask(Point pos, int zoom, bool prefetch=false)
      {
         Pos = pos;
         Zoom = zoom;
+        Prefetch = prefetch;
+        Generation = 0;
     }
     LoadTask()
     {
         Pos=core::Point(-1,-1);
         Zoom=-1;
+        Prefetch=false;
+        Generation=0;
     }
     bool HasValue()
     {
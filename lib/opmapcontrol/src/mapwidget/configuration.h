@@ -138,6 +138,27 @@ public:
     */
     double TileMemoryUsed()const{return core::OPMaps::Instance()->TilesInMemory.MemoryCacheSize();}
 
+    /**
+    * @brief  Returns the number of tiles served from the memory cache
+    *
+    * @return
+    */
+    quint64 TileMemoryHits()const{return core::OPMaps::Instance()->TilesInMemory.Hits();}
+
+    /**
+    * @brief  Returns the number of tiles not found in the memory cache
+    *
+    * @return
+    */
+    quint64 TileMemoryMisses()const{return core::OPMaps::Instance()->TilesInMemory.Misses();}
+
+    /**
+    * @brief  Returns the number of tiles evicted from the memory cache to stay within its size
+    *
+    * @return
+    */
+    quint64 TileMemoryEvictions()const{return core::OPMaps::Instance()->TilesInMemory.Evictions();}
+
     /**
     * @brief  Sets the size of the memory for tiles
     *
@@ -90,6 +90,12 @@ namespace mapcontrol
         * @return
         */
         bool IsDragging()const{return core->IsDragging();}
+        /**
+        * @brief Tiles around this point are loaded before the rest of the view
+        *
+        * @param point LatLong point, usually the UAV position
+        */
+        void SetLoadFocus(internals::PointLatLng const& point){core->SetLoadFocus(point);}
 
         QImage lastimage;
 //        QPainter* imagePainter;
@@ -40,6 +40,8 @@ class MapRipForm : public QWidget
 public:
     explicit MapRipForm(QWidget *parent = 0);
     ~MapRipForm();
+signals:
+    void cancelled();
 public slots:
     void SetPercentage(int const& perc);
     void SetProvider(QString const& prov,int const& zoom);
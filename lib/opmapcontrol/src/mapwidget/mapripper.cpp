@@ -25,98 +25,285 @@
 * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
 */
 #include "mapripper.h"
+#include <QPainterPath>
+#include <QPainterPathStroker>
+#include <QSettings>
+#include <QStringList>
+#include <QThread>
+#include <QThreadPool>
+#include <cmath>
 namespace mapcontrol
 {
+    namespace
+    {
+        /**
+        * @brief Makes the protected sleep of QThread available to the pool threads
+        */
+        class SleepThread:public QThread
+        {
+        public:
+            static void msleep(unsigned long msecs){QThread::msleep(msecs);}
+        };
+    }
+    /**
+    * @brief Downloads all layers of one tile
+    */
+    class MapRipper::RipTask:public QRunnable
+    {
+    public:
+        RipTask(MapRipper* ripper,QVector<core::MapType::Types> const& types,core::Point const& pos,int const& zoom)
+            :ripper(ripper),types(types),pos(pos),zoom(zoom){}
+        void run()
+        {
+            bool ok=true;
+            foreach(core::MapType::Types type,types)
+            {
+                if(ripper->cancel)
+                    return;
+                // tiles already in the database are not downloaded again
+                if(Cache::Instance()->ImageCache.ContainsTile(type,pos,zoom))
+                    continue;
+                bool goodtile=false;
+                for(int retry=0;retry<3 && !goodtile && !ripper->cancel;++retry)
+                {
+                    // back off before retrying, in short steps to notice a cancel
+                    for(int waited=0;waited<500*retry && !ripper->cancel;waited+=50)
+                    {
+                        SleepThread::msleep(50);
+                    }
+                    goodtile=!OPMaps::Instance()->GetImageFrom(type,pos,zoom).isEmpty();
+                }
+                ok=ok && goodtile;
+            }
+            ripper->TileDone(ok);
+        }
+    private:
+        MapRipper* ripper;
+        QVector<core::MapType::Types> types;
+        core::Point pos;
+        int zoom;
+    };
 
-    MapRipper::MapRipper(internals::Core * core, const internals::RectLatLng & rect):sleep(100),cancel(false),progressForm(0),core(core)
+    MapRipper::MapRipper(internals::Core * core):closed(true),corridor(0),parallel(4),cancel(0),progressForm(0),core(core)
+    {
+    }
+    MapRipper::MapRipper(internals::Core * core, const internals::RectLatLng & rect):closed(true),corridor(0),parallel(4),cancel(0),progressForm(0),core(core)
     {
         if(!rect.IsEmpty())
         {
-            type=core->GetMapType();
-            progressForm=new MapRipForm;
-            area=rect;
-            zoom=core->Zoom();
-            maxzoom=core->MaxZoom();
-            points=core->Projection()->GetAreaTileList(area,zoom,0);
-            this->start();
-            progressForm->show();
-            connect(this,SIGNAL(percentageChanged(int)),progressForm,SLOT(SetPercentage(int)));
-            connect(this,SIGNAL(numberOfTilesChanged(int,int)),progressForm,SLOT(SetNumberOfTiles(int,int)));
-            connect(this,SIGNAL(providerChanged(QString,int)),progressForm,SLOT(SetProvider(QString,int)));
-            connect(this,SIGNAL(finished()),this,SLOT(finish()));
-            emit numberOfTilesChanged(0,0);
+            QList<internals::PointLatLng> corners;
+            corners<<internals::PointLatLng(rect.Top(),rect.Left())<<internals::PointLatLng(rect.Top(),rect.Right())
+                    <<internals::PointLatLng(rect.Bottom(),rect.Right())<<internals::PointLatLng(rect.Bottom(),rect.Left());
+            Begin(corners,true,0,core->Zoom(),core->GetMapType());
         }
     }
-    void MapRipper::finish()
+    MapRipper::MapRipper(internals::Core * core, const QList<internals::PointLatLng> & polygon):closed(true),corridor(0),parallel(4),cancel(0),progressForm(0),core(core)
     {
-         if(zoom<maxzoom)
-        {
-         ++zoom;
-         QMessageBox msgBox;
-         msgBox.setText(QString("Continue Ripping at zoom level %1?").arg(zoom));
-        // msgBox.setInformativeText("Do you want to save your changes?");
-         msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
-         msgBox.setDefaultButton(QMessageBox::Yes);
-         int ret = msgBox.exec();
-         if(ret==QMessageBox::Yes)
-         {
-             points.clear();
-             points=core->Projection()->GetAreaTileList(area,zoom,0);
-             this->start();
-         }
-         else
-         {
-             progressForm->close();
-             delete progressForm;
-             this->deleteLater();
-         }
-     }
+        if(polygon.count()>2)
+        {
+            Begin(polygon,true,0,core->Zoom(),core->GetMapType());
+        }
     }
+    MapRipper::MapRipper(internals::Core * core, const QList<internals::PointLatLng> & route, const double & corridor):closed(true),corridor(0),parallel(4),cancel(0),progressForm(0),core(core)
+    {
+        if(!route.isEmpty() && corridor>0)
+        {
+            Begin(route,false,corridor,core->Zoom(),core->GetMapType());
+        }
+    }
+    bool MapRipper::HasUnfinished()
+    {
+        QSettings settings;
+        return !settings.value("MAPRIPPER/SHAPE").toStringList().isEmpty();
+    }
+    MapRipper* MapRipper::ResumeUnfinished(internals::Core * core)
+    {
+        QSettings settings;
+        settings.beginGroup("MAPRIPPER");
+        QStringList coords=settings.value("SHAPE").toStringList();
+        if(coords.isEmpty())
+            return 0;
+        QList<internals::PointLatLng> shape;
+        foreach(QString const& coord,coords)
+        {
+            QStringList latlng=coord.split(",");
+            if(latlng.count()==2)
+                shape.append(internals::PointLatLng(latlng.at(0).toDouble(),latlng.at(1).toDouble()));
+        }
+        if(shape.isEmpty())
+        {
+            ClearJob();
+            return 0;
+        }
+        MapRipper* ripper=new MapRipper(core);
+        ripper->Begin(shape,settings.value("CLOSED",true).toBool(),settings.value("CORRIDOR",0).toDouble(),
+                      settings.value("ZOOM",core->Zoom()).toInt(),(core::MapType::Types)settings.value("TYPE",core->GetMapType()).toInt());
+        settings.endGroup();
+        return ripper;
+    }
+    void MapRipper::Begin(const QList<internals::PointLatLng> &shape, const bool &closed, const double &corridor, const int &zoom, const core::MapType::Types &type)
+    {
+        this->shape=shape;
+        this->closed=closed;
+        this->corridor=corridor;
+        this->zoom=zoom;
+        this->type=type;
+        maxzoom=core->MaxZoom();
+        progressForm=new MapRipForm;
+        connect(this,SIGNAL(percentageChanged(int)),progressForm,SLOT(SetPercentage(int)));
+        connect(this,SIGNAL(numberOfTilesChanged(int,int)),progressForm,SLOT(SetNumberOfTiles(int,int)));
+        connect(this,SIGNAL(providerChanged(QString,int)),progressForm,SLOT(SetProvider(QString,int)));
+        connect(progressForm,SIGNAL(cancelled()),this,SLOT(stop()));
+        connect(this,SIGNAL(finished()),this,SLOT(finish()));
+        StartZoom();
+        progressForm->show();
+    }
+    void MapRipper::StartZoom()
+    {
+        points=TilesAt(zoom);
+        SaveJob();
+        emit providerChanged(core::MapType::StrByType(type),zoom);
+        emit numberOfTilesChanged(points.count(),0);
+        this->start();
+    }
+    QList<core::Point> MapRipper::TilesAt(const int &zoom) const
+    {
+        QList<core::Point> ret;
+        internals::PureProjection* projection=core->Projection();
+        if(shape.isEmpty())
+            return ret;
 
+        QPainterPath path;
+        for(int i=0;i<shape.count();++i)
+        {
+            core::Point p=projection->FromLatLngToPixel(shape.at(i),zoom);
+            if(i==0)
+                path.moveTo(p.X(),p.Y());
+            else
+                path.lineTo(p.X(),p.Y());
+        }
+        if(closed)
+        {
+            path.closeSubpath();
+        }
+        else
+        {
+            // the corridor is given in meters, the path is in pixels of this zoom level
+            double resolution=projection->GetGroundResolution(zoom,shape.first().Lat());
+            QPainterPathStroker stroker;
+            stroker.setWidth(qMax(1.0,2*corridor/resolution));
+            stroker.setCapStyle(Qt::RoundCap);
+            stroker.setJoinStyle(Qt::RoundJoin);
+            path=stroker.createStroke(path);
+            path.setFillRule(Qt::WindingFill);
+        }
 
-    void MapRipper::run()
+        Size tile=projection->TileSize();
+        Size min=projection->GetTileMatrixMinXY(zoom);
+        Size max=projection->GetTileMatrixMaxXY(zoom);
+        QRectF bounds=path.boundingRect();
+        int left=qMax(min.Width(),(int)floor(bounds.left()/tile.Width()));
+        int right=qMin(max.Width(),(int)floor(bounds.right()/tile.Width()));
+        int top=qMax(min.Height(),(int)floor(bounds.top()/tile.Height()));
+        int bottom=qMin(max.Height(),(int)floor(bounds.bottom()/tile.Height()));
+        for(int y=top;y<=bottom;++y)
+        {
+            for(int x=left;x<=right;++x)
+            {
+                if(path.intersects(QRectF(x*tile.Width(),y*tile.Height(),tile.Width(),tile.Height())))
+                    ret.append(core::Point(x,y));
+            }
+        }
+        return ret;
+    }
+    void MapRipper::SaveJob()
     {
-        int countOk = 0;
-        bool goodtile=false;
-        //  Stuff.Shuffle<Point>(ref list);
-        QVector<core::MapType::Types> types = OPMaps::Instance()->GetAllLayersOfType(type);
+        QStringList coords;
+        foreach(internals::PointLatLng const& p,shape)
+        {
+            coords.append(QString("%1,%2").arg(p.Lat(),0,'g',12).arg(p.Lng(),0,'g',12));
+        }
+        QSettings settings;
+        settings.beginGroup("MAPRIPPER");
+        settings.setValue("SHAPE",coords);
+        settings.setValue("CLOSED",closed);
+        settings.setValue("CORRIDOR",corridor);
+        settings.setValue("ZOOM",zoom);
+        settings.setValue("TYPE",(int)type);
+        settings.endGroup();
+    }
+    void MapRipper::ClearJob()
+    {
+        QSettings settings;
+        settings.remove("MAPRIPPER");
+    }
+    void MapRipper::TileDone(const bool &ok)
+    {
+        if(!ok)
+            failed.ref();
+        int count=done.fetchAndAddOrdered(1)+1;
         int all=points.count();
-        for(int i = 0; i < all; i++)
+        emit numberOfTilesChanged(all,count);
+        emit percentageChanged((int) (count*100/all));
+    }
+    void MapRipper::stop()
+    {
+        cancel=1;
+    }
+    void MapRipper::finish()
+    {
+        // an interrupted rip stays saved and can be resumed later
+        if(cancel)
         {
-            emit numberOfTilesChanged(all,i+1);
-            if(cancel)
-                break;
-
-            core::Point p = points[i];
+            progressForm->close();
+            delete progressForm;
+            this->deleteLater();
+            return;
+        }
+        if(failed>0)
+        {
+            QMessageBox msgBox;
+            msgBox.setText(QString("%1 tiles could not be downloaded at zoom level %2. Retry them?").arg((int)failed).arg(zoom));
+            msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+            msgBox.setDefaultButton(QMessageBox::Yes);
+            if(msgBox.exec()==QMessageBox::Yes)
             {
-                //qDebug()<<"offline fetching:"<<p.ToString();
-                foreach(core::MapType::Types type,types)
-                {
-                    emit providerChanged(core::MapType::StrByType(type),zoom);
-                    QByteArray img = OPMaps::Instance()->GetImageFrom(type, p, zoom);
-                    if(img.length()!=0)
-                    {
-                        goodtile=true;
-                        img=NULL;
-                    }
-                    else
-                        goodtile=false;
-                }
-                if(goodtile)
-                {
-                    countOk++;
-                }
-                else
-                {
-                    i--;
-                    QThread::msleep(1000);
-                    continue;
-                }
+                StartZoom();
+                return;
+            }
+        }
+        if(zoom<maxzoom)
+        {
+            ++zoom;
+            SaveJob();
+            QMessageBox msgBox;
+            msgBox.setText(QString("Continue Ripping at zoom level %1?").arg(zoom));
+            msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+            msgBox.setDefaultButton(QMessageBox::Yes);
+            if(msgBox.exec()==QMessageBox::Yes)
+            {
+                StartZoom();
+                return;
             }
-            emit percentageChanged((int) ((i+1)*100/all));//, i+1);
-            // worker.ReportProgress((int) ((i+1)*100/all), i+1);
+        }
+        ClearJob();
+        progressForm->close();
+        delete progressForm;
+        this->deleteLater();
+    }
 
-            QThread::msleep(sleep);
+
+    void MapRipper::run()
+    {
+        done=0;
+        failed=0;
+        QVector<core::MapType::Types> types = OPMaps::Instance()->GetAllLayersOfType(type);
+        QThreadPool pool;
+        pool.setMaxThreadCount(parallel);
+        foreach(core::Point const& p,points)
+        {
+            pool.start(new RipTask(this,types,p,zoom));
         }
+        pool.waitForDone();
     }
 }
@@ -28,25 +28,69 @@
 #define MAPRIPPER_H
 
 #include <QThread>
+#include <QRunnable>
+#include <QAtomicInt>
 #include "../internals/core.h"
 #include "mapripform.h"
 #include <QObject>
 #include <QMessageBox>
 namespace mapcontrol
 {
+    /**
+    * @brief Downloads all tiles of an area into the tile database, one zoom level after another
+    *
+    * Tiles are fetched by a bounded pool of workers and tiles already in the database are
+    * skipped. The job is kept in the settings until it is finished, so an interrupted
+    * rip can be resumed with ResumeUnfinished().
+    */
     class MapRipper:public QThread
     {
         Q_OBJECT
     public:
         MapRipper(internals::Core *,internals::RectLatLng const&);
+        /**
+        * @brief Rips all tiles touched by a polygon, e.g. a survey area
+        */
+        MapRipper(internals::Core *,QList<internals::PointLatLng> const& polygon);
+        /**
+        * @brief Rips all tiles within a corridor around a route, e.g. a mission
+        *
+        * @param corridor distance to the route in meters
+        */
+        MapRipper(internals::Core *,QList<internals::PointLatLng> const& route,double const& corridor);
+        /**
+        * @brief Continues the rip an earlier session did not finish
+        *
+        * @return the ripper or 0 if there is nothing to resume
+        */
+        static MapRipper* ResumeUnfinished(internals::Core *);
+        /**
+        * @brief Returns true if a rip was interrupted before it finished
+        */
+        static bool HasUnfinished();
         void run();
     private:
+        class RipTask;
+
+        explicit MapRipper(internals::Core *);
+        void Begin(QList<internals::PointLatLng> const& shape,bool const& closed,double const& corridor,int const& zoom,core::MapType::Types const& type);
+        void StartZoom();
+        QList<core::Point> TilesAt(int const& zoom)const;
+        void TileDone(bool const& ok);
+        void SaveJob();
+        static void ClearJob();
+
         QList<core::Point> points;
+        QList<internals::PointLatLng> shape;
+        bool closed;
+        double corridor;
         int zoom;
         core::MapType::Types type;
-        int sleep;
-        internals::RectLatLng area;
-        bool cancel;
+        // tiles downloaded at the same time
+        int parallel;
+        QAtomicInt cancel;
+        QAtomicInt done;
+        QAtomicInt failed;
         MapRipForm * progressForm;
         int maxzoom;
         internals::Core * core;
@@ -59,6 +103,7 @@ namespace mapcontrol
 
     public slots:
         void finish();
+        void stop();
     };
 }
 #endif // MAPRIPPER_H
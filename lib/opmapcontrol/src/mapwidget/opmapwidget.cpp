@@ -85,6 +85,7 @@ namespace mapcontrol
         {
             UAV=new UAVItem(map,this);
             UAV->setParentItem(map);
+            UAV->SetFocusLoading(true);
             connect(this,SIGNAL(UAVLeftSafetyBouble(internals::PointLatLng)),UAV,SIGNAL(UAVLeftSafetyBouble(internals::PointLatLng)));
             connect(this,SIGNAL(UAVReachedWayPoint(int,WayPointItem*)),UAV,SIGNAL(UAVReachedWayPoint(int,WayPointItem*)));
         }
@@ -92,6 +93,7 @@ namespace mapcontrol
         {
             if(UAV!=0)
             {
+                UAV->SetFocusLoading(false);
                 delete UAV;
                 UAV=0;
             }
@@ -344,4 +346,29 @@ namespace mapcontrol
     {
         new MapRipper(core,map->SelectedArea());
     }
+    void OPMapWidget::ResumeRipMap()
+    {
+        MapRipper::ResumeUnfinished(core);
+    }
+    bool OPMapWidget::ExportTilePack(QString const& file,int const& maxZoom)
+    {
+        internals::RectLatLng area=map->SelectedArea();
+        if(area.IsEmpty())
+            area=core->CurrentViewArea();
+        QList<core::RawTile> tiles;
+        QVector<MapType::Types> types=OPMaps::Instance()->GetAllLayersOfType(core->GetMapType());
+        for(int zoom=core->Zoom();zoom<=qMin(maxZoom,core->MaxZoom());++zoom)
+        {
+            foreach(core::Point p,core->Projection()->GetAreaTileList(area,zoom,0))
+            {
+                foreach(MapType::Types type,types)
+                    tiles.append(core::RawTile(type,p,zoom));
+            }
+        }
+        return OPMaps::Instance()->ExportToGMDB(file,tiles);
+    }
+    bool OPMapWidget::ImportTilePack(QString const& file)
+    {
+        return OPMaps::Instance()->ImportFromGMDB(file);
+    }
 }
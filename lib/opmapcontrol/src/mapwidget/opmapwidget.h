@@ -473,6 +473,22 @@ namespace mapcontrol
         * @brief Ripps the current selection to the DB
         */
         void RipMap();
+        /**
+        * @brief Continues a rip that was interrupted, does nothing if there is none
+        */
+        void ResumeRipMap();
+        /**
+        * @brief Writes the cached tiles of the current selection into one file
+        *
+        * @param file the tile pack to create or extend
+        * @param maxZoom the highest zoom level to export, starting at the current one
+        * @return true if the pack could be written
+        */
+        bool ExportTilePack(QString const& file,int const& maxZoom);
+        /**
+        * @brief Adds the tiles of a pack written by ExportTilePack to the cache
+        */
+        bool ImportTilePack(QString const& file);
 
     };
 }
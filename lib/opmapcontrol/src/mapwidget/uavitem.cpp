@@ -29,7 +29,7 @@
 namespace mapcontrol
 {
     UAVItem::UAVItem(MapGraphicItem* map,OPMapWidget* parent):map(map),mapwidget(parent),showtrail(true),trailtime(5),traildistance(50),autosetreached(true)
-    ,autosetdistance(100)
+    ,autosetdistance(100),focusloading(false)
     {
         pic.load(QString::fromUtf8(":/markers/images/mapquad.png"));
        // Don't scale but trust the image we are given
@@ -53,6 +53,14 @@ namespace mapcontrol
     {
         delete trail;
     }
+    void UAVItem::SetFocusLoading(bool const& value)
+    {
+        if(value==focusloading)
+            return;
+        focusloading=value;
+        // an empty focus makes the map load around the view center again
+        map->SetLoadFocus(value? coord:internals::PointLatLng::Empty);
+    }
 
     void UAVItem::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
     {
@@ -92,6 +100,8 @@ namespace mapcontrol
             }
             coord=position;
             this->altitude=altitude;
+            if(focusloading)
+                map->SetLoadFocus(coord);
             RefreshPos();
             if(mapfollowtype==UAVMapFollowType::CenterAndRotateMap||mapfollowtype==UAVMapFollowType::CenterMap)
             {
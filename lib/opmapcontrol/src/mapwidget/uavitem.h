@@ -176,6 +176,18 @@ namespace mapcontrol
         * @param value
         */
         void SetAutoSetDistance(double const& value){autosetdistance=value;}
+        /**
+        * @brief Returns true if tiles around this UAV are loaded first
+        *
+        * @return bool
+        */
+        bool FocusLoading()const{return focusloading;}
+        /**
+        * @brief Defines if tiles around this UAV are loaded first, should only be set for the active UAV
+        *
+        * @param value
+        */
+        void SetFocusLoading(bool const& value);
 
         int type() const;
     private:
@@ -197,6 +209,7 @@ namespace mapcontrol
         bool autosetreached;
         double Distance3D(internals::PointLatLng const& coord, int const& altitude);
         double autosetdistance;
+        bool focusloading;
       //  QRectF rect;
 
     public slots:
@@ -5,9 +5,11 @@
 #-------------------------------------------------
 
 QT       += network \
+            opengl \
             phonon \
             testlib \
-            svg
+            svg \
+            sql
 
 TEMPLATE = app
 
@@ -94,13 +96,19 @@ INCLUDEPATH += . \
     $$BASEDIR/../mavlink/include \
     $$BASEDIR/src/uas \
     $$BASEDIR/src/comm \
+    $$BASEDIR/src/input \
     $$BASEDIR/src/ \
     $$BASEDIR/src/ui/RadioCalibration \
     $$BASEDIR/src/ui/ \
+    $$BASEDIR/src/ui/map3D \
+    $$BASEDIR/src/ui/map \
+    $$BASEDIR/lib/opmapcontrol/src/core \
+    $$BASEDIR/lib/QMapControl/src \
 
 
 SOURCES +=  src/uas/UAS.cc \
             src/comm/MAVLinkProtocol.cc \
+            src/comm/MAVLinkRouter.cc \
             src/uas/UASWaypointManager.cc \
             src/Waypoint.cc \
             src/ui/RadioCalibration/RadioCalibrationData.cc \
@@ -115,12 +123,46 @@ SOURCES +=  src/uas/UAS.cc \
             $$TESTDIR/SlugsMavUnitTest.cc \
             $$TESTDIR/testSuite.cc \
             $$TESTDIR/UASUnitTest.cc \
+            src/ui/HDDisplayGaugeTable.cc \
+            $$TESTDIR/HDDisplayGaugeTableTest.cc \
+            src/ui/QGCVideoFramePool.cc \
+            $$TESTDIR/QGCVideoFramePoolTest.cc \
+            src/uas/QGCImageTransfer.cc \
+            $$TESTDIR/QGCImageTransferTest.cc \
+            lib/opmapcontrol/src/core/pureimagecache.cpp \
+            lib/opmapcontrol/src/core/point.cpp \
+            lib/opmapcontrol/src/core/size.cpp \
+            $$TESTDIR/PureImageCacheTest.cc \
+            lib/opmapcontrol/src/core/rawtile.cpp \
+            lib/opmapcontrol/src/core/kibertilecache.cpp \
+            $$TESTDIR/KiberTileCacheTest.cc \
+            lib/QMapControl/src/geometryindex.cpp \
+            $$TESTDIR/GeometryIndexTest.cc \
+            src/input/PointCloudProjector.cc \
+            $$TESTDIR/PointCloudProjectorTest.cc \
+            src/input/VoxelGrid.cc \
+            src/input/OccupancyMap.cc \
+            $$TESTDIR/VoxelGridTest.cc \
+            $$TESTDIR/TripleBufferTest.cc \
+            $$TESTDIR/MAVLinkRouterTest.cc \
+            src/ui/map3D/WebImage.cc \
+            src/ui/map3D/WebImageCache.cc \
+            $$TESTDIR/WebImageCacheTest.cc \
+            lib/QMapControl/src/geometry.cpp \
+            lib/QMapControl/src/mapadapter.cpp \
+            src/ui/map/MAV2DTrail.cc \
+            $$TESTDIR/MAV2DTrailTest.cc \
+            lib/QMapControl/src/tilecache.cpp \
+            $$TESTDIR/TileCacheTest.cc \
+            src/comm/UDPLink.cc \
+            $$TESTDIR/UDPLinkTest.cc \
     src/uas/QGCMAVLinkUASFactory.cc
 
 
 HEADERS += src/uas/UASInterface.h \
             src/uas/UAS.h \
             src/comm/MAVLinkProtocol.h \
+            src/comm/MAVLinkRouter.h \
             src/comm/ProtocolInterface.h \
             src/uas/UASWaypointManager.h \
             src/Waypoint.h \
@@ -138,6 +180,38 @@ HEADERS += src/uas/UASInterface.h \
             $$TESTDIR//SlugsMavUnitTest.h \
             $$TESTDIR/AutoTest.h \
             $$TESTDIR/UASUnitTest.h \
+            src/ui/HDDisplayGaugeTable.h \
+            $$TESTDIR/HDDisplayGaugeTableTest.h \
+            src/ui/QGCVideoFramePool.h \
+            $$TESTDIR/QGCVideoFramePoolTest.h \
+            src/uas/QGCImageTransfer.h \
+            $$TESTDIR/QGCImageTransferTest.h \
+            lib/opmapcontrol/src/core/maptype.h \
+            lib/opmapcontrol/src/core/pureimagecache.h \
+            $$TESTDIR/PureImageCacheTest.h \
+            lib/opmapcontrol/src/core/kibertilecache.h \
+            $$TESTDIR/KiberTileCacheTest.h \
+            lib/QMapControl/src/geometryindex.h \
+            $$TESTDIR/GeometryIndexTest.h \
+            src/input/PointCloudProjector.h \
+            $$TESTDIR/PointCloudProjectorTest.h \
+            src/input/VoxelGrid.h \
+            src/input/OccupancyMap.h \
+            $$TESTDIR/VoxelGridTest.h \
+            src/input/TripleBuffer.h \
+            $$TESTDIR/TripleBufferTest.h \
+            $$TESTDIR/MAVLinkRouterTest.h \
+            src/ui/map3D/WebImage.h \
+            src/ui/map3D/WebImageCache.h \
+            $$TESTDIR/WebImageCacheTest.h \
+            lib/QMapControl/src/geometry.h \
+            lib/QMapControl/src/mapadapter.h \
+            src/ui/map/MAV2DTrail.h \
+            $$TESTDIR/MAV2DTrailTest.h \
+            lib/QMapControl/src/tilecache.h \
+            $$TESTDIR/TileCacheTest.h \
+            src/comm/UDPLink.h \
+            $$TESTDIR/UDPLinkTest.h \
     src/uas/QGCMAVLinkUASFactory.h
 
 
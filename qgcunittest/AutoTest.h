@@ -8,6 +8,7 @@
 #define AUTOTEST_H
 
 #include <QTest>
+#include <QApplication>
 #include <QList>
 #include <QString>
 #include <QSharedPointer>
@@ -79,6 +80,7 @@ public:
 #define TEST_MAIN \
     int main(int argc, char *argv[]) \
     { \
+      QApplication app(argc, argv); \
       return AutoTest::run(argc, argv); \
   }
 
@@ -0,0 +1,85 @@
+#include "GeometryIndexTest.h"
+
+using namespace qmapcontrol;
+
+GeometryIndexTest::GeometryIndexTest()
+{
+}
+
+Geometry* GeometryIndexTest::geometry(int i)
+{
+    // The index never dereferences its geometries, so plain handles do
+    return reinterpret_cast<Geometry*>(quintptr(i + 1) * 16);
+}
+
+void GeometryIndexTest::query_test()
+{
+    GeometryIndex index;
+    index.insert(geometry(0), QPointF(8.55, 47.37));
+    index.insert(geometry(1), QPointF(8.56, 47.38));
+    index.insert(geometry(2), QPointF(-122.4, 37.7));
+
+    QList<Geometry*> found = index.query(QRectF(QPointF(8.5, 47.3), QPointF(8.6, 47.4)));
+    QCOMPARE(found.count(), 2);
+    QVERIFY(found.contains(geometry(0)));
+    QVERIFY(found.contains(geometry(1)));
+
+    // Display coordinates grow downwards, so areas may come in flipped
+    QCOMPARE(index.query(QRectF(QPointF(8.5, 47.4), QPointF(8.6, 47.3))).count(), 2);
+
+    index.remove(geometry(0));
+    QCOMPARE(index.query(QRectF(QPointF(8.5, 47.3), QPointF(8.6, 47.4))).count(), 1);
+    QCOMPARE(index.count(), 2);
+}
+
+void GeometryIndexTest::move_test()
+{
+    GeometryIndex index;
+    index.insert(geometry(0), QPointF(8.55, 47.37));
+    index.insert(geometry(0), QPointF(9.55, 47.37));
+
+    QVERIFY(index.query(QRectF(QPointF(8.5, 47.3), QPointF(8.6, 47.4))).isEmpty());
+    QCOMPARE(index.query(QRectF(QPointF(9.5, 47.3), QPointF(9.6, 47.4))).count(), 1);
+    QCOMPARE(index.count(), 1);
+}
+
+void GeometryIndexTest::order_test()
+{
+    GeometryIndex index;
+    index.insert(geometry(0), QPointF(8.551, 47.37));
+    index.insertUnbounded(geometry(1));
+    index.insert(geometry(2), QPointF(8.559, 47.37));
+    index.insert(geometry(3), QPointF(8.552, 47.37));
+
+    // Unbounded geometries are always found, everything comes back in insertion order
+    QList<Geometry*> found = index.query(QRectF(QPointF(8.55, 47.36), QPointF(8.56, 47.38)));
+    QCOMPARE(found.count(), 4);
+    for (int i = 0; i < found.count(); i++) {
+        QCOMPARE(found.at(i), geometry(i));
+    }
+    QCOMPARE(index.query(QRectF(QPointF(0, 0), QPointF(1, 1))).count(), 1);
+}
+
+void GeometryIndexTest::largeArea_test()
+{
+    GeometryIndex index;
+    for (int i = 0; i < 100; i++) {
+        index.insert(geometry(i), QPointF(-170 + i * 3.4, -80 + i * 1.6));
+    }
+    QCOMPARE(index.query(QRectF(QPointF(-180, -85), QPointF(180, 85))).count(), 100);
+    QCOMPARE(index.query(QRectF(QPointF(-1, -85), QPointF(180, 85))).count(), 50);
+}
+
+void GeometryIndexTest::query_benchmark()
+{
+    // A survey grid of 10000 waypoints, a viewport showing about a hundred of them
+    GeometryIndex index;
+    for (int i = 0; i < 10000; i++) {
+        index.insert(geometry(i), QPointF(8.5 + (i % 100) * 0.0005, 47.3 + (i / 100) * 0.0005));
+    }
+    QRectF viewport(QPointF(8.51, 47.31), QPointF(8.515, 47.315));
+
+    QBENCHMARK {
+        index.query(viewport);
+    }
+}
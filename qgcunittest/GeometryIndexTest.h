@@ -0,0 +1,31 @@
+#ifndef GEOMETRYINDEXTEST_H
+#define GEOMETRYINDEXTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "geometryindex.h"
+#include "AutoTest.h"
+
+class GeometryIndexTest : public QObject
+{
+    Q_OBJECT
+public:
+  GeometryIndexTest();
+
+private slots:
+  void query_test();
+  void move_test();
+  void order_test();
+  void largeArea_test();
+
+  void query_benchmark();
+
+private:
+  static qmapcontrol::Geometry* geometry(int i);
+};
+
+DECLARE_TEST(GeometryIndexTest)
+
+#endif // GEOMETRYINDEXTEST_H
@@ -0,0 +1,96 @@
+#include "HDDisplayGaugeTableTest.h"
+
+HDDisplayGaugeTableTest::HDDisplayGaugeTableTest()
+{
+}
+
+void HDDisplayGaugeTableTest::addGauge_test()
+{
+    HDDisplayGaugeTable table;
+    QCOMPARE(table.addGauge("roll", "deg", -180.0f, 180.0f, true), 0);
+    QCOMPARE(table.addGauge("pitch", "deg", -90.0f, 90.0f, true), 1);
+    // Adding twice returns the existing handle
+    QCOMPARE(table.addGauge("roll", "deg"), 0);
+    QCOMPARE(table.count(), 2);
+    // Until data arrives the gauge shows its minimum
+    QCOMPARE(table.values.at(1), -90.0f);
+}
+
+void HDDisplayGaugeTableTest::removeGauge_test()
+{
+    HDDisplayGaugeTable table;
+    table.addGauge("roll", "deg");
+    table.addGauge("pitch", "deg");
+    table.addGauge("yaw", "deg");
+    table.removeGauge(table.handle("pitch"));
+
+    QCOMPARE(table.count(), 2);
+    QCOMPARE(table.handle("roll"), 0);
+    QCOMPARE(table.handle("yaw"), 1);
+    QCOMPARE(table.handle("pitch"), -1);
+    QVERIFY(!table.updateValue("pitch", "deg", 1.0, 10));
+}
+
+void HDDisplayGaugeTableTest::rejectUntracked_test()
+{
+    HDDisplayGaugeTable table;
+    table.addGauge("roll", "deg");
+
+    QVERIFY(!table.updateValue("altitude", "m", 12.0, 10));
+    QCOMPARE(table.handle("altitude"), -1);
+    QCOMPARE(table.count(), 1);
+    // Untracked values are still offered for new gauges
+    QCOMPARE(table.availableValues().value("altitude"), QString("m"));
+}
+
+void HDDisplayGaugeTableTest::updateValue_test()
+{
+    HDDisplayGaugeTable table;
+    int h = table.addGauge("roll", "deg");
+
+    QVERIFY(table.updateValue("roll", "deg", 2.0, 1000));
+    QVERIFY(table.updateValue("roll", "deg", 4.0, 2000, true));
+
+    QCOMPARE(table.values.at(h), 4.0f);
+    QCOMPARE(table.valuesMean.at(h), 3.0f);
+    QCOMPARE(table.valuesCount.at(h), 2);
+    QCOMPARE(table.valuesDot.at(h), 2.0f);
+    QCOMPARE(table.lastUpdate.at(h), (quint64)2000);
+    QVERIFY(table.intValues.at(h));
+}
+
+void HDDisplayGaugeTableTest::updateValueTracked_benchmark()
+{
+    HDDisplayGaugeTable table;
+    QStringList names;
+    for (int i = 0; i < 64; ++i) {
+        names.append(QString("value %1").arg(i));
+        table.addGauge(names.last(), "m");
+    }
+    const QString unit("m");
+    quint64 msec = 0;
+
+    QBENCHMARK {
+        for (int i = 0; i < names.size(); ++i) {
+            table.updateValue(names.at(i), unit, i, ++msec);
+        }
+    }
+}
+
+void HDDisplayGaugeTableTest::updateValueUntracked_benchmark()
+{
+    HDDisplayGaugeTable table;
+    table.addGauge("roll", "deg");
+    QStringList names;
+    for (int i = 0; i < 64; ++i) {
+        names.append(QString("value %1").arg(i));
+    }
+    const QString unit("m");
+    quint64 msec = 0;
+
+    QBENCHMARK {
+        for (int i = 0; i < names.size(); ++i) {
+            table.updateValue(names.at(i), unit, i, ++msec);
+        }
+    }
+}
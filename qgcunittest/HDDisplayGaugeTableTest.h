@@ -0,0 +1,29 @@
+#ifndef HDDISPLAYGAUGETABLETEST_H
+#define HDDISPLAYGAUGETABLETEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "HDDisplayGaugeTable.h"
+#include "AutoTest.h"
+
+class HDDisplayGaugeTableTest : public QObject
+{
+    Q_OBJECT
+public:
+  HDDisplayGaugeTableTest();
+
+private slots:
+  void addGauge_test();
+  void removeGauge_test();
+  void rejectUntracked_test();
+  void updateValue_test();
+
+  void updateValueTracked_benchmark();
+  void updateValueUntracked_benchmark();
+};
+
+DECLARE_TEST(HDDisplayGaugeTableTest)
+
+#endif // HDDISPLAYGAUGETABLETEST_H
@@ -0,0 +1,82 @@
+#include "KiberTileCacheTest.h"
+
+using namespace core;
+
+KiberTileCacheTest::KiberTileCacheTest()
+{
+}
+
+void KiberTileCacheTest::addGet_test()
+{
+    KiberTileCache cache;
+    RawTile tile(MapType::GoogleSatellite, Point(1, 2), 3);
+    QVERIFY(cache.GetTile(tile).isEmpty());
+
+    cache.AddTile(tile, QByteArray("tile"));
+    QCOMPARE(cache.GetTile(tile), QByteArray("tile"));
+    QCOMPARE(cache.TileCount(), 1);
+    QCOMPARE(cache.Hits(), (quint64)1);
+    QCOMPARE(cache.Misses(), (quint64)1);
+}
+
+void KiberTileCacheTest::replace_test()
+{
+    KiberTileCache cache;
+    RawTile tile(MapType::GoogleMap, Point(1, 2), 3);
+    cache.AddTile(tile, QByteArray(1024, 'a'));
+    double size = cache.MemoryCacheSize();
+    // Adding the same tile again must not count its memory twice
+    cache.AddTile(tile, QByteArray(1024, 'b'));
+
+    QCOMPARE(cache.TileCount(), 1);
+    QCOMPARE(cache.MemoryCacheSize(), size);
+    QCOMPARE(cache.GetTile(tile).at(0), 'b');
+}
+
+void KiberTileCacheTest::budget_test()
+{
+    KiberTileCache cache;
+    cache.setMemoryCacheCapacity(1);
+    for (int i = 0; i < 200; ++i) {
+        cache.AddTile(RawTile(MapType::GoogleMap, Point(i, 0), 10), QByteArray(20 * 1024, 'x'));
+    }
+
+    QVERIFY(cache.MemoryCacheSize() <= 1.0);
+    QVERIFY(cache.TileCount() > 0);
+    QCOMPARE(cache.Evictions(), (quint64)(200 - cache.TileCount()));
+
+    // Shrinking the budget evicts immediately
+    cache.setMemoryCacheCapacity(0);
+    QCOMPARE(cache.TileCount(), 0);
+}
+
+void KiberTileCacheTest::recentlyUsedSurvives_test()
+{
+    KiberTileCache cache;
+    cache.setMemoryCacheCapacity(1);
+    RawTile favourite(MapType::GoogleMap, Point(-1, -1), 10);
+    cache.AddTile(favourite, QByteArray(20 * 1024, 'f'));
+
+    // A tile which is looked at all the time is never evicted
+    for (int i = 0; i < 500; ++i) {
+        cache.AddTile(RawTile(MapType::GoogleMap, Point(i, 0), 10), QByteArray(20 * 1024, 'x'));
+        QVERIFY(!cache.GetTile(favourite).isEmpty());
+    }
+}
+
+void KiberTileCacheTest::getTile_benchmark()
+{
+    KiberTileCache cache;
+    cache.setMemoryCacheCapacity(64);
+    QList<RawTile> tiles;
+    for (int i = 0; i < 1024; ++i) {
+        tiles.append(RawTile(MapType::GoogleSatellite, Point(i % 32, i / 32), 15));
+        cache.AddTile(tiles.last(), QByteArray(8 * 1024, 'x'));
+    }
+
+    QBENCHMARK {
+        for (int i = 0; i < tiles.size(); ++i) {
+            cache.GetTile(tiles.at(i));
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef KIBERTILECACHETEST_H
+#define KIBERTILECACHETEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "kibertilecache.h"
+#include "AutoTest.h"
+
+class KiberTileCacheTest : public QObject
+{
+    Q_OBJECT
+public:
+  KiberTileCacheTest();
+
+private slots:
+  void addGet_test();
+  void replace_test();
+  void budget_test();
+  void recentlyUsedSurvives_test();
+
+  void getTile_benchmark();
+};
+
+DECLARE_TEST(KiberTileCacheTest)
+
+#endif // KIBERTILECACHETEST_H
@@ -0,0 +1,138 @@
+#include "MAV2DTrailTest.h"
+
+namespace
+{
+
+/** @brief Gives the test access to the stored fixes */
+class Trail : public MAV2DTrail
+{
+public:
+    explicit Trail(int fixes)
+        : MAV2DTrail(1, 0, fixes * MAV2DTrail::bytesPerFix)
+    {
+    }
+
+    /** @brief Latitude of the i-th stored fix, the oldest one is 0 */
+    double latitude(int i) const {
+        return fix(nextSeq - stored + i).y();
+    }
+    int allocated() const {
+        return fixes.capacity();
+    }
+    quint64 sequence() const {
+        return nextSeq;
+    }
+};
+
+// Fixes one degree apart along a meridian, far beyond minSpacing
+void addFixes(Trail& trail, int first, int count)
+{
+    for (int i = first; i < first + count; i++) {
+        trail.addFix(i, 0);
+    }
+}
+
+}
+
+MAV2DTrailTest::MAV2DTrailTest()
+{
+}
+
+void MAV2DTrailTest::lazyGrowth_test()
+{
+    const int limit = 100000;
+    Trail trail(limit);
+    QCOMPARE(trail.memoryLimit(), limit * MAV2DTrail::bytesPerFix);
+
+    // An empty or short trail does not take its whole budget
+    QVERIFY(trail.allocated() < limit);
+    addFixes(trail, 0, 10);
+    QCOMPARE(trail.count(), 10);
+    QVERIFY(trail.allocated() <= MAV2DTrail::initialFixes);
+
+    addFixes(trail, 10, 1000);
+    QCOMPARE(trail.count(), 1010);
+    QVERIFY(trail.allocated() < 4 * 1010);
+}
+
+void MAV2DTrailTest::wraparound_test()
+{
+    Trail trail(5);
+    addFixes(trail, 0, 12);
+
+    // Only the newest fixes stay, oldest first
+    QCOMPARE(trail.count(), 5);
+    QCOMPARE(trail.sequence(), (quint64)12);
+    QVERIFY(trail.allocated() <= 5);
+    for (int i = 0; i < 5; i++) {
+        QCOMPARE(trail.latitude(i), double(7 + i));
+    }
+
+    // The bounds shrink with the dropped fixes
+    QRectF bounds = trail.boundingBox();
+    QCOMPARE(bounds.top(), 7.0);
+    QCOMPARE(bounds.bottom(), 11.0);
+}
+
+void MAV2DTrailTest::spacing_test()
+{
+    Trail trail(10);
+    trail.addFix(47.0, 8.0);
+    trail.addFix(47.0, 8.0);
+    trail.addFix(47.0 + MAV2DTrail::minSpacing / 10, 8.0);
+    QCOMPARE(trail.count(), 1);
+    QCOMPARE(trail.sequence(), (quint64)1);
+
+    trail.addFix(47.0 + MAV2DTrail::minSpacing * 2, 8.0);
+    QCOMPARE(trail.count(), 2);
+}
+
+void MAV2DTrailTest::shrink_test()
+{
+    Trail trail(10);
+    addFixes(trail, 0, 13);
+
+    // The newest fixes are kept in order, also across the wrapped end of the ring
+    trail.setMemoryLimit(4 * MAV2DTrail::bytesPerFix);
+    QCOMPARE(trail.count(), 4);
+    for (int i = 0; i < 4; i++) {
+        QCOMPARE(trail.latitude(i), double(9 + i));
+    }
+
+    addFixes(trail, 13, 3);
+    QCOMPARE(trail.count(), 4);
+    for (int i = 0; i < 4; i++) {
+        QCOMPARE(trail.latitude(i), double(12 + i));
+    }
+    QCOMPARE(trail.boundingBox().top(), 12.0);
+}
+
+void MAV2DTrailTest::grow_test()
+{
+    Trail trail(4);
+    addFixes(trail, 0, 6);
+
+    // A larger limit keeps all fixes and lets the ring grow again
+    trail.setMemoryLimit(8 * MAV2DTrail::bytesPerFix);
+    QCOMPARE(trail.count(), 4);
+    addFixes(trail, 6, 6);
+    QCOMPARE(trail.count(), 8);
+    for (int i = 0; i < 8; i++) {
+        QCOMPARE(trail.latitude(i), double(4 + i));
+    }
+    QCOMPARE(trail.sequence(), (quint64)12);
+}
+
+void MAV2DTrailTest::clear_test()
+{
+    Trail trail(100);
+    addFixes(trail, 0, 50);
+    trail.clear();
+    QCOMPARE(trail.count(), 0);
+    QCOMPARE(trail.sequence(), (quint64)0);
+
+    addFixes(trail, 3, 2);
+    QCOMPARE(trail.count(), 2);
+    QCOMPARE(trail.latitude(0), 3.0);
+    QCOMPARE(trail.boundingBox().top(), 3.0);
+}
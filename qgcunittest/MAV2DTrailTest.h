@@ -0,0 +1,28 @@
+#ifndef MAV2DTRAILTEST_H
+#define MAV2DTRAILTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "MAV2DTrail.h"
+#include "AutoTest.h"
+
+class MAV2DTrailTest : public QObject
+{
+    Q_OBJECT
+public:
+  MAV2DTrailTest();
+
+private slots:
+  void lazyGrowth_test();
+  void wraparound_test();
+  void spacing_test();
+  void shrink_test();
+  void grow_test();
+  void clear_test();
+};
+
+DECLARE_TEST(MAV2DTrailTest)
+
+#endif // MAV2DTRAILTEST_H
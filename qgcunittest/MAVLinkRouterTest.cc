@@ -0,0 +1,128 @@
+#include "MAVLinkRouterTest.h"
+
+namespace
+{
+
+// The router never accesses the links, so any distinct pointers will do
+LinkInterface* const linkA = reinterpret_cast<LinkInterface*>(0x10);
+LinkInterface* const linkB = reinterpret_cast<LinkInterface*>(0x20);
+LinkInterface* const linkC = reinterpret_cast<LinkInterface*>(0x30);
+
+const int localSystemId = 252;
+
+mavlink_message_t heartbeat(int sysid)
+{
+    mavlink_message_t message;
+    mavlink_msg_heartbeat_pack(sysid, 1, &message, MAV_QUADROTOR, MAV_AUTOPILOT_GENERIC);
+    return message;
+}
+
+mavlink_message_t paramRequestList(int sysid, int target)
+{
+    mavlink_message_t message;
+    mavlink_msg_param_request_list_pack(sysid, 0, &message, target, 0);
+    return message;
+}
+
+}
+
+MAVLinkRouterTest::MAVLinkRouterTest()
+{
+}
+
+void MAVLinkRouterTest::learn_test()
+{
+    MAVLinkRouter router;
+    QList<LinkInterface*> links;
+    links << linkA << linkB;
+
+    router.route(linkA, heartbeat(1), links, localSystemId);
+    router.route(linkB, heartbeat(2), links, localSystemId);
+    QCOMPARE(router.getRoutes().size(), 2);
+    QCOMPARE(router.getRoutes().value(1).link, linkA);
+    QCOMPARE(router.getRoutes().value(2).link, linkB);
+
+    // A system that moved to another link is routed there
+    router.route(linkB, heartbeat(1), links, localSystemId);
+    QCOMPARE(router.getRoutes().value(1).link, linkB);
+
+    router.clear();
+    QVERIFY(router.getRoutes().isEmpty());
+}
+
+void MAVLinkRouterTest::broadcast_test()
+{
+    MAVLinkRouter router;
+    QList<LinkInterface*> links;
+    links << linkA << linkB << linkC;
+
+    // Messages without target go to all links but the one they came from
+    QList<LinkInterface*> targets = router.route(linkA, heartbeat(1), links, localSystemId);
+    QCOMPARE(targets.size(), 2);
+    QVERIFY(targets.contains(linkB));
+    QVERIFY(targets.contains(linkC));
+
+    // So do messages to all systems and to unknown systems
+    QCOMPARE(router.route(linkA, paramRequestList(1, 0), links, localSystemId).size(), 2);
+    QCOMPARE(router.route(linkA, paramRequestList(1, 7), links, localSystemId).size(), 2);
+}
+
+void MAVLinkRouterTest::targeted_test()
+{
+    MAVLinkRouter router;
+    QList<LinkInterface*> links;
+    links << linkA << linkB << linkC;
+    router.route(linkB, heartbeat(2), links, localSystemId);
+
+    QCOMPARE(MAVLinkRouter::targetSystem(paramRequestList(1, 2)), 2);
+
+    // Messages to a known system only go to its link
+    QList<LinkInterface*> targets = router.route(linkA, paramRequestList(1, 2), links, localSystemId);
+    QCOMPARE(targets.size(), 1);
+    QCOMPARE(targets.first(), linkB);
+
+    // The target already heard messages sent on its own link
+    QVERIFY(router.route(linkB, paramRequestList(3, 2), links, localSystemId).isEmpty());
+
+    // Without its link the target is unknown again
+    links.removeAll(linkB);
+    QCOMPARE(router.route(linkA, paramRequestList(1, 2), links, localSystemId).size(), 1);
+    QCOMPARE(router.route(linkA, paramRequestList(1, 2), links, localSystemId).first(), linkC);
+}
+
+void MAVLinkRouterTest::local_test()
+{
+    MAVLinkRouter router;
+    QList<LinkInterface*> links;
+    links << linkA << linkB;
+
+    // Messages to this ground station are not forwarded
+    QVERIFY(router.route(linkA, paramRequestList(1, localSystemId), links, localSystemId).isEmpty());
+}
+
+void MAVLinkRouterTest::counters_test()
+{
+    MAVLinkRouter router;
+    QList<LinkInterface*> links;
+    links << linkA << linkB << linkC;
+    const int heartbeatLength = heartbeat(1).len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+    const int requestLength = paramRequestList(2, 1).len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+
+    router.route(linkA, heartbeat(1), links, localSystemId);
+    router.route(linkB, heartbeat(2), links, localSystemId);
+    router.route(linkB, paramRequestList(2, 1), links, localSystemId);
+
+    MAVLinkRouter::Route route = router.getRoutes().value(1);
+    QCOMPARE(route.framesReceived, (quint64)1);
+    QCOMPARE(route.bytesReceived, (quint64)heartbeatLength);
+    QCOMPARE(route.framesForwarded, (quint64)2);
+    QCOMPARE(route.bytesForwarded, (quint64)(2 * heartbeatLength));
+    QCOMPARE(route.framesDelivered, (quint64)1);
+
+    route = router.getRoutes().value(2);
+    QCOMPARE(route.framesReceived, (quint64)2);
+    QCOMPARE(route.bytesReceived, (quint64)(heartbeatLength + requestLength));
+    QCOMPARE(route.framesForwarded, (quint64)3);
+    QCOMPARE(route.bytesForwarded, (quint64)(2 * heartbeatLength + requestLength));
+    QCOMPARE(route.framesDelivered, (quint64)0);
+}
@@ -0,0 +1,27 @@
+#ifndef MAVLINKROUTERTEST_H
+#define MAVLINKROUTERTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "MAVLinkRouter.h"
+#include "AutoTest.h"
+
+class MAVLinkRouterTest : public QObject
+{
+    Q_OBJECT
+public:
+  MAVLinkRouterTest();
+
+private slots:
+  void learn_test();
+  void broadcast_test();
+  void targeted_test();
+  void local_test();
+  void counters_test();
+};
+
+DECLARE_TEST(MAVLinkRouterTest)
+
+#endif // MAVLINKROUTERTEST_H
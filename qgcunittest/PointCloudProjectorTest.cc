@@ -0,0 +1,127 @@
+#include "PointCloudProjectorTest.h"
+
+static const double baseline = 0.075;
+static const double focalLength = 580.0;
+static const double disparityOffset = 1090.0;
+
+static double referenceRange(int disparity)
+{
+    // Double precision model as Freenect used it, without the infinite ranges
+    if (disparity <= 0 || disparity == disparityOffset) return 0.0;
+    return qMax(0.0, baseline * focalLength / ((disparityOffset - disparity) / 8.0));
+}
+
+PointCloudProjectorTest::PointCloudProjectorTest()
+{
+}
+
+void PointCloudProjectorTest::initTestCase()
+{
+    QVector<float> rayX(width * height);
+    QVector<float> rayY(width * height);
+    for (int i = 0; i < width * height; i++) {
+        rayX[i] = ((i % width) - width / 2) / focalLength;
+        rayY[i] = ((i / width) - height / 2) / focalLength;
+    }
+    projector.setRays(rayX, rayY);
+    projector.setDisparityModel(baseline, focalLength, disparityOffset);
+
+    // The color camera sits 2.5 cm to the right, its image encodes the pixel position
+    QMatrix4x4 depthToColor;
+    depthToColor.translate(-0.025, 0.0, 0.0);
+    const double k[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+    projector.setColorCamera(depthToColor, focalLength, focalLength,
+                             width / 2, height / 2, k, width, height);
+
+    // Every raw value the sensor can deliver, in a scrambled order
+    depth.resize(width * height);
+    for (int i = 0; i < depth.size(); i++) {
+        depth[i] = (i * 7919) % 2100;
+    }
+    rgb.resize(width * height * 3);
+    for (int i = 0; i < width * height; i++) {
+        rgb[i * 3] = (i % width) / 3;
+        rgb[i * 3 + 1] = (i / width) / 2;
+        rgb[i * 3 + 2] = 0;
+    }
+}
+
+void PointCloudProjectorTest::range_test()
+{
+    QCOMPARE(projector.range(0), 0.0f);
+    for (int d = 1; d < PointCloudProjector::rangeTableSize; d++) {
+        double range = referenceRange(d);
+        if (range > 0.0) {
+            QVERIFY(qAbs(projector.range(d) - range) < 1e-5 * range);
+        } else {
+            QCOMPARE(projector.range(d), 0.0f);
+        }
+    }
+    // Values beyond the table are invalid rather than out of bounds
+    QCOMPARE(projector.range(PointCloudProjector::rangeTableSize), 0.0f);
+}
+
+void PointCloudProjectorTest::project_test()
+{
+    PointCloud cloud;
+    int count = projector.project(depth.constData(), cloud);
+    QCOMPARE(cloud.size, count);
+
+    // The points come in pixel order, compare against the double precision model
+    int n = 0;
+    for (int i = 0; i < depth.size(); i++) {
+        double range = referenceRange(depth[i]);
+        if (depth[i] >= PointCloudProjector::rangeTableSize || range <= 0.0) {
+            continue;
+        }
+
+        QVERIFY(n < count);
+        double x = ((i % width) - width / 2) / focalLength * range;
+        double y = ((i / width) - height / 2) / focalLength * range;
+        QVERIFY(qAbs(cloud.x[n] - x) < 1e-4 * range);
+        QVERIFY(qAbs(cloud.y[n] - y) < 1e-4 * range);
+        QVERIFY(qAbs(cloud.z[n] - range) < 1e-4 * range);
+        n++;
+    }
+    QCOMPARE(n, count);
+}
+
+void PointCloudProjectorTest::projectColored_test()
+{
+    PointCloud cloud;
+    int count = projector.projectColored(depth.constData(), rgb.constData(), cloud);
+    QCOMPARE(cloud.size, count);
+    QVERIFY(count > 0);
+
+    PointCloud plain;
+    QVERIFY(count <= projector.project(depth.constData(), plain));
+
+    // Each point must have sampled the color pixel it projects into, up to
+    // float rounding at the pixel borders
+    for (int i = 0; i < count; i++) {
+        double u = (cloud.x[i] - 0.025) / cloud.z[i] * focalLength + width / 2;
+        double v = cloud.y[i] / cloud.z[i] * focalLength + height / 2;
+        QVERIFY(u > -0.01 && u < width + 0.01);
+        QVERIFY(v > -0.01 && v < height + 0.01);
+        QVERIFY(qAbs(cloud.r[i] - static_cast<int>(u) / 3) <= 1);
+        QVERIFY(qAbs(cloud.g[i] - static_cast<int>(v) / 2) <= 1);
+        QCOMPARE(cloud.b[i], static_cast<unsigned char>(0));
+    }
+}
+
+void PointCloudProjectorTest::project_benchmark()
+{
+    // The cloud is reused, as Freenect does for every frame
+    PointCloud cloud(width * height);
+    QTime time;
+    int frames = 0;
+
+    time.start();
+    QBENCHMARK {
+        projector.projectColored(depth.constData(), rgb.constData(), cloud);
+        frames++;
+    }
+    int elapsed = qMax(1, time.elapsed());
+
+    qDebug() << "projected" << (frames * double(width * height)) / elapsed / 1000.0 << "Mpoints/s";
+}
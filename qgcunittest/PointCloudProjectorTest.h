@@ -0,0 +1,37 @@
+#ifndef POINTCLOUDPROJECTORTEST_H
+#define POINTCLOUDPROJECTORTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "PointCloudProjector.h"
+#include "AutoTest.h"
+
+class PointCloudProjectorTest : public QObject
+{
+    Q_OBJECT
+public:
+  PointCloudProjectorTest();
+
+private slots:
+  void initTestCase();
+
+  void range_test();
+  void project_test();
+  void projectColored_test();
+
+  void project_benchmark();
+
+private:
+  static const int width = 640;
+  static const int height = 480;
+
+  PointCloudProjector projector;
+  QVector<unsigned short> depth;
+  QVector<unsigned char> rgb;
+};
+
+DECLARE_TEST(PointCloudProjectorTest)
+
+#endif // POINTCLOUDPROJECTORTEST_H
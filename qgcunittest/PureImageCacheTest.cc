@@ -0,0 +1,135 @@
+#include "PureImageCacheTest.h"
+
+PureImageCacheTest::PureImageCacheTest()
+{
+}
+
+void PureImageCacheTest::initTestCase()
+{
+    cacheDir = QDir::tempPath() + QDir::separator() + "qgc_pureimagecache_test" + QDir::separator();
+    QFile::remove(cacheDir + "Data.qmdb");
+    packDir = QDir::tempPath() + QDir::separator() + "qgc_pureimagecache_pack" + QDir::separator();
+    QFile::remove(packDir + "Data.qmdb");
+    // A typical compressed 256x256 tile
+    tileData = QByteArray(12 * 1024, 'x');
+}
+
+void PureImageCacheTest::cleanupTestCase()
+{
+    QFile::remove(cacheDir + "Data.qmdb");
+    QFile::remove(cacheDir + "Data.qmdb-wal");
+    QFile::remove(cacheDir + "Data.qmdb-shm");
+    QFile::remove(packDir + "Data.qmdb");
+    QFile::remove(packDir + "Data.qmdb-wal");
+    QFile::remove(packDir + "Data.qmdb-shm");
+}
+
+void PureImageCacheTest::fillCache(core::PureImageCache& cache, int zoom)
+{
+    cache.BeginTransaction();
+    for (int i = 0; i < tiles; ++i) {
+        cache.PutImageToCache(tileData, core::MapType::GoogleSatellite, core::Point(i % 16, i / 16), zoom);
+    }
+    cache.CommitTransaction();
+}
+
+void PureImageCacheTest::putGet_test()
+{
+    core::PureImageCache cache;
+    cache.setGtileCache(cacheDir);
+
+    QByteArray tile("tile 3/4 zoom 5");
+    QVERIFY(cache.PutImageToCache(tile, core::MapType::GoogleMap, core::Point(3, 4), 5));
+    QCOMPARE(cache.GetImageFromCache(core::MapType::GoogleMap, core::Point(3, 4), 5), tile);
+
+    // Writes inside a transaction are visible after the commit
+    cache.BeginTransaction();
+    QVERIFY(cache.PutImageToCache(tile, core::MapType::GoogleMap, core::Point(4, 4), 5));
+    cache.CommitTransaction();
+    QCOMPARE(cache.GetImageFromCache(core::MapType::GoogleMap, core::Point(4, 4), 5), tile);
+}
+
+void PureImageCacheTest::missingTile_test()
+{
+    core::PureImageCache cache;
+    cache.setGtileCache(cacheDir);
+    QVERIFY(cache.GetImageFromCache(core::MapType::GoogleMap, core::Point(1000, 1000), 1).isEmpty());
+    QVERIFY(cache.GetImageFromCache(core::MapType::OpenStreetMap, core::Point(3, 4), 5).isEmpty());
+}
+
+void PureImageCacheTest::containsTile_test()
+{
+    core::PureImageCache cache;
+    cache.setGtileCache(cacheDir);
+    QVERIFY(!cache.ContainsTile(core::MapType::GoogleMap, core::Point(7, 8), 9));
+    QVERIFY(cache.PutImageToCache(QByteArray("tile"), core::MapType::GoogleMap, core::Point(7, 8), 9));
+    QVERIFY(cache.ContainsTile(core::MapType::GoogleMap, core::Point(7, 8), 9));
+    QVERIFY(!cache.ContainsTile(core::MapType::GoogleSatellite, core::Point(7, 8), 9));
+}
+
+void PureImageCacheTest::exportTiles_test()
+{
+    {
+        core::PureImageCache cache;
+        cache.setGtileCache(cacheDir);
+        cache.PutImageToCache(QByteArray("a"), core::MapType::GoogleMap, core::Point(1, 1), 12);
+        cache.PutImageToCache(QByteArray("b"), core::MapType::GoogleMap, core::Point(2, 1), 12);
+    }
+
+    // Only the requested tiles end up in the pack
+    QList<core::RawTile> tiles;
+    tiles << core::RawTile(core::MapType::GoogleMap, core::Point(1, 1), 12);
+    tiles << core::RawTile(core::MapType::GoogleMap, core::Point(3, 1), 12);
+    QVERIFY(core::PureImageCache::ExportMapDataToDB(cacheDir + "Data.qmdb", packDir + "Data.qmdb", tiles));
+    // Exporting twice does not duplicate tiles
+    QVERIFY(core::PureImageCache::ExportMapDataToDB(cacheDir + "Data.qmdb", packDir + "Data.qmdb", tiles));
+
+    core::PureImageCache pack;
+    pack.setGtileCache(packDir);
+    QCOMPARE(pack.GetImageFromCache(core::MapType::GoogleMap, core::Point(1, 1), 12), QByteArray("a"));
+    QVERIFY(!pack.ContainsTile(core::MapType::GoogleMap, core::Point(2, 1), 12));
+    QVERIFY(!pack.ContainsTile(core::MapType::GoogleMap, core::Point(3, 1), 12));
+}
+
+void PureImageCacheTest::putTiles_benchmark()
+{
+    core::PureImageCache cache;
+    cache.setGtileCache(cacheDir);
+    int zoom = 10;
+
+    // tiles per iteration, tiles/s = tiles * 1000 / msecs
+    QBENCHMARK {
+        fillCache(cache, zoom++);
+    }
+}
+
+void PureImageCacheTest::getTilesCold_benchmark()
+{
+    {
+        core::PureImageCache cache;
+        cache.setGtileCache(cacheDir);
+        fillCache(cache, 2);
+    }
+
+    // Every iteration opens a new connection
+    QBENCHMARK {
+        core::PureImageCache cache;
+        cache.setGtileCache(cacheDir);
+        for (int i = 0; i < tiles; ++i) {
+            cache.GetImageFromCache(core::MapType::GoogleSatellite, core::Point(i % 16, i / 16), 2);
+        }
+    }
+}
+
+void PureImageCacheTest::getTilesWarm_benchmark()
+{
+    core::PureImageCache cache;
+    cache.setGtileCache(cacheDir);
+    fillCache(cache, 3);
+
+    QBENCHMARK {
+        for (int i = 0; i < tiles; ++i) {
+            cache.GetImageFromCache(core::MapType::GoogleSatellite, core::Point(i % 16, i / 16), 3);
+        }
+    }
+}
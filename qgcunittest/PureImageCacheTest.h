@@ -0,0 +1,40 @@
+#ifndef PUREIMAGECACHETEST_H
+#define PUREIMAGECACHETEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "pureimagecache.h"
+#include "AutoTest.h"
+
+class PureImageCacheTest : public QObject
+{
+    Q_OBJECT
+public:
+  PureImageCacheTest();
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+
+  void putGet_test();
+  void missingTile_test();
+  void containsTile_test();
+  void exportTiles_test();
+
+  void putTiles_benchmark();
+  void getTilesCold_benchmark();
+  void getTilesWarm_benchmark();
+
+private:
+  static const int tiles = 256; ///< Tiles per benchmark iteration
+  QString cacheDir;
+  QString packDir;
+  QByteArray tileData;
+  void fillCache(core::PureImageCache& cache, int zoom);
+};
+
+DECLARE_TEST(PureImageCacheTest)
+
+#endif // PUREIMAGECACHETEST_H
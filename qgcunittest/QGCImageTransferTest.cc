@@ -0,0 +1,137 @@
+#include "QGCImageTransferTest.h"
+
+#include <cstring>
+
+namespace
+{
+/** @brief Gives the tests access to the assembled image data */
+class Transfer : public QGCImageTransfer
+{
+public:
+    const QByteArray& data() const {
+        return buffer;
+    }
+};
+}
+
+QGCImageTransferTest::QGCImageTransferTest()
+{
+}
+
+void QGCImageTransferTest::outOfOrder_test()
+{
+    QGCImageTransfer transfer;
+    unsigned char chunk[4];
+    QVERIFY(!transfer.start(10, 3, 4));
+
+    // The last chunk is shorter than the payload
+    memset(chunk, 3, sizeof(chunk));
+    QVERIFY(!transfer.addChunk(2, chunk, sizeof(chunk)));
+    memset(chunk, 1, sizeof(chunk));
+    QVERIFY(!transfer.addChunk(0, chunk, sizeof(chunk)));
+    memset(chunk, 2, sizeof(chunk));
+    QVERIFY(transfer.addChunk(1, chunk, sizeof(chunk)));
+
+    QVERIFY(transfer.isComplete());
+    QCOMPARE(transfer.getReceivedChunks(), 3);
+    QVERIFY(transfer.missingChunks().isEmpty());
+}
+
+void QGCImageTransferTest::duplicateChunk_test()
+{
+    QGCImageTransfer transfer;
+    unsigned char chunk[4] = {0, 0, 0, 0};
+    transfer.start(8, 2, 4);
+
+    QVERIFY(!transfer.addChunk(0, chunk, sizeof(chunk)));
+    QVERIFY(!transfer.addChunk(0, chunk, sizeof(chunk)));
+    // Sequence numbers beyond the announced packets are ignored
+    QVERIFY(!transfer.addChunk(5, chunk, sizeof(chunk)));
+
+    QCOMPARE(transfer.getReceivedChunks(), 1);
+    QCOMPARE(transfer.getDuplicateChunks(), (quint64)1);
+    QVERIFY(!transfer.isComplete());
+}
+
+void QGCImageTransferTest::missingChunks_test()
+{
+    QGCImageTransfer transfer;
+    unsigned char chunk[4] = {0, 0, 0, 0};
+    transfer.start(20, 5, 4);
+    transfer.addChunk(0, chunk, sizeof(chunk));
+    transfer.addChunk(3, chunk, sizeof(chunk));
+
+    QList<int> missing;
+    missing << 1 << 2 << 4;
+    QCOMPARE(transfer.missingChunks(), missing);
+}
+
+void QGCImageTransferTest::retransmission_test()
+{
+    Transfer transfer;
+    unsigned char chunk[4];
+    transfer.start(12, 3, 4);
+    memset(chunk, 1, sizeof(chunk));
+    transfer.addChunk(0, chunk, sizeof(chunk));
+    transfer.addChunk(2, chunk, sizeof(chunk));
+
+    // The answer to a request is a new capture, even with the same geometry
+    transfer.requestRetransmission();
+    QVERIFY(transfer.start(12, 3, 4));
+    QCOMPARE(transfer.getRetransmissions(), 1);
+    QCOMPARE(transfer.getReceivedChunks(), 0);
+
+    // No chunk of the first capture ends up in the new image
+    memset(chunk, 2, sizeof(chunk));
+    QVERIFY(!transfer.addChunk(1, chunk, sizeof(chunk)));
+    QCOMPARE(transfer.data(), QByteArray(4, 0) + QByteArray(4, 2) + QByteArray(4, 0));
+    QVERIFY(!transfer.addChunk(0, chunk, sizeof(chunk)));
+    QVERIFY(transfer.addChunk(2, chunk, sizeof(chunk)));
+    QCOMPARE(transfer.data(), QByteArray(12, 2));
+}
+
+void QGCImageTransferTest::newImage_test()
+{
+    QGCImageTransfer transfer;
+    unsigned char chunk[4] = {0, 0, 0, 0};
+    transfer.start(12, 3, 4);
+    transfer.addChunk(0, chunk, sizeof(chunk));
+
+    // A different image discards the partial one
+    QVERIFY(!transfer.start(16, 4, 4));
+    QCOMPARE(transfer.getReceivedChunks(), 0);
+    QCOMPARE(transfer.getChunkCount(), 4);
+    QCOMPARE(transfer.getRetransmissions(), 0);
+}
+
+void QGCImageTransferTest::unrequestedHandshake_test()
+{
+    QGCImageTransfer transfer;
+    unsigned char chunk[4] = {0, 0, 0, 0};
+    transfer.start(12, 3, 4);
+    transfer.addChunk(0, chunk, sizeof(chunk));
+
+    // A new capture of the same size must not be merged into the old one
+    QVERIFY(!transfer.start(12, 3, 4));
+    QCOMPARE(transfer.getReceivedChunks(), 0);
+
+    // Only the first handshake after a request answers it and keeps the request count
+    transfer.addChunk(0, chunk, sizeof(chunk));
+    transfer.requestRetransmission();
+    QVERIFY(transfer.start(12, 3, 4));
+    QCOMPARE(transfer.getRetransmissions(), 1);
+    QVERIFY(!transfer.start(12, 3, 4));
+    QCOMPARE(transfer.getRetransmissions(), 0);
+}
+
+void QGCImageTransferTest::lostRequest_test()
+{
+    QGCImageTransfer transfer;
+    transfer.start(12, 3, 4);
+
+    // Requests count even if they are never answered
+    transfer.requestRetransmission();
+    transfer.requestRetransmission();
+    QCOMPARE(transfer.getRetransmissions(), 2);
+    QVERIFY(transfer.isActive());
+}
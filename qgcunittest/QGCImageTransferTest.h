@@ -0,0 +1,29 @@
+#ifndef QGCIMAGETRANSFERTEST_H
+#define QGCIMAGETRANSFERTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "QGCImageTransfer.h"
+#include "AutoTest.h"
+
+class QGCImageTransferTest : public QObject
+{
+    Q_OBJECT
+public:
+  QGCImageTransferTest();
+
+private slots:
+  void outOfOrder_test();
+  void duplicateChunk_test();
+  void missingChunks_test();
+  void retransmission_test();
+  void newImage_test();
+  void unrequestedHandshake_test();
+  void lostRequest_test();
+};
+
+DECLARE_TEST(QGCImageTransferTest)
+
+#endif // QGCIMAGETRANSFERTEST_H
@@ -0,0 +1,102 @@
+#include "QGCVideoFramePoolTest.h"
+
+QGCVideoFramePoolTest::QGCVideoFramePoolTest()
+{
+}
+
+void QGCVideoFramePoolTest::setFormat_test()
+{
+    QGCVideoFramePool pool;
+    QVERIFY(pool.setFormat(640, 480, 8, 1));
+    QCOMPARE(pool.getExpectedBytes(), 640 * 480);
+    // Same geometry does not reallocate
+    QVERIFY(!pool.setFormat(640, 480, 8, 1));
+    QVERIFY(pool.setFormat(320, 240, 8, 4));
+    QCOMPARE(pool.getExpectedBytes(), 320 * 240 * 4);
+}
+
+void QGCVideoFramePoolTest::receiveFrame_test()
+{
+    QGCVideoFramePool pool;
+    pool.setFormat(4, 2, 8, 1);
+    const unsigned char data[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+    pool.beginFrame();
+    QVERIFY(!pool.writePixels(data, 5, 0));
+    QVERIFY(pool.writePixels(data + 5, 3, 5));
+    pool.commitFrame();
+    QVERIFY(pool.hasPendingFrame());
+
+    const QImage* frame = pool.takePendingFrame();
+    QVERIFY(frame != NULL);
+    QCOMPARE(frame->size(), QSize(4, 2));
+    QCOMPARE(frame->pixelIndex(1, 1), 5);
+    pool.markUploaded();
+    pool.markDisplayed();
+
+    QVERIFY(!pool.hasPendingFrame());
+    QCOMPARE(pool.displayedFrame(), frame);
+    QCOMPARE(pool.getDisplayedFrames(), (quint64)1);
+    QCOMPARE(pool.getLatency(QGCVideoFramePool::STAGE_TOTAL).samples, (quint64)1);
+}
+
+void QGCVideoFramePoolTest::reuseBuffers_test()
+{
+    QGCVideoFramePool pool;
+    pool.setFormat(64, 48, 8, 1);
+    QByteArray data(pool.getExpectedBytes(), 0x7f);
+    QSet<const uchar*> buffers;
+
+    for (int i = 0; i < 20; i++) {
+        pool.beginFrame();
+        pool.writePixels(reinterpret_cast<const unsigned char*>(data.constData()), data.size(), 0);
+        pool.commitFrame();
+        buffers.insert(pool.takePendingFrame()->bits());
+        pool.markDisplayed();
+    }
+
+    // The stream cycles through the pooled buffers
+    QVERIFY(buffers.size() <= 3);
+    QCOMPARE(pool.getCompletedFrames(), (quint64)20);
+    QCOMPARE(pool.getDroppedFrames(), (quint64)0);
+    QCOMPARE(pool.getIncompleteFrames(), (quint64)0);
+}
+
+void QGCVideoFramePoolTest::dropSuperseded_test()
+{
+    QGCVideoFramePool pool;
+    pool.setFormat(4, 2, 8, 1);
+    const unsigned char data[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+    // Two frames complete before the display catches up
+    for (int i = 0; i < 2; i++) {
+        pool.beginFrame();
+        pool.writePixels(data, 8, 0);
+        pool.commitFrame();
+    }
+    // A partial frame is still shown, but counted
+    pool.beginFrame();
+    pool.writePixels(data, 4, 0);
+    pool.commitFrame();
+
+    QCOMPARE(pool.getCompletedFrames(), (quint64)3);
+    QCOMPARE(pool.getDroppedFrames(), (quint64)2);
+    QCOMPARE(pool.getIncompleteFrames(), (quint64)1);
+    QVERIFY(pool.takePendingFrame() != NULL);
+    QVERIFY(pool.takePendingFrame() == NULL);
+}
+
+void QGCVideoFramePoolTest::rejectOverflow_test()
+{
+    QGCVideoFramePool pool;
+    pool.setFormat(4, 2, 8, 1);
+    const unsigned char data[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+    // Nothing is written before a frame was started
+    QVERIFY(!pool.writePixels(data, 8, 0));
+    QVERIFY(!pool.isReceiving());
+
+    pool.beginFrame();
+    QVERIFY(!pool.writePixels(data, 8, 4));
+    QVERIFY(pool.isReceiving());
+}
@@ -0,0 +1,27 @@
+#ifndef QGCVIDEOFRAMEPOOLTEST_H
+#define QGCVIDEOFRAMEPOOLTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "QGCVideoFramePool.h"
+#include "AutoTest.h"
+
+class QGCVideoFramePoolTest : public QObject
+{
+    Q_OBJECT
+public:
+  QGCVideoFramePoolTest();
+
+private slots:
+  void setFormat_test();
+  void receiveFrame_test();
+  void reuseBuffers_test();
+  void dropSuperseded_test();
+  void rejectOverflow_test();
+};
+
+DECLARE_TEST(QGCVideoFramePoolTest)
+
+#endif // QGCVIDEOFRAMEPOOLTEST_H
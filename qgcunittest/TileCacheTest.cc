@@ -0,0 +1,181 @@
+#include "TileCacheTest.h"
+
+#include <QBuffer>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+
+using namespace qmapcontrol;
+
+TileCacheTest::TileCacheTest()
+{
+}
+
+void TileCacheTest::initTestCase()
+{
+    cacheDir = QDir::tempPath() + QDir::separator() + "qgc_tilecache_test";
+    removeCacheDir();
+}
+
+void TileCacheTest::cleanup()
+{
+    removeCacheDir();
+}
+
+void TileCacheTest::removeCacheDir()
+{
+    QDir dir(cacheDir);
+    if (!dir.exists()) return;
+
+    // Files first, then the directories deepest first
+    QStringList dirs;
+    QDirIterator it(cacheDir, QDir::AllEntries | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        if (it.fileInfo().isDir()) {
+            dirs.prepend(it.filePath());
+        } else {
+            QFile::remove(it.filePath());
+        }
+    }
+    foreach (const QString& path, dirs) {
+        dir.rmdir(path);
+    }
+    dir.rmdir(cacheDir);
+}
+
+QPixmap TileCacheTest::tile(int i)
+{
+    QPixmap pixmap(16, 16);
+    pixmap.fill(QColor(i, 0, 0));
+    return pixmap;
+}
+
+int TileCacheTest::cost(const QPixmap& tile)
+{
+    return tile.width() * tile.height() * tile.depth() / 8;
+}
+
+void TileCacheTest::memoryLimit_test()
+{
+    TileCache cache;
+    cache.setMemoryLimit(3 * cost(tile(0)));
+    QCOMPARE(cache.memoryLimit(), 3 * cost(tile(0)));
+
+    for (int i = 0; i < 10; ++i) {
+        cache.insert("osm", 1, i, 0, tile(i));
+        QVERIFY(cache.memoryUsed() <= cache.memoryLimit());
+    }
+    QCOMPARE(cache.memoryUsed(), 3 * cost(tile(0)));
+
+    // Lowering the limit evicts right away
+    cache.setMemoryLimit(cost(tile(0)));
+    QCOMPARE(cache.memoryUsed(), cost(tile(0)));
+
+    cache.clearMemory();
+    QCOMPARE(cache.memoryUsed(), 0);
+}
+
+void TileCacheTest::eviction_test()
+{
+    TileCache cache;
+    cache.setMemoryLimit(3 * cost(tile(0)));
+    cache.insert("osm", 1, 0, 0, tile(0));
+    cache.insert("osm", 1, 1, 0, tile(1));
+    cache.insert("osm", 1, 2, 0, tile(2));
+
+    // A hit makes the tile the most recently used one
+    QPixmap found;
+    QVERIFY(cache.find("osm", 1, 0, 0, found));
+    cache.insert("osm", 1, 3, 0, tile(3));
+
+    QVERIFY(cache.find("osm", 1, 0, 0, found));
+    QVERIFY(!cache.find("osm", 1, 1, 0, found));
+    QVERIFY(cache.find("osm", 1, 2, 0, found));
+    QVERIFY(cache.find("osm", 1, 3, 0, found));
+
+    // Tiles are told apart by provider, zoom and position
+    QVERIFY(!cache.find("google", 1, 3, 0, found));
+    QVERIFY(!cache.find("osm", 2, 3, 0, found));
+    QVERIFY(!cache.find("osm", 1, 0, 3, found));
+}
+
+void TileCacheTest::persistence_test()
+{
+    QImage image(16, 16, QImage::Format_RGB32);
+    image.fill(0xff204060);
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    QVERIFY(image.save(&buffer, "PNG"));
+
+    TileCache cache;
+    QImage loaded;
+    QVERIFY(!cache.load("osm", 1, 0, 0, loaded));
+
+    cache.setCacheDir(QDir(cacheDir));
+    QVERIFY(cache.isPersistent());
+    cache.insert("http://tile.openstreetmap.org/%1/%2/%3.png", 5, 17, 11, QPixmap::fromImage(image), data);
+    cache.insert("osm", 5, 17, 12, tile(7));
+
+    // The memory cache never reads from disk
+    cache.clearMemory();
+    QPixmap found;
+    QVERIFY(!cache.find("http://tile.openstreetmap.org/%1/%2/%3.png", 5, 17, 11, found));
+
+    // A new cache on the same directory sees the tiles of the last session
+    TileCache restored;
+    restored.setCacheDir(QDir(cacheDir));
+    QVERIFY(restored.load("http://tile.openstreetmap.org/%1/%2/%3.png", 5, 17, 11, loaded));
+    QCOMPARE(loaded.size(), image.size());
+    QCOMPARE(loaded.pixel(8, 8), image.pixel(8, 8));
+
+    // Tiles without the original data are stored as PNG
+    QVERIFY(restored.load("osm", 5, 17, 12, loaded));
+    QCOMPARE(loaded.size(), QSize(16, 16));
+    QCOMPARE(QColor(loaded.pixel(8, 8)), QColor(7, 0, 0));
+
+    QVERIFY(!restored.load("osm", 5, 17, 13, loaded));
+
+    restored.insertInMemory("osm", 5, 17, 12, QPixmap::fromImage(loaded));
+    QVERIFY(restored.find("osm", 5, 17, 12, found));
+    QCOMPARE(found.size(), QSize(16, 16));
+}
+
+void TileCacheTest::unreadable_test()
+{
+    TileCache cache;
+    cache.setCacheDir(QDir(cacheDir));
+    cache.insert("osm", 1, 0, 0, tile(0), QByteArray("<html>rate limited</html>"));
+
+    // Broken tiles are removed, so they are downloaded again
+    QImage loaded;
+    QVERIFY(!cache.load("osm", 1, 0, 0, loaded));
+    cache.insert("osm", 1, 0, 0, tile(1));
+    QVERIFY(cache.load("osm", 1, 0, 0, loaded));
+}
+
+void TileCacheTest::legacyTiles_test()
+{
+    TileCache cache;
+    cache.setCacheDir(QDir(cacheDir));
+    cache.insert("osm", 1, 0, 0, tile(0));
+
+    // Older versions named the tiles after the base64 encoded url
+    const QString legacy = QString("-1-0-0.png").toAscii().toBase64();
+    const QString other = "notes.txt";
+    foreach (const QString& name, QStringList() << legacy << other) {
+        QFile file(cacheDir + QDir::separator() + name);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("tile");
+    }
+
+    QCOMPARE(TileCache::removeLegacyTiles(QDir(cacheDir)), 1);
+    QVERIFY(!QFile::exists(cacheDir + QDir::separator() + legacy));
+    QVERIFY(QFile::exists(cacheDir + QDir::separator() + other));
+
+    // Tiles of the current layout are kept
+    QImage loaded;
+    QVERIFY(cache.load("osm", 1, 0, 0, loaded));
+    QCOMPARE(TileCache::removeLegacyTiles(QDir(cacheDir)), 0);
+}
@@ -0,0 +1,37 @@
+#ifndef TILECACHETEST_H
+#define TILECACHETEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "tilecache.h"
+#include "AutoTest.h"
+
+class TileCacheTest : public QObject
+{
+    Q_OBJECT
+public:
+  TileCacheTest();
+
+private:
+  static QPixmap tile(int i);
+  static int cost(const QPixmap& tile);
+  /** @brief Delete the cache directory with all tiles */
+  void removeCacheDir();
+
+  QString cacheDir;
+
+private slots:
+  void initTestCase();
+  void cleanup();
+  void memoryLimit_test();
+  void eviction_test();
+  void persistence_test();
+  void unreadable_test();
+  void legacyTiles_test();
+};
+
+DECLARE_TEST(TileCacheTest)
+
+#endif // TILECACHETEST_H
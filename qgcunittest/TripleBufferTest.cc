@@ -0,0 +1,92 @@
+#include "TripleBufferTest.h"
+
+#include <QThread>
+
+namespace
+{
+
+typedef struct {
+    quint32 values[4096];
+} Frame;
+
+/** @brief Publishes frames whose values all equal their sequence number */
+class Producer : public QThread
+{
+public:
+    Producer(TripleBuffer<Frame>& _buffer, quint32 _frames)
+        : buffer(_buffer)
+        , frames(_frames)
+    {
+    }
+
+protected:
+    virtual void run()
+    {
+        for (quint32 sequence = 1; sequence <= frames; sequence++) {
+            Frame& frame = buffer.writeSlot();
+            for (int i = 0; i < 4096; i++) {
+                frame.values[i] = sequence;
+            }
+            buffer.publish();
+        }
+    }
+
+    TripleBuffer<Frame>& buffer;
+    quint32 frames;
+};
+
+}
+
+TripleBufferTest::TripleBufferTest()
+{
+}
+
+void TripleBufferTest::initial_test()
+{
+    TripleBuffer<int> buffer;
+    QCOMPARE(buffer.readSlot(), 0);
+    QCOMPARE(buffer.readSequence(), 0u);
+}
+
+void TripleBufferTest::newest_test()
+{
+    TripleBuffer<int> buffer;
+    for (int i = 1; i <= 3; i++) {
+        buffer.writeSlot() = i;
+        buffer.publish();
+    }
+
+    // Frames the consumer did not pick up are skipped
+    QCOMPARE(buffer.readSlot(), 3);
+    QCOMPARE(buffer.readSequence(), 3u);
+
+    // Without a new frame the last one stays
+    QCOMPARE(buffer.readSlot(), 3);
+
+    buffer.writeSlot() = 4;
+    buffer.publish();
+    QCOMPARE(buffer.readSlot(), 4);
+    QCOMPARE(buffer.readSequence(), 4u);
+}
+
+void TripleBufferTest::concurrent_test()
+{
+    TripleBuffer<Frame>* buffer = new TripleBuffer<Frame>;
+    const quint32 frames = 20000;
+    Producer producer(*buffer, frames);
+    producer.start();
+
+    // Every frame the consumer sees must be complete and newer than the last
+    quint32 last = 0;
+    while (last < frames) {
+        const Frame& frame = buffer->readSlot();
+        quint32 sequence = buffer->readSequence();
+        QVERIFY(sequence >= last);
+        QCOMPARE(frame.values[0], sequence);
+        QCOMPARE(frame.values[4095], sequence);
+        last = sequence;
+    }
+
+    producer.wait();
+    delete buffer;
+}
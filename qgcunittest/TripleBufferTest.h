@@ -0,0 +1,25 @@
+#ifndef TRIPLEBUFFERTEST_H
+#define TRIPLEBUFFERTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "TripleBuffer.h"
+#include "AutoTest.h"
+
+class TripleBufferTest : public QObject
+{
+    Q_OBJECT
+public:
+  TripleBufferTest();
+
+private slots:
+  void initial_test();
+  void newest_test();
+  void concurrent_test();
+};
+
+DECLARE_TEST(TripleBufferTest)
+
+#endif // TRIPLEBUFFERTEST_H
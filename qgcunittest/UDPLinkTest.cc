@@ -0,0 +1,162 @@
+#include "UDPLinkTest.h"
+
+static const quint16 linkPort = 14601;
+static const quint16 receiverPort = 14602;
+
+UDPLinkTest::UDPLinkTest() :
+    receiver(NULL),
+    receiverAddress(QHostAddress::LocalHost)
+{
+}
+
+void UDPLinkTest::init()
+{
+    receiver = new QUdpSocket(this);
+    QVERIFY(receiver->bind(receiverAddress, receiverPort));
+}
+
+void UDPLinkTest::cleanup()
+{
+    delete receiver;
+    receiver = NULL;
+}
+
+QList<QByteArray> UDPLinkTest::receive(int bytes, int timeout)
+{
+    QList<QByteArray> datagrams;
+    int received = 0;
+    QTime waiting;
+    waiting.start();
+    while (received < bytes && waiting.elapsed() < timeout) {
+        if (!receiver->hasPendingDatagrams()) {
+            QTest::qWait(5);
+            continue;
+        }
+        QByteArray datagram(receiver->pendingDatagramSize(), 0);
+        receiver->readDatagram(datagram.data(), datagram.size());
+        received += datagram.size();
+        datagrams.append(datagram);
+    }
+    return datagrams;
+}
+
+bool UDPLinkTest::waitSent(UDPLink& link)
+{
+    QTime waiting;
+    waiting.start();
+    while (link.getBacklog(receiverAddress) > 0 && waiting.elapsed() < 2000) {
+        QTest::qWait(5);
+    }
+    return link.getBacklog(receiverAddress) == 0;
+}
+
+void UDPLinkTest::coalescing_test()
+{
+    UDPLink link(QHostAddress::LocalHost, linkPort);
+    link.addHost(QString("127.0.0.1:%1").arg(receiverPort));
+    QVERIFY(link.connect());
+
+    // A burst of small messages is combined into few datagrams
+    QByteArray sent;
+    for (int i = 0; i < 100; ++i) {
+        QByteArray message(20, char(i));
+        link.writeBytes(message.constData(), message.size());
+        sent.append(message);
+    }
+
+    QList<QByteArray> datagrams = receive(sent.size());
+    QVERIFY(datagrams.size() < 10);
+    QByteArray received;
+    foreach (const QByteArray& datagram, datagrams) {
+        // Datagrams stay below the usual path MTU
+        QVERIFY(datagram.size() <= 1400);
+        // Messages are never split
+        QCOMPARE(datagram.size() % 20, 0);
+        received.append(datagram);
+    }
+    QCOMPARE(received, sent);
+
+    // A single message after a quiet period is sent on its own
+    QTest::qWait(20);
+    link.writeBytes("ping", 4);
+    datagrams = receive(4);
+    QCOMPARE(datagrams.size(), 1);
+    QCOMPARE(datagrams.first(), QByteArray("ping"));
+}
+
+void UDPLinkTest::backlog_test()
+{
+    UDPLink link(QHostAddress::LocalHost, linkPort);
+    link.addHost(QString("127.0.0.1:%1").arg(receiverPort));
+    QCOMPARE(link.getBacklog(receiverAddress), 0);
+    QCOMPARE(link.getBacklog(QHostAddress("10.1.2.3")), 0);
+
+    // Nothing is queued without a socket
+    link.writeBytes("ping", 4);
+    QCOMPARE(link.getBacklog(receiverAddress), 0);
+    QCOMPARE(link.getDroppedBytes(receiverAddress), quint64(0));
+
+    QVERIFY(link.connect());
+    QByteArray message(1000, 'x');
+    for (int i = 0; i < 50; ++i) {
+        link.writeBytes(message.constData(), message.size());
+    }
+    QVERIFY(link.getBacklog(receiverAddress) <= 50 * message.size());
+
+    // The link thread empties the queue on its own
+    QVERIFY(waitSent(link));
+    int received = 0;
+    foreach (const QByteArray& datagram, receive(50 * message.size())) {
+        received += datagram.size();
+    }
+    QCOMPARE(received, 50 * message.size());
+    QCOMPARE(link.getDroppedBytes(receiverAddress), quint64(0));
+}
+
+void UDPLinkTest::drop_test()
+{
+    UDPLink link(QHostAddress::LocalHost, linkPort);
+    link.addHost(QString("127.0.0.1:%1").arg(receiverPort));
+    QVERIFY(link.connect());
+
+    // A message which does not fit into the backlog is dropped and counted
+    QByteArray huge(70000, 'x');
+    link.writeBytes(huge.constData(), huge.size());
+    QCOMPARE(link.getDroppedBytes(receiverAddress), quint64(huge.size()));
+    QCOMPARE(link.getBacklog(receiverAddress), 0);
+
+    // Later messages are still sent
+    link.writeBytes("ping", 4);
+    QList<QByteArray> datagrams = receive(4);
+    QCOMPARE(datagrams.size(), 1);
+    QCOMPARE(datagrams.first(), QByteArray("ping"));
+    QCOMPARE(link.getDroppedBytes(receiverAddress), quint64(huge.size()));
+}
+
+void UDPLinkTest::reconnect_test()
+{
+    UDPLink link(QHostAddress::LocalHost, linkPort);
+    link.addHost(QString("127.0.0.1:%1").arg(receiverPort));
+    QVERIFY(link.connect());
+    QVERIFY(link.isRunning());
+
+    // Disconnecting ends the link thread right after it started
+    link.disconnect();
+    QVERIFY(!link.isConnected());
+    QVERIFY(!link.isRunning());
+    link.writeBytes("lost", 4);
+    QVERIFY(receive(4, 100).isEmpty());
+
+    // Connecting twice rebinds the socket
+    QVERIFY(link.connect());
+    QVERIFY(link.connect());
+    link.writeBytes("ping", 4);
+    QList<QByteArray> datagrams = receive(4);
+    QCOMPARE(datagrams.size(), 1);
+    QCOMPARE(datagrams.first(), QByteArray("ping"));
+
+    // A port in use is reported
+    UDPLink busy(QHostAddress::LocalHost, linkPort);
+    QVERIFY(!busy.connect());
+    QVERIFY(!busy.isConnected());
+}
@@ -0,0 +1,38 @@
+#ifndef UDPLINKTEST_H
+#define UDPLINKTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+#include <QUdpSocket>
+
+#include "UDPLink.h"
+#include "AutoTest.h"
+
+class UDPLinkTest : public QObject
+{
+    Q_OBJECT
+public:
+  UDPLinkTest();
+
+private:
+  /** @brief Collect datagrams until the given number of bytes arrived or the timeout passed */
+  QList<QByteArray> receive(int bytes, int timeout=2000);
+  /** @brief Wait until the backlog of the receiver dropped to zero */
+  bool waitSent(UDPLink& link);
+
+  QUdpSocket* receiver;
+  QHostAddress receiverAddress;
+
+private slots:
+  void init();
+  void cleanup();
+  void coalescing_test();
+  void backlog_test();
+  void drop_test();
+  void reconnect_test();
+};
+
+DECLARE_TEST(UDPLinkTest)
+
+#endif // UDPLINKTEST_H
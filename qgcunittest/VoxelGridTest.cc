@@ -0,0 +1,134 @@
+#include "VoxelGridTest.h"
+
+VoxelGridTest::VoxelGridTest()
+{
+}
+
+void VoxelGridTest::addPoint(PointCloud& cloud, float x, float y, float z, unsigned char gray)
+{
+    cloud.reserve(cloud.size + 1);
+    cloud.x[cloud.size] = x;
+    cloud.y[cloud.size] = y;
+    cloud.z[cloud.size] = z;
+    cloud.r[cloud.size] = gray;
+    cloud.g[cloud.size] = gray;
+    cloud.b[cloud.size] = gray;
+    cloud.size++;
+}
+
+void VoxelGridTest::downsample_test()
+{
+    VoxelGrid grid(0.1f, 10.0f);
+    PointCloud in;
+    addPoint(in, 0.01f, 0.01f, 1.01f, 100);
+    addPoint(in, 0.03f, 0.05f, 1.05f, 200);
+    addPoint(in, 0.21f, 0.01f, 1.01f, 50);
+    addPoint(in, -0.01f, 0.01f, 1.01f, 10);
+
+    // The first two points share a voxel, the others have their own
+    PointCloud out;
+    QCOMPARE(grid.downsample(in, out), 3);
+    QCOMPARE(out.size, 3);
+    QVERIFY(qAbs(out.x[0] - 0.02f) < 1e-6f);
+    QVERIFY(qAbs(out.y[0] - 0.03f) < 1e-6f);
+    QVERIFY(qAbs(out.z[0] - 1.03f) < 1e-6f);
+    QCOMPARE(out.r[0], static_cast<unsigned char>(150));
+    QCOMPARE(out.r[1], static_cast<unsigned char>(50));
+    QCOMPARE(out.r[2], static_cast<unsigned char>(10));
+
+    // The table is reused, nothing may be left over from the last call
+    in.size = 1;
+    QCOMPARE(grid.downsample(in, out), 1);
+    QCOMPARE(out.r[0], static_cast<unsigned char>(100));
+}
+
+void VoxelGridTest::levelOfDetail_test()
+{
+    PointCloud in;
+    addPoint(in, 0.01f, 0.01f, 10.01f, 0);
+    addPoint(in, 0.11f, 0.01f, 10.01f, 0);
+    PointCloud out;
+
+    // Close to the sensor both points keep their own voxel
+    VoxelGrid grid(0.05f, 20.0f);
+    QCOMPARE(grid.downsample(in, out), 2);
+
+    // Five times beyond the level of detail distance the voxels are 8 times larger
+    grid.setLodDistance(2.0f);
+    QCOMPARE(grid.downsample(in, out), 1);
+}
+
+void VoxelGridTest::occupancy_test()
+{
+    OccupancyMap map(0.1f, 1000);
+    PointCloud cloud;
+    addPoint(cloud, 0.01f, 0.01f, 0.01f, 100);
+    addPoint(cloud, 0.02f, 0.02f, 0.02f, 100);
+    addPoint(cloud, 1.01f, 0.01f, 0.01f, 100);
+
+    QMatrix4x4 pose;
+    map.insert(cloud, pose);
+    QCOMPARE(map.size(), 2);
+
+    // A voxel has to be seen in two clouds before it is reported
+    PointCloud out;
+    QCOMPARE(map.extract(out), 0);
+    QCOMPARE(map.extract(out, 1), 2);
+
+    // The second cloud is taken from one meter further, only one voxel is seen again
+    pose.translate(-1.0f, 0.0f, 0.0f);
+    map.insert(cloud, pose);
+    QCOMPARE(map.size(), 3);
+    QCOMPARE(map.extract(out), 1);
+    QVERIFY(qAbs(out.x[0] - 0.05f) < 1e-6f);
+    QVERIFY(qAbs(out.y[0] - 0.05f) < 1e-6f);
+    QVERIFY(qAbs(out.z[0] - 0.05f) < 1e-6f);
+
+    map.clear();
+    QCOMPARE(map.size(), 0);
+}
+
+void VoxelGridTest::occupancyCapacity_test()
+{
+    OccupancyMap map(0.1f, 100);
+    PointCloud cloud;
+    for (int i = 0; i < 40; i++) {
+        addPoint(cloud, i * 0.1f + 0.05f, 0.05f, 0.05f, 0);
+    }
+
+    // Fly along a line, each cloud covers 40 new voxels
+    QMatrix4x4 pose;
+    for (int i = 0; i < 10; i++) {
+        map.insert(cloud, pose);
+        QVERIFY(map.size() <= map.getCapacity());
+        pose.translate(0.0f, 1.0f, 0.0f);
+    }
+
+    // The most recent cloud is still there
+    PointCloud out;
+    QCOMPARE(map.extract(out, 1), map.size());
+    int recent = 0;
+    for (int i = 0; i < out.size; i++) {
+        if (out.y[i] > 9.0f) recent++;
+    }
+    QCOMPARE(recent, 40);
+}
+
+void VoxelGridTest::downsample_benchmark()
+{
+    // A full Kinect frame of a wall 0.5 to 5 m away
+    PointCloud in(640 * 480);
+    for (int i = 0; i < 640 * 480; i++) {
+        float z = 0.5f + (i % 640) * 4.5f / 640.0f;
+        in.x[i] = ((i % 640) - 320) / 580.0f * z;
+        in.y[i] = ((i / 640) - 240) / 580.0f * z;
+        in.z[i] = z;
+    }
+    in.size = 640 * 480;
+
+    VoxelGrid grid(0.05f, 2.0f);
+    PointCloud out;
+    QBENCHMARK {
+        grid.downsample(in, out);
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef VOXELGRIDTEST_H
+#define VOXELGRIDTEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "VoxelGrid.h"
+#include "OccupancyMap.h"
+#include "AutoTest.h"
+
+class VoxelGridTest : public QObject
+{
+    Q_OBJECT
+public:
+  VoxelGridTest();
+
+private slots:
+  void downsample_test();
+  void levelOfDetail_test();
+  void occupancy_test();
+  void occupancyCapacity_test();
+
+  void downsample_benchmark();
+
+private:
+  static void addPoint(PointCloud& cloud, float x, float y, float z, unsigned char gray);
+};
+
+DECLARE_TEST(VoxelGridTest)
+
+#endif // VOXELGRIDTEST_H
@@ -0,0 +1,150 @@
+#include "WebImageCacheTest.h"
+
+#include <QDir>
+#include <QImage>
+
+WebImageCacheTest::WebImageCacheTest()
+{
+}
+
+void WebImageCacheTest::initTestCase()
+{
+    // Local tiles are decoded from their file, no network is involved
+    for (int i = 0; i < 4; ++i) {
+        QImage image(16, 8, QImage::Format_RGB32);
+        image.fill(0xff000000 + i);
+        QVERIFY(image.save(tile(i), "PNG"));
+    }
+    missingTile = QDir::tempPath() + QDir::separator() + "qgc_webimagecache_missing.png";
+    QFile::remove(missingTile);
+}
+
+void WebImageCacheTest::cleanupTestCase()
+{
+    for (int i = 0; i < 4; ++i) {
+        QFile::remove(tile(i));
+    }
+}
+
+QString WebImageCacheTest::tile(int i) const
+{
+    return QDir::tempPath() + QDir::separator() + QString("qgc_webimagecache_%1.png").arg(i);
+}
+
+bool WebImageCacheTest::waitIdle(WebImageCache& cache)
+{
+    QTime waiting;
+    waiting.start();
+    while (cache.isBusy() && waiting.elapsed() < 5000) {
+        QTest::qWait(10);
+    }
+    return !cache.isBusy();
+}
+
+void WebImageCacheTest::ready_test()
+{
+    WebImageCache cache(0, 4);
+    WebImagePtr image = cache.lookup(tile(0));
+    QVERIFY(!image.isNull());
+    QCOMPARE(image->getState(), WebImage::REQUESTED);
+    QVERIFY(cache.isBusy());
+
+    QVERIFY(waitIdle(cache));
+    QCOMPARE(image->getState(), WebImage::READY);
+    QCOMPARE(image->getWidth(), 16);
+    QCOMPARE(image->getHeight(), 8);
+
+    // Finished images are handed out once
+    QCOMPARE(cache.takeReady(), image);
+    QVERIFY(cache.takeReady().isNull());
+    QVERIFY(cache.takeFailed().isEmpty());
+
+    // And stay cached
+    QCOMPARE(cache.lookup(tile(0)), image);
+    QVERIFY(!cache.isBusy());
+}
+
+void WebImageCacheTest::pending_test()
+{
+    WebImageCache cache(0, 1);
+    WebImagePtr image = cache.lookup(tile(0));
+
+    // A pending request is not issued twice and cannot be evicted
+    QCOMPARE(cache.lookup(tile(0)), image);
+    QVERIFY(cache.lookup(tile(1)).isNull());
+
+    QVERIFY(waitIdle(cache));
+    QVERIFY(!cache.lookup(tile(1)).isNull());
+    QVERIFY(waitIdle(cache));
+}
+
+void WebImageCacheTest::failed_test()
+{
+    WebImageCache cache(0, 4);
+    WebImagePtr image = cache.lookup(missingTile);
+    QVERIFY(waitIdle(cache));
+
+    QCOMPARE(image->getState(), WebImage::UNINITIALIZED);
+    QCOMPARE(cache.takeFailed(), missingTile);
+    QVERIFY(cache.takeFailed().isEmpty());
+    QVERIFY(cache.takeReady().isNull());
+
+    // Within the retry interval the failure is not requested again
+    QCOMPARE(cache.lookup(missingTile), image);
+    QCOMPARE(image->getState(), WebImage::UNINITIALIZED);
+    QVERIFY(!cache.isBusy());
+}
+
+void WebImageCacheTest::retry_test()
+{
+    WebImageCache cache(0, 4);
+    cache.setRetryInterval(0);
+    WebImagePtr image = cache.lookup(missingTile);
+    QVERIFY(waitIdle(cache));
+    QCOMPARE(cache.takeFailed(), missingTile);
+
+    // After the retry interval the same entry is requested again
+    QCOMPARE(cache.lookup(missingTile), image);
+    QCOMPARE(image->getState(), WebImage::REQUESTED);
+    QVERIFY(waitIdle(cache));
+    QCOMPARE(cache.takeFailed(), missingTile);
+}
+
+void WebImageCacheTest::eviction_test()
+{
+    WebImageCache cache(0, 2);
+    WebImagePtr first = cache.lookup(tile(0));
+    QVERIFY(waitIdle(cache));
+    WebImagePtr second = cache.lookup(tile(1));
+    QVERIFY(waitIdle(cache));
+
+    // Looking up the first image makes the second the least recently used
+    QCOMPARE(cache.lookup(tile(0)), first);
+    cache.lookup(tile(2));
+    QVERIFY(waitIdle(cache));
+
+    QCOMPARE(cache.lookup(tile(0)), first);
+    WebImagePtr again = cache.lookup(tile(1));
+    QVERIFY(again != second);
+    QCOMPARE(again->getState(), WebImage::REQUESTED);
+    QVERIFY(waitIdle(cache));
+}
+
+void WebImageCacheTest::failedEviction_test()
+{
+    WebImageCache cache(0, 2);
+    WebImagePtr ready = cache.lookup(tile(0));
+    QVERIFY(waitIdle(cache));
+    WebImagePtr failed = cache.lookup(missingTile);
+    QVERIFY(waitIdle(cache));
+
+    // A failed image which stays in view does not keep its slot
+    cache.lookup(tile(0));
+    cache.lookup(missingTile);
+    cache.lookup(tile(2));
+    QVERIFY(waitIdle(cache));
+
+    QCOMPARE(cache.lookup(tile(0)), ready);
+    QVERIFY(cache.lookup(missingTile) != failed);
+    QVERIFY(waitIdle(cache));
+}
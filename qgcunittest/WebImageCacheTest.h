@@ -0,0 +1,37 @@
+#ifndef WEBIMAGECACHETEST_H
+#define WEBIMAGECACHETEST_H
+
+#include <QObject>
+#include <QtCore/QString>
+#include <QtTest/QtTest>
+
+#include "WebImageCache.h"
+#include "AutoTest.h"
+
+class WebImageCacheTest : public QObject
+{
+    Q_OBJECT
+public:
+  WebImageCacheTest();
+
+private:
+  /** @brief Process events until the cache finished all requests */
+  bool waitIdle(WebImageCache& cache);
+
+  QString tile(int i) const;
+  QString missingTile;
+
+private slots:
+  void initTestCase();
+  void cleanupTestCase();
+  void ready_test();
+  void pending_test();
+  void failed_test();
+  void retry_test();
+  void eviction_test();
+  void failedEviction_test();
+};
+
+DECLARE_TEST(WebImageCacheTest)
+
+#endif // WEBIMAGECACHETEST_H
@@ -212,6 +212,7 @@ HEADERS += src/MG.h \
     src/comm/SerialSimulationLink.h \
     src/comm/ProtocolInterface.h \
     src/comm/MAVLinkProtocol.h \
+    src/comm/MAVLinkRouter.h \
     src/comm/AS4Protocol.h \
     src/ui/CommConfigurationWindow.h \
     src/ui/SerialConfigurationWindow.h \
@@ -243,6 +244,7 @@ HEADERS += src/MG.h \
     src/ui/mavlink/DomModel.h \
     src/comm/MAVLinkXMLParser.h \
     src/ui/HDDisplay.h \
+    src/ui/HDDisplayGaugeTable.h \
     src/ui/MAVLinkSettingsWidget.h \
     src/ui/AudioOutputWidget.h \
     src/GAudioOutput.h \
@@ -266,6 +268,7 @@ HEADERS += src/MG.h \
     src/ui/linechart/IncrementalPlot.h \
     src/ui/map/Waypoint2DIcon.h \
     src/ui/map/MAV2DIcon.h \
+    src/ui/map/MAV2DTrail.h \
     src/ui/QGCRemoteControlView.h \
     src/ui/RadioCalibration/RadioCalibrationData.h \
     src/ui/RadioCalibration/RadioCalibrationWindow.h \
@@ -294,10 +297,14 @@ HEADERS += src/MG.h \
     src/ui/QGCWaypointListMulti.h \
     src/ui/QGCUDPLinkConfiguration.h \
     src/ui/QGCSettingsWidget.h \
+    src/ui/QGCFrameScheduler.h \
+    src/ui/QGCVideoFramePool.h \
+    src/ui/QGCVideoTexture.h \
     src/ui/uas/UASControlParameters.h \
     src/ui/mission/QGCMissionDoWidget.h \
     src/ui/mission/QGCMissionConditionWidget.h \
-    src/uas/QGCUASParamManager.h
+    src/uas/QGCUASParamManager.h \
+    src/uas/QGCImageTransfer.h
 
 # Google Earth is only supported on Mac OS and Windows with Visual Studio Compiler
 macx|win32-msvc2008: {
@@ -321,7 +328,8 @@ contains(DEPENDENCIES_PRESENT, osg) {
         src/ui/map3D/Texture.h \
         src/ui/map3D/Imagery.h \
         src/ui/map3D/HUDScaleGeode.h \
-        src/ui/map3D/WaypointGroupNode.h
+        src/ui/map3D/WaypointGroupNode.h \
+        src/ui/map3D/TrailNode.h
     contains(DEPENDENCIES_PRESENT, osgearth) { 
         message("Including headers for OSGEARTH")
         
@@ -333,7 +341,11 @@ contains(DEPENDENCIES_PRESENT, libfreenect) {
     message("Including headers for libfreenect")
     
     # Enable only if libfreenect is available
-    HEADERS += src/input/Freenect.h
+    HEADERS += src/input/Freenect.h \
+        src/input/PointCloudProjector.h \
+        src/input/VoxelGrid.h \
+        src/input/OccupancyMap.h \
+        src/input/TripleBuffer.h
 }
 
 SOURCES += src/main.cc \
@@ -344,6 +356,7 @@ SOURCES += src/main.cc \
     src/comm/SerialLink.cc \
     src/comm/SerialSimulationLink.cc \
     src/comm/MAVLinkProtocol.cc \
+    src/comm/MAVLinkRouter.cc \
     src/comm/AS4Protocol.cc \
     src/ui/CommConfigurationWindow.cc \
     src/ui/SerialConfigurationWindow.cc \
@@ -374,6 +387,7 @@ SOURCES += src/main.cc \
     src/ui/mavlink/DomModel.cc \
     src/comm/MAVLinkXMLParser.cc \
     src/ui/HDDisplay.cc \
+    src/ui/HDDisplayGaugeTable.cc \
     src/ui/MAVLinkSettingsWidget.cc \
     src/ui/AudioOutputWidget.cc \
     src/GAudioOutput.cc \
@@ -397,6 +411,7 @@ SOURCES += src/main.cc \
     src/ui/linechart/IncrementalPlot.cc \
     src/ui/map/Waypoint2DIcon.cc \
     src/ui/map/MAV2DIcon.cc \
+    src/ui/map/MAV2DTrail.cc \
     src/ui/QGCRemoteControlView.cc \
     src/ui/RadioCalibration/RadioCalibrationWindow.cc \
     src/ui/RadioCalibration/AirfoilServoCalibrator.cc \
@@ -424,10 +439,14 @@ SOURCES += src/main.cc \
     src/ui/QGCWaypointListMulti.cc \
     src/ui/QGCUDPLinkConfiguration.cc \
     src/ui/QGCSettingsWidget.cc \
+    src/ui/QGCFrameScheduler.cc \
+    src/ui/QGCVideoFramePool.cc \
+    src/ui/QGCVideoTexture.cc \
     src/ui/uas/UASControlParameters.cpp \
     src/ui/mission/QGCMissionDoWidget.cc \
     src/ui/mission/QGCMissionConditionWidget.cc \
-    src/uas/QGCUASParamManager.cc
+    src/uas/QGCUASParamManager.cc \
+    src/uas/QGCImageTransfer.cc
 
 macx|win32-msvc2008: {
     SOURCES += src/ui/map3D/QGCGoogleEarthView.cc
@@ -451,6 +470,7 @@ contains(DEPENDENCIES_PRESENT, osg) {
         src/ui/map3D/Imagery.cc \
         src/ui/map3D/HUDScaleGeode.cc \
         src/ui/map3D/WaypointGroupNode.cc \
+        src/ui/map3D/TrailNode.cc \
 
 
     contains(DEPENDENCIES_PRESENT, osgearth) { 
@@ -464,7 +484,10 @@ contains(DEPENDENCIES_PRESENT, libfreenect) {
     message("Including sources for libfreenect")
     
     # Enable only if libfreenect is available
-    SOURCES += src/input/Freenect.cc
+    SOURCES += src/input/Freenect.cc \
+        src/input/PointCloudProjector.cc \
+        src/input/VoxelGrid.cc \
+        src/input/OccupancyMap.cc
 }
 RESOURCES += mavground.qrc
 
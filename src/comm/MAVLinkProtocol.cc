@@ -206,6 +206,20 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
                 }
             }
 
+            // Multiplex message if enabled. This also forwards messages of
+            // systems without UAS object, e.g. of other ground stations.
+            if (m_multiplexingEnabled) {
+                QList<LinkInterface*> targets = router.route(link, message, LinkManager::instance()->getLinksForProtocol(this), getSystemId());
+                if (!targets.isEmpty()) {
+                    // Forward the frame as received, with the sender's ids, sequence number and checksum
+                    uint8_t buffer[MAVLINK_MAX_PACKET_LEN];
+                    int len = mavlink_msg_to_send_buffer(buffer, &message);
+                    foreach (LinkInterface* target, targets) {
+                        if (target->isConnected()) target->writeBytes((const char*)buffer, len);
+                    }
+                }
+            }
+
             // ORDER MATTERS HERE!
             // If the matching UAS object does not yet exist, it has to be created
             // before emitting the packetReceived signal
@@ -307,19 +321,6 @@ void MAVLinkProtocol::receiveBytes(LinkInterface* link, QByteArray b)
                 // kind of inefficient, but no issue for a groundstation pc.
                 // It buys as reentrancy for the whole code over all threads
                 emit messageReceived(link, message);
-
-                // Multiplex message if enabled
-                if (m_multiplexingEnabled) {
-                    // Get all links connected to this unit
-                    QList<LinkInterface*> links = LinkManager::instance()->getLinksForProtocol(this);
-
-                    // Emit message on all links that are currently connected
-                    foreach (LinkInterface* currLink, links) {
-                        // Only forward this message to the other links,
-                        // not the link the message was received on
-                        if (currLink != link) sendMessage(currLink, message);
-                    }
-                }
             }
         }
     }
@@ -420,10 +421,22 @@ void MAVLinkProtocol::enableMultiplexing(bool enabled)
     bool changed = false;
     if (enabled != m_multiplexingEnabled) changed = true;
 
+    receiveMutex.lock();
     m_multiplexingEnabled = enabled;
+    // Routes are learned again once multiplexing is re-enabled
+    if (!enabled) router.clear();
+    receiveMutex.unlock();
     if (changed) emit multiplexingChanged(m_multiplexingEnabled);
 }
 
+QHash<int, MAVLinkRouter::Route> MAVLinkProtocol::getRoutes()
+{
+    receiveMutex.lock();
+    QHash<int, MAVLinkRouter::Route> routes = router.getRoutes();
+    receiveMutex.unlock();
+    return routes;
+}
+
 void MAVLinkProtocol::enableAuth(bool enable)
 {
     bool changed = false;
@@ -40,6 +40,7 @@ This file is part of the QGROUNDCONTROL project
 #include "ProtocolInterface.h"
 #include "LinkInterface.h"
 #include "QGCMAVLink.h"
+#include "MAVLinkRouter.h"
 #include "QGC.h"
 
 /**
@@ -82,6 +83,8 @@ public:
     bool multiplexingEnabled() const {
         return m_multiplexingEnabled;
     }
+    /** @brief Get the multiplexing routes and their traffic counters, by system id */
+    QHash<int, MAVLinkRouter::Route> getRoutes();
     /** @brief Get the authentication state */
     bool getAuthEnabled() {
         return m_authEnabled;
@@ -191,6 +194,7 @@ protected:
     bool m_actionGuardEnabled;       ///< Action request retransmission enabled
     int m_actionRetransmissionTimeout; ///< Timeout for parameter retransmission
     QMutex receiveMutex;       ///< Mutex to protect receiveBytes function
+    MAVLinkRouter router;      ///< Routes multiplexed messages, protected by receiveMutex
     int lastIndex[256][256];
     int totalReceiveCounter;
     int totalLossCounter;
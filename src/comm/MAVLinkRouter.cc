@@ -0,0 +1,140 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the class MAVLinkRouter.
+ *
+ */
+
+#include "MAVLinkRouter.h"
+
+MAVLinkRouter::Route::Route()
+    : link(NULL)
+    , framesReceived(0)
+    , bytesReceived(0)
+    , framesForwarded(0)
+    , bytesForwarded(0)
+    , framesDelivered(0)
+{
+}
+
+MAVLinkRouter::MAVLinkRouter()
+{
+}
+
+QList<LinkInterface*>
+MAVLinkRouter::route(LinkInterface* link, const mavlink_message_t& message,
+                     const QList<LinkInterface*>& links, int localSystemId)
+{
+    const int length = message.len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+
+    // The sender is reachable through the link it was heard on last
+    Route& source = routes[message.sysid];
+    source.link = link;
+    source.framesReceived++;
+    source.bytesReceived += length;
+
+    QList<LinkInterface*> targets;
+    int target = targetSystem(message);
+    if (target != 0 && target == localSystemId) {
+        return targets;
+    }
+
+    QHash<int, Route>::iterator destination = routes.find(target);
+    if (target != 0 && destination != routes.end() && links.contains(destination.value().link)) {
+        // The target already received the frame if it is on the same link
+        if (destination.value().link != link) {
+            targets.append(destination.value().link);
+            destination.value().framesDelivered++;
+        }
+    } else {
+        // Frames to all systems and to unknown systems go to all other links
+        foreach (LinkInterface* currLink, links) {
+            if (currLink != link) targets.append(currLink);
+        }
+    }
+
+    source.framesForwarded += targets.size();
+    source.bytesForwarded += (quint64)targets.size() * length;
+    return targets;
+}
+
+void
+MAVLinkRouter::clear(void)
+{
+    routes.clear();
+}
+
+int
+MAVLinkRouter::targetSystem(const mavlink_message_t& message)
+{
+    switch (message.msgid) {
+    case MAVLINK_MSG_ID_PING:
+        return mavlink_msg_ping_get_target_system(&message);
+    case MAVLINK_MSG_ID_CHANGE_OPERATOR_CONTROL:
+        return mavlink_msg_change_operator_control_get_target_system(&message);
+    case MAVLINK_MSG_ID_ACTION:
+        return mavlink_msg_action_get_target(&message);
+    case MAVLINK_MSG_ID_SET_MODE:
+        return mavlink_msg_set_mode_get_target(&message);
+    case MAVLINK_MSG_ID_SET_NAV_MODE:
+        return mavlink_msg_set_nav_mode_get_target(&message);
+    case MAVLINK_MSG_ID_PARAM_REQUEST_READ:
+        return mavlink_msg_param_request_read_get_target_system(&message);
+    case MAVLINK_MSG_ID_PARAM_REQUEST_LIST:
+        return mavlink_msg_param_request_list_get_target_system(&message);
+    case MAVLINK_MSG_ID_PARAM_SET:
+        return mavlink_msg_param_set_get_target_system(&message);
+    case MAVLINK_MSG_ID_WAYPOINT:
+        return mavlink_msg_waypoint_get_target_system(&message);
+    case MAVLINK_MSG_ID_WAYPOINT_REQUEST:
+        return mavlink_msg_waypoint_request_get_target_system(&message);
+    case MAVLINK_MSG_ID_WAYPOINT_SET_CURRENT:
+        return mavlink_msg_waypoint_set_current_get_target_system(&message);
+    case MAVLINK_MSG_ID_WAYPOINT_REQUEST_LIST:
+        return mavlink_msg_waypoint_request_list_get_target_system(&message);
+    case MAVLINK_MSG_ID_WAYPOINT_COUNT:
+        return mavlink_msg_waypoint_count_get_target_system(&message);
+    case MAVLINK_MSG_ID_WAYPOINT_CLEAR_ALL:
+        return mavlink_msg_waypoint_clear_all_get_target_system(&message);
+    case MAVLINK_MSG_ID_WAYPOINT_ACK:
+        return mavlink_msg_waypoint_ack_get_target_system(&message);
+    case MAVLINK_MSG_ID_GPS_SET_GLOBAL_ORIGIN:
+        return mavlink_msg_gps_set_global_origin_get_target_system(&message);
+    case MAVLINK_MSG_ID_LOCAL_POSITION_SETPOINT_SET:
+        return mavlink_msg_local_position_setpoint_set_get_target_system(&message);
+    case MAVLINK_MSG_ID_SAFETY_SET_ALLOWED_AREA:
+        return mavlink_msg_safety_set_allowed_area_get_target_system(&message);
+    case MAVLINK_MSG_ID_SET_ALTITUDE:
+        return mavlink_msg_set_altitude_get_target(&message);
+    case MAVLINK_MSG_ID_REQUEST_DATA_STREAM:
+        return mavlink_msg_request_data_stream_get_target_system(&message);
+    case MAVLINK_MSG_ID_MANUAL_CONTROL:
+        return mavlink_msg_manual_control_get_target(&message);
+    case MAVLINK_MSG_ID_COMMAND:
+        return mavlink_msg_command_get_target_system(&message);
+    default:
+        return 0;
+    }
+}
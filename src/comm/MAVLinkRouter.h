@@ -0,0 +1,90 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the class MAVLinkRouter.
+ *
+ */
+
+#ifndef MAVLINKROUTER_H
+#define MAVLINKROUTER_H
+
+#include <QHash>
+#include <QList>
+#include "QGCMAVLink.h"
+
+class LinkInterface;
+
+/**
+ * @brief Routes MAVLink frames between links without re-encoding them
+ *
+ * The router learns on which link each system is reachable from the frames
+ * it receives. A frame addressed to a known system is only forwarded to the
+ * link of this system, all other frames to every link except the one they
+ * were received on. The frames are forwarded as they were received, with the
+ * sender's system and component id, sequence number and checksum.
+ *
+ * The router does not access the links, it only decides where a frame goes.
+ */
+class MAVLinkRouter
+{
+public:
+    /** @brief Route to one system, with its traffic counters */
+    struct Route {
+        Route();
+        LinkInterface* link;      ///< Link the system was last heard on
+        quint64 framesReceived;   ///< Frames received from the system
+        quint64 bytesReceived;    ///< Bytes received from the system
+        quint64 framesForwarded;  ///< Copies of the system's frames forwarded to other links
+        quint64 bytesForwarded;   ///< Bytes of the system's frames forwarded to other links
+        quint64 framesDelivered;  ///< Frames addressed to the system and forwarded to its link
+    };
+
+    MAVLinkRouter();
+
+    /**
+     * @brief Learn the route to the sender of a frame and choose the links to forward it to
+     *
+     * @param link the link the frame was received on
+     * @param message the received frame
+     * @param links all links the frame may be forwarded to
+     * @param localSystemId system id of this ground station, frames addressed to it are not forwarded
+     * @return the links to forward the frame to
+     */
+    QList<LinkInterface*> route(LinkInterface* link, const mavlink_message_t& message, const QList<LinkInterface*>& links, int localSystemId);
+    /** @brief Forget all routes and counters */
+    void clear();
+    /** @brief All known routes, by system id */
+    const QHash<int, Route>& getRoutes() const {
+        return routes;
+    }
+
+    /** @brief System a frame is addressed to, 0 for frames to all systems */
+    static int targetSystem(const mavlink_message_t& message);
+
+protected:
+    QHash<int, Route> routes; ///< Route to each system heard, by system id
+};
+
+#endif // MAVLINKROUTER_H
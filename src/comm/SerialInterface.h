@@ -33,9 +33,12 @@ This file is part of the QGROUNDCONTROL project
 #define SERIALINTERFACE_H
 
 #include <QIODevice>
+#include <QTime>
 #include "qextserialport.h"
 #include <QtSerialPort/QSerialPort>
 #include <iostream>
+#include "MG.h"
+#include <configuration.h>
 
 /**
  * @brief The SerialInterface abstracts low level serial calls
@@ -125,6 +128,8 @@ public:
     virtual bool isOpen() = 0;
     virtual bool isWritable() = 0;
     virtual qint64 bytesAvailable() = 0;
+    /** @brief Block until bytes can be read or the timeout in milliseconds expired, true if bytes are available */
+    virtual bool waitForReadyRead(int timeout) = 0;
     virtual int write(const char * data, qint64 size) = 0;
     virtual void read(char * data, qint64 numBytes) = 0;
     virtual void flush() = 0;
@@ -163,6 +168,16 @@ public:
     virtual qint64 bytesAvailable() {
         return _port->bytesAvailable();
     }
+    virtual bool waitForReadyRead(int timeout) {
+        // The port is opened in polling mode, which cannot block on incoming bytes
+        QTime waiting;
+        waiting.start();
+        while (_port->bytesAvailable() <= 0) {
+            if (waiting.elapsed() >= timeout) return false;
+            MG::SLEEP::msleep(SERIAL_POLL_INTERVAL);
+        }
+        return true;
+    }
     virtual int write(const char * data, qint64 size) {
         return _port->write(data,size);
     }
@@ -229,11 +244,14 @@ public:
         return _port->isOpen();
     }
     virtual bool isWritable() {
-        _port->isWritable();
+        return _port->isWritable();
     }
     virtual qint64 bytesAvailable() {
         return _port->bytesAvailable();
     }
+    virtual bool waitForReadyRead(int timeout) {
+        return _port->waitForReadyRead(timeout);
+    }
     virtual int write(const char * data, qint64 size) {
         return _port->write(data,size);
     }
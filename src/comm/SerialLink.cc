@@ -25,7 +25,9 @@
 
 SerialLink::SerialLink(QString portname, SerialInterface::baudRateType baudrate, SerialInterface::flowType flow, SerialInterface::parityType parity,
                        SerialInterface::dataBitsType dataBits, SerialInterface::stopBitsType stopBits) :
-    port(NULL)
+    port(NULL),
+    stopRequested(0),
+    nextReadBuffer(0)
 {
     // Setup settings
     this->porthandle = portname.trimmed();
@@ -45,7 +47,7 @@ SerialLink::SerialLink(QString portname, SerialInterface::baudRateType baudrate,
     this->parity = parity;
     this->dataBits = dataBits;
     this->stopBits = stopBits;
-    this->timeout = 1; ///< The timeout controls how long the program flow should wait for new serial bytes. As we're polling, we don't want to wait at all.
+    this->timeout = 1; ///< The timeout controls how long a read waits for new serial bytes. The thread waits for bytes before reading, so reads don't have to wait at all.
 
     // Set the port name
     if (porthandle == "")
@@ -104,17 +106,55 @@ void SerialLink::run()
     // Initialize the connection
     hardwareConnect();
 
-    // Qt way to make clear what a while(1) loop does
-    forever {
-        // Check if new bytes have arrived, if yes, emit the notification signal
-        checkForBytes();
-        /* Serial data isn't arriving that fast normally, this saves the thread
-                 * from consuming too much processing time
-                 */
-        MG::SLEEP::msleep(SerialLink::poll_interval);
+    // Read the bytes that arrived while opening, emits disconnected() if the port did not open
+    checkForBytes();
+
+    while (!stopRequested && isConnected()) {
+        /* Block until the next bytes arrive instead of polling: they are read
+         * right away, and a silent line only wakes the thread once per timeout
+         */
+        bool ready = port->waitForReadyRead(SerialLink::read_timeout);
+
+        dataMutex.lock();
+        qint64 available = port->bytesAvailable();
+        dataMutex.unlock();
+
+        if (available < 0 || (ready && available == 0)) {
+            // An unplugged or hung up port stays readable without delivering
+            // any bytes, waiting on it again would return at once forever
+            closeLostPort();
+            break;
+        }
+        if (available > 0) readBytes();
     }
 }
 
+void SerialLink::stopThread()
+{
+    if (!isRunning() || QThread::currentThread() == this) return;
+
+    // The thread notices the request at the latest after one read timeout
+    stopRequested = 1;
+    wait();
+    stopRequested = 0;
+}
+
+/**
+ * @brief Close a port that was unplugged or hung up
+ *
+ * Called from the link thread, which returns from run() afterwards. Closing
+ * the port emits disconnected() through its aboutToClose() signal.
+ **/
+void SerialLink::closeLostPort()
+{
+    dataMutex.lock();
+    port->close();
+    dataMutex.unlock();
+
+    emit connected(false);
+    emit communicationError(this->getName(), tr("Link %1 was unplugged or hung up.").arg(this->getName()));
+}
+
 
 void SerialLink::checkForBytes()
 {
@@ -161,27 +201,32 @@ void SerialLink::writeBytes(const char* data, qint64 size)
 }
 
 /**
- * @brief Read a number of bytes from the interface.
+ * @brief Read all available bytes from the interface and emit them with bytesReceived().
  *
- * @param data Pointer to the data byte array to write the bytes to
- * @param maxLength The maximum number of bytes to write
+ * The bytes are read into the next buffer of a ring of receive buffers and
+ * handed out as an implicitly shared copy of it, so a read neither copies nor
+ * allocates. A buffer is only reallocated if a consumer still holds the bytes
+ * it carried when the ring comes back to it.
  **/
 void SerialLink::readBytes()
 {
+    QByteArray received;
     dataMutex.lock();
     if(port && port->isOpen()) {
-        const qint64 maxLength = 2048;
-        char data[maxLength];
         qint64 numBytes = port->bytesAvailable();
         //qDebug() << "numBytes: " << numBytes;
 
         if(numBytes > 0) {
             /* Read as much data in buffer as possible without overflow */
-            if(maxLength < numBytes) numBytes = maxLength;
+            if(read_buffer_size < numBytes) numBytes = read_buffer_size;
 
-            port->read(data, numBytes);
-            QByteArray b(data, numBytes);
-            emit bytesReceived(this, b);
+            QByteArray& buffer = readBuffers[nextReadBuffer];
+            nextReadBuffer = (nextReadBuffer + 1) % read_buffer_count;
+            // Detaches from a consumer still holding the buffer, keeps the capacity otherwise
+            buffer.reserve(read_buffer_size);
+            buffer.resize(numBytes);
+            port->read(buffer.data(), numBytes);
+            received = buffer;
 
             //qDebug() << "SerialLink::readBytes()" << std::hex << data;
             //            int i;
@@ -195,6 +240,9 @@ void SerialLink::readBytes()
         }
     }
     dataMutex.unlock();
+
+    // Emit outside of the lock, receivers may call back into the link
+    if (!received.isEmpty()) emit bytesReceived(this, received);
 }
 
 
@@ -220,17 +268,12 @@ qint64 SerialLink::bytesAvailable()
 bool SerialLink::disconnect()
 {
     if (port) {
-        //#if !defined _WIN32 || !defined _WIN64
-        /* Block the thread until it returns from run() */
-        //#endif
-//        dataMutex.lock();
+        /* Block the thread until it returns from run(), it must not wait on a deleted port */
+        stopThread(); //restart it upon connect
         port->flush();
         port->close();
         delete port;
         port = NULL;
-//        dataMutex.unlock();
-
-        if(this->isRunning()) this->terminate(); //stop running the thread, restart it upon connect
 
         bool closed = true;
         //port->isOpen();
@@ -35,7 +35,9 @@ This file is part of the QGROUNDCONTROL project
 #include <QObject>
 #include <QThread>
 #include <QMutex>
+#include <QAtomicInt>
 #include <QString>
+#include <QByteArray>
 #include "SerialInterface.h"
 #include <configuration.h>
 #include "SerialLinkInterface.h"
@@ -67,6 +69,9 @@ public:
     ~SerialLink();
 
     static const int poll_interval = SERIAL_POLL_INTERVAL; ///< Polling interval, defined in configuration.h
+    static const int read_timeout = 100; ///< Longest time the thread blocks waiting for bytes, in milliseconds
+    static const int read_buffer_size = 16384; ///< Largest number of bytes handed out by one read
+    static const int read_buffer_count = 8; ///< Number of receive buffers reused in turn
 
     bool isConnected();
     qint64 bytesAvailable();
@@ -164,9 +169,16 @@ protected:
     quint64 connectionStartTime;
     QMutex statisticsMutex;
     QMutex dataMutex;
+    QAtomicInt stopRequested; ///< Set to let the thread return from run()
+    QByteArray readBuffers[read_buffer_count]; ///< Ring of receive buffers, shared with the consumers of bytesReceived()
+    int nextReadBuffer; ///< Index of the receive buffer used by the next read
 
     void setName(QString name);
     bool hardwareConnect();
+    /** @brief Let the thread return from run() and wait for it */
+    void stopThread();
+    /** @brief Close the port after it was unplugged or hung up */
+    void closeLostPort();
 
 signals:
     void aboutToCloseFlag();
@@ -38,15 +38,28 @@ This file is part of the QGROUNDCONTROL project
 #include "QGC.h"
 #include <QHostInfo>
 //#include <netinet/in.h>
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <errno.h>
+#endif
 
 UDPLink::UDPLink(QHostAddress host, quint16 port)
 {
     this->host = host;
     this->port = port;
     this->connectState = false;
+    this->socket = NULL;
     // Set unique ID and add link to the list of links
     this->id = getNextLinkId();
     this->name = tr("UDP Link (port:%1)").arg(14550);
+
+    // The socket and the send timer are created by run()
+    this->sendTimer = NULL;
+    this->sendScheduled = false;
+    // Received bytes are emitted from the link thread
+    qRegisterMetaType<LinkInterface*>("LinkInterface*");
     LinkManager::instance()->add(this);
 }
 
@@ -58,14 +71,39 @@ UDPLink::~UDPLink()
 /**
  * @brief Runs the thread
  *
+ * The socket and the send timer are created here and belong to this thread,
+ * so reading and sending does not wait for the GUI event loop.
  **/
 void UDPLink::run()
 {
-//    forever
-//    {
-//        QGC::SLEEP::msleep(5000);
-//    }
+    QUdpSocket udpSocket;
+    QTimer timer;
+    timer.setSingleShot(true);
+    QObject::connect(&udpSocket, SIGNAL(readyRead()), this, SLOT(readBytes()), Qt::DirectConnection);
+    QObject::connect(&timer, SIGNAL(timeout()), this, SLOT(sendQueued()), Qt::DirectConnection);
+
+    connectState = udpSocket.bind(host, port);
+    if (connectState) {
+        QMutexLocker locker(&dataMutex);
+        socket = &udpSocket;
+        sendTimer = &timer;
+        lastSend = QTime();
+    }
+    bindDone.release();
+    if (!connectState) return;
+
     exec();
+
+    // Drop what was not sent yet
+    QMutexLocker locker(&dataMutex);
+    socket = NULL;
+    sendTimer = NULL;
+    sendScheduled = false;
+    QHash<QHostAddress, Peer>::iterator h;
+    for (h = hosts.begin(); h != hosts.end(); ++h) {
+        h.value().datagrams.clear();
+        h.value().backlog = 0;
+    }
 }
 
 void UDPLink::setAddress(QString address)
@@ -100,16 +138,15 @@ void UDPLink::addHost(const QString& host)
                     address = hostAddresses.at(i);
                 }
             }
-            hosts.append(address);
             qDebug() << "Address:" << address.toString();
             // Set port according to user input
-            ports.append(host.split(":").last().toInt());
+            QMutexLocker locker(&dataMutex);
+            hosts[address].port = host.split(":").last().toInt();
         } else {
             QHostInfo info = QHostInfo::fromName(host);
-            // Add host
-            hosts.append(info.addresses().first());
-            // Set port according to default (this port)
-            ports.append(port);
+            // Add host, set port according to default (this port)
+            QMutexLocker locker(&dataMutex);
+            hosts[info.addresses().first()].port = port;
         }
     }
 }
@@ -128,80 +165,228 @@ void UDPLink::removeHost(const QString& hostname)
             address = hostAddresses.at(i);
         }
     }
-    for (int i = 0; i < hosts.count(); ++i) {
-        if (hosts.at(i) == address) {
-            hosts.removeAt(i);
-            ports.removeAt(i);
-        }
-    }
+    QMutexLocker locker(&dataMutex);
+    hosts.remove(address);
+}
+
+int UDPLink::getBacklog(const QHostAddress& host)
+{
+    QMutexLocker locker(&dataMutex);
+    return hosts.value(host).backlog;
+}
+
+quint64 UDPLink::getDroppedBytes(const QHostAddress& host)
+{
+    QMutexLocker locker(&dataMutex);
+    return hosts.value(host).dropped;
 }
 
 
+/**
+ * @brief Queue a message for all connected systems.
+ *
+ * The message is appended to the send queue of every peer. After a quiet
+ * period it is sent right away by the link thread, messages following it
+ * within the send window are combined into as few datagrams as possible.
+ * May be called from any thread.
+ **/
 void UDPLink::writeBytes(const char* data, qint64 size)
 {
-    // Broadcast to all connected systems
-    for (int h = 0; h < hosts.size(); h++)
+    QMutexLocker locker(&dataMutex);
+    if (!socket) return;
+
+    QHash<QHostAddress, Peer>::iterator h;
+    for (h = hosts.begin(); h != hosts.end(); ++h)
     {
-        QHostAddress currentHost = hosts.at(h);
-        quint16 currentPort = ports.at(h);
-        QString bytes;
-        QString ascii;
-        //qDebug() << "WRITING DATA TO" << currentHost.toString() << currentPort;
-        for (int i=0; i<size; i++) {
-            unsigned char v = data[i];
-            bytes.append(QString().sprintf("%02x ", v));
-            ascii.append(data[i]);
+        Peer& peer = h.value();
+        if (peer.backlog + size > maxBacklog) {
+            peer.dropped += size;
+            continue;
         }
-        qDebug() << "Sent" << size << "bytes to" << currentHost.toString() << ":" << currentPort << "data:";
-        qDebug() << bytes;
-        qDebug() << "ASCII:" << ascii;
+        if (peer.datagrams.isEmpty() || peer.datagrams.last().size() + size > maxCoalescedSize) {
+            peer.datagrams.append(QByteArray());
+        }
+        peer.datagrams.last().append(data, size);
+        peer.backlog += size;
+    }
 
-        socket->writeDatagram(data, size, currentHost, currentPort);
+    // The timer belongs to the link's thread, start it there
+    if (!sendScheduled && !hosts.isEmpty()) {
+        sendScheduled = true;
+        int delay = 0;
+        if (lastSend.isValid()) delay = qMax(0, sendWindow - lastSend.elapsed());
+        QMetaObject::invokeMethod(sendTimer, "start", Qt::QueuedConnection, Q_ARG(int, delay));
     }
 }
 
+#ifdef Q_OS_LINUX
+/** @brief Fill a socket address, returns its length */
+static socklen_t toSocketAddress(const QHostAddress& host, quint16 port, sockaddr_storage& address)
+{
+    memset(&address, 0, sizeof(address));
+    if (host.protocol() == QAbstractSocket::IPv6Protocol) {
+        sockaddr_in6* address6 = reinterpret_cast<sockaddr_in6*>(&address);
+        address6->sin6_family = AF_INET6;
+        address6->sin6_port = htons(port);
+        Q_IPV6ADDR ip = host.toIPv6Address();
+        memcpy(&address6->sin6_addr, &ip, sizeof(ip));
+        return sizeof(sockaddr_in6);
+    }
+    sockaddr_in* address4 = reinterpret_cast<sockaddr_in*>(&address);
+    address4->sin_family = AF_INET;
+    address4->sin_port = htons(port);
+    address4->sin_addr.s_addr = htonl(host.toIPv4Address());
+    return sizeof(sockaddr_in);
+}
+#endif
+
+void UDPLink::sendQueued()
+{
+    QMutexLocker locker(&dataMutex);
+    sendScheduled = false;
+    if (!socket) return;
+    lastSend.start();
+
+#ifdef Q_OS_LINUX
+    // Send the datagrams of all peers, a batch with each system call
+    mmsghdr messages[sendBatchSize];
+    iovec vectors[sendBatchSize];
+    sockaddr_storage addresses[sendBatchSize];
+    Peer* peers[sendBatchSize];
+    bool blocked = false;
+    while (!blocked) {
+        int count = 0;
+        QHash<QHostAddress, Peer>::iterator h;
+        for (h = hosts.begin(); h != hosts.end() && count < sendBatchSize; ++h) {
+            Peer& peer = h.value();
+            for (int i = 0; i < peer.datagrams.size() && count < sendBatchSize; i++, count++) {
+                const QByteArray& datagram = peer.datagrams.at(i);
+                memset(&messages[count], 0, sizeof(mmsghdr));
+                vectors[count].iov_base = const_cast<char*>(datagram.constData());
+                vectors[count].iov_len = datagram.size();
+                messages[count].msg_hdr.msg_iov = &vectors[count];
+                messages[count].msg_hdr.msg_iovlen = 1;
+                messages[count].msg_hdr.msg_name = &addresses[count];
+                messages[count].msg_hdr.msg_namelen = toSocketAddress(h.key(), peer.port, addresses[count]);
+                peers[count] = &peer;
+            }
+        }
+        if (count == 0) break;
+
+        int sent = sendmmsg(socket->socketDescriptor(), messages, count, MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+                // The socket buffer is full, retry with the next send window
+                sent = 0;
+                blocked = true;
+            } else {
+                // The first datagram cannot be sent at all, e.g. an unreachable host. Drop it.
+                sent = 1;
+            }
+        } else if (sent < count) {
+            blocked = true;
+        }
+
+        // The datagrams were taken from the front of each peer's queue, in order
+        for (int i = 0; i < sent; i++) {
+            peers[i]->backlog -= peers[i]->datagrams.first().size();
+            peers[i]->datagrams.removeFirst();
+        }
+    }
+
+    if (blocked) {
+        sendScheduled = true;
+        sendTimer->start(sendWindow);
+    }
+#else
+    QHash<QHostAddress, Peer>::iterator h;
+    for (h = hosts.begin(); h != hosts.end(); ++h) {
+        Peer& peer = h.value();
+        foreach (const QByteArray& datagram, peer.datagrams) {
+            socket->writeDatagram(datagram, h.key(), peer.port);
+        }
+        peer.datagrams.clear();
+        peer.backlog = 0;
+    }
+#endif
+}
+
+#ifdef Q_OS_LINUX
+/** @brief Port of a socket address in host byte order */
+static quint16 socketAddressPort(const sockaddr_storage& address)
+{
+    if (address.ss_family == AF_INET6) return ntohs(reinterpret_cast<const sockaddr_in6*>(&address)->sin6_port);
+    return ntohs(reinterpret_cast<const sockaddr_in*>(&address)->sin_port);
+}
+#endif
+
 /**
- * @brief Read a number of bytes from the interface.
+ * @brief Read all pending datagrams and emit their payload at once.
  *
- * @param data Pointer to the data byte array to write the bytes to
- * @param maxLength The maximum number of bytes to write
+ * The buffers are sized to the largest datagram, so no datagram is truncated.
+ * Every sender is added to the peers messages are sent to, or its port is
+ * updated.
  **/
 void UDPLink::readBytes()
 {
-    const qint64 maxLength = 2048;
-    char data[maxLength];
+    if (!socket) return;
+#ifdef Q_OS_LINUX
+    const int bufferCount = receiveBatchSize;
+#else
+    const int bufferCount = 1;
+#endif
+    if (receiveBuffer.size() < bufferCount * maxDatagramSize) receiveBuffer.resize(bufferCount * maxDatagramSize);
+
+    QByteArray received;
     QHostAddress sender;
     quint16 senderPort;
 
-    unsigned int s = socket->pendingDatagramSize();
-    if (s > maxLength) std::cerr << __FILE__ << __LINE__ << " UDP datagram overflow, allowed to read less bytes than datagram size" << std::endl;
-    socket->readDatagram(data, maxLength, &sender, &senderPort);
-
-    // FIXME TODO Check if this method is better than retrieving the data by individual processes
-    QByteArray b(data, s);
-    emit bytesReceived(this, b);
-
-//    // Echo data for debugging purposes
-//    std::cerr << __FILE__ << __LINE__ << "Received datagram:" << std::endl;
-//    int i;
-//    for (i=0; i<s; i++)
-//    {
-//        unsigned int v=data[i];
-//        fprintf(stderr,"%02x ", v);
-//    }
-//    std::cerr << std::endl;
-
-
-    // Add host to broadcast list if not yet present
-    if (!hosts.contains(sender)) {
-        hosts.append(sender);
-        ports.append(senderPort);
-        //        ports->insert(sender, senderPort);
-    } else {
-        int index = hosts.indexOf(sender);
-        ports.replace(index, senderPort);
+    // The first datagram is read through the socket, this re-enables its read notification
+    qint64 size = socket->readDatagram(receiveBuffer.data(), maxDatagramSize, &sender, &senderPort);
+    if (size < 0) return;
+    received.append(receiveBuffer.constData(), size);
+    dataMutex.lock();
+    hosts[sender].port = senderPort;
+    dataMutex.unlock();
+
+#ifdef Q_OS_LINUX
+    // Drain all further pending datagrams, a batch with each system call
+    mmsghdr messages[receiveBatchSize];
+    iovec vectors[receiveBatchSize];
+    sockaddr_storage senders[receiveBatchSize];
+    int count;
+    do {
+        memset(messages, 0, sizeof(messages));
+        for (int i = 0; i < receiveBatchSize; i++) {
+            vectors[i].iov_base = receiveBuffer.data() + i * maxDatagramSize;
+            vectors[i].iov_len = maxDatagramSize;
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &senders[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(senders[i]);
+        }
+        count = recvmmsg(socket->socketDescriptor(), messages, receiveBatchSize, MSG_DONTWAIT, NULL);
+        QMutexLocker locker(&dataMutex);
+        for (int i = 0; i < count; i++) {
+            if (messages[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                std::cerr << __FILE__ << __LINE__ << " UDP datagram larger than " << maxDatagramSize << " bytes dropped" << std::endl;
+                continue;
+            }
+            received.append(static_cast<const char*>(vectors[i].iov_base), messages[i].msg_len);
+            hosts[QHostAddress(reinterpret_cast<sockaddr*>(&senders[i]))].port = socketAddressPort(senders[i]);
+        }
+    } while (count == receiveBatchSize);
+#else
+    while (socket->hasPendingDatagrams()) {
+        size = socket->readDatagram(receiveBuffer.data(), maxDatagramSize, &sender, &senderPort);
+        if (size < 0) break;
+        received.append(receiveBuffer.constData(), size);
+        QMutexLocker locker(&dataMutex);
+        hosts[sender].port = senderPort;
     }
+#endif
 
+    emit bytesReceived(this, received);
 }
 
 
@@ -212,6 +397,8 @@ void UDPLink::readBytes()
  **/
 qint64 UDPLink::bytesAvailable()
 {
+    QMutexLocker locker(&dataMutex);
+    if (!socket) return 0;
     return socket->pendingDatagramSize();
 }
 
@@ -222,8 +409,11 @@ qint64 UDPLink::bytesAvailable()
  **/
 bool UDPLink::disconnect()
 {
-    delete socket;
-    socket = NULL;
+    // The thread deletes the socket and drops the unsent messages when its
+    // event loop ends. A quit() before the loop started is lost, so repeat it.
+    do {
+        quit();
+    } while (!wait(10));
 
     connectState = false;
 
@@ -239,7 +429,11 @@ bool UDPLink::disconnect()
  **/
 bool UDPLink::connect()
 {
-    socket = new QUdpSocket(this);
+    if (isRunning()) disconnect();
+
+    // The socket is bound by run()
+    start(HighPriority);
+    bindDone.acquire();
 
     //Check if we are using a multicast-address
 //    bool multicast = false;
@@ -250,7 +444,7 @@ bool UDPLink::connect()
 //    }
 //    else
 //    {
-    connectState = socket->bind(host, port);
+//    connectState = socket->bind(host, port);
 //    }
 
     //Provides Multicast functionality to UdpSocket
@@ -279,7 +473,6 @@ bool UDPLink::connect()
     */
 
     //QObject::connect(socket, SIGNAL(readyRead()), this, SLOT(readPendingDatagrams()));
-    QObject::connect(socket, SIGNAL(readyRead()), this, SLOT(readBytes()));
 
     emit connected(connectState);
     if (connectState) {
@@ -287,7 +480,6 @@ bool UDPLink::connect()
         connectionStartTime = QGC::groundTimeUsecs()/1000;
     }
 
-    start(HighPriority);
     return connectState;
 }
 
@@ -34,7 +34,12 @@ This file is part of the QGROUNDCONTROL project
 #include <QString>
 #include <QList>
 #include <QMap>
+#include <QHash>
+#include <QByteArray>
 #include <QMutex>
+#include <QSemaphore>
+#include <QTime>
+#include <QTimer>
 #include <QUdpSocket>
 #include <LinkInterface.h>
 #include <configuration.h>
@@ -66,8 +71,13 @@ public:
     int getDataBitsType();
     int getStopBitsType();
     QList<QHostAddress> getHosts() {
-        return hosts;
+        QMutexLocker locker(&dataMutex);
+        return hosts.keys();
     }
+    /** @brief Number of bytes queued for a peer and not sent yet */
+    int getBacklog(const QHostAddress& host);
+    /** @brief Number of bytes dropped because the backlog of a peer was full */
+    quint64 getDroppedBytes(const QHostAddress& host);
 
     /* Extensive statistics for scientific purposes */
     qint64 getNominalDataRate();
@@ -80,6 +90,7 @@ public:
     qint64 getBitsSent();
     qint64 getBitsReceived();
 
+    /** @brief Owns the socket and the send timer, so datagrams are read and sent in this thread */
     void run();
 
     int getLinkQuality();
@@ -106,15 +117,39 @@ public slots:
     bool connect();
     bool disconnect();
 
+protected slots:
+    /** @brief Send all queued datagrams */
+    void sendQueued();
+
 protected:
+    /** @brief A system messages are sent to, with its send queue */
+    struct Peer {
+        Peer() : port(0), backlog(0), dropped(0) {}
+        quint16 port;
+        QList<QByteArray> datagrams; ///< Queued datagrams, each holds one or more messages
+        int backlog;                 ///< Number of queued bytes
+        quint64 dropped;             ///< Number of bytes dropped because the backlog was full
+    };
+
     QString name;
     QHostAddress host;
     quint16 port;
     int id;
-    QUdpSocket* socket;
+    QUdpSocket* socket; ///< Lives in the link thread while it runs, NULL otherwise
     bool connectState;
-    QList<QHostAddress> hosts;
-    QList<quint16> ports;
+    QSemaphore bindDone; ///< Released by run() once the socket is bound or failed to
+    QHash<QHostAddress, Peer> hosts; ///< Peers messages are sent to
+    QByteArray receiveBuffer; ///< Receive buffers for one batch of datagrams, allocated once
+    QTimer* sendTimer; ///< Sends the queued datagrams, lives in the link thread while it runs
+    bool sendScheduled; ///< True if the send timer is started or about to be
+    QTime lastSend; ///< Time of the last send, to tell a burst from a single message
+
+    static const int maxDatagramSize = 65536; ///< Largest datagram a UDP socket delivers
+    static const int receiveBatchSize = 8; ///< Datagrams read with one system call
+    static const int sendWindow = 2; ///< Minimum time between two sends, messages arriving meanwhile are collected, in milliseconds
+    static const int maxCoalescedSize = 1400; ///< Messages are combined into datagrams up to this size
+    static const int maxBacklog = 65536; ///< Bytes queued per peer before further messages are dropped
+    static const int sendBatchSize = 32; ///< Datagrams sent with one system call
 
     quint64 bitsSentTotal;
     quint64 bitsSentCurrent;
@@ -35,6 +35,9 @@ This file is part of the QGROUNDCONTROL project
 #include <string.h>
 #include <QSettings>
 
+// never used as a frame sequence number, so each getter converts the first frame
+static const quint32 noFrame = 0xFFFFFFFF;
+
 Freenect::Freenect()
     : context(NULL)
     , device(NULL)
@@ -42,8 +45,14 @@ Freenect::Freenect()
     , rgbData(new QByteArray)
     , rawDepthData(new QByteArray)
     , coloredDepthData(new QByteArray)
-    , pointCloud3D(new QVector<QVector3D>)
-    , pointCloud6D(new QVector<Vector6D>)
+    , pointCloud3D(new PointCloud(FREENECT_FRAME_PIX))
+    , pointCloud6D(new PointCloud(FREENECT_FRAME_PIX))
+    , rgbDataSequence(noFrame)
+    , rawDepthDataSequence(noFrame)
+    , coloredDepthDataSequence(noFrame)
+    , pointCloud3DSequence(noFrame)
+    , pointCloud6DSequence(noFrame)
+    , pointCloud6DRgbSequence(noFrame)
 {
 
 }
@@ -73,7 +82,9 @@ Freenect::init(int userDeviceNumber)
         gammaTable[i] = static_cast<unsigned short>(v * 6.0f * 256.0f);
     }
 
-    // populate depth projection matrix
+    // populate the rectified viewing rays of the depth camera
+    QVector<float> rayX(FREENECT_FRAME_PIX);
+    QVector<float> rayY(FREENECT_FRAME_PIX);
     for (int i = 0; i < FREENECT_FRAME_H; ++i) {
         for (int j = 0; j < FREENECT_FRAME_W; ++j) {
             QVector2D originalPoint(j, i);
@@ -83,13 +94,19 @@ Freenect::init(int userDeviceNumber)
             QVector3D rectifiedRay;
             projectPixelTo3DRay(rectifiedPoint, rectifiedRay, depthCameraParameters);
 
-            depthProjectionMatrix[i * FREENECT_FRAME_W + j] = rectifiedRay;
-
-            rectifyPoint(originalPoint, rectifiedPoint, rgbCameraParameters);
-            rgbRectificationMap[i * FREENECT_FRAME_W + j] = rectifiedPoint;
+            rayX[i * FREENECT_FRAME_W + j] = rectifiedRay.x();
+            rayY[i * FREENECT_FRAME_W + j] = rectifiedRay.y();
         }
     }
 
+    projector.setRays(rayX, rayY);
+    projector.setDisparityModel(baseline, depthCameraParameters.fx, disparityOffset);
+    projector.setColorCamera(transformMatrix,
+                             rgbCameraParameters.fx, rgbCameraParameters.fy,
+                             rgbCameraParameters.cx, rgbCameraParameters.cy,
+                             rgbCameraParameters.k,
+                             FREENECT_FRAME_W, FREENECT_FRAME_H);
+
     if (freenect_init(&context, NULL) < 0) {
         return false;
     }
@@ -106,9 +123,6 @@ Freenect::init(int userDeviceNumber)
 
     freenect_set_user(device, this);
 
-    memset(rgb, 0, FREENECT_VIDEO_RGB_SIZE);
-    memset(depth, 0, FREENECT_DEPTH_11BIT_SIZE);
-
     // set Kinect parameters
     if (freenect_set_tilt_degs(device, tiltAngle) != 0) {
         return false;
@@ -156,9 +170,12 @@ Freenect::process(void)
 QSharedPointer<QByteArray>
 Freenect::getRgbData(void)
 {
-    QMutexLocker locker(&rgbMutex);
-    rgbData->clear();
-    rgbData->append(rgb, FREENECT_VIDEO_RGB_SIZE);
+    const VideoFrame& frame = videoFrames.readSlot();
+    if (rgbDataSequence != videoFrames.readSequence()) {
+        rgbDataSequence = videoFrames.readSequence();
+        rgbData->clear();
+        rgbData->append(frame.rgb, FREENECT_VIDEO_RGB_SIZE);
+    }
 
     return rgbData;
 }
@@ -166,9 +183,12 @@ Freenect::getRgbData(void)
 QSharedPointer<QByteArray>
 Freenect::getRawDepthData(void)
 {
-    QMutexLocker locker(&depthMutex);
-    rawDepthData->clear();
-    rawDepthData->append(depth, FREENECT_DEPTH_11BIT_SIZE);
+    const DepthFrame& frame = depthFrames.readSlot();
+    if (rawDepthDataSequence != depthFrames.readSequence()) {
+        rawDepthDataSequence = depthFrames.readSequence();
+        rawDepthData->clear();
+        rawDepthData->append(frame.depth, FREENECT_DEPTH_11BIT_SIZE);
+    }
 
     return rawDepthData;
 }
@@ -176,78 +196,52 @@ Freenect::getRawDepthData(void)
 QSharedPointer<QByteArray>
 Freenect::getColoredDepthData(void)
 {
-    QMutexLocker locker(&coloredDepthMutex);
-    coloredDepthData->clear();
-    coloredDepthData->append(coloredDepth, FREENECT_VIDEO_RGB_SIZE);
+    const DepthFrame& frame = depthFrames.readSlot();
+    if (coloredDepthDataSequence != depthFrames.readSequence()) {
+        coloredDepthDataSequence = depthFrames.readSequence();
+        coloredDepthData->clear();
+        coloredDepthData->append(frame.coloredDepth, FREENECT_VIDEO_RGB_SIZE);
+    }
 
     return coloredDepthData;
 }
 
-QSharedPointer< QVector<QVector3D> >
+QSharedPointer<PointCloud>
 Freenect::get3DPointCloudData(void)
 {
-    QMutexLocker locker(&depthMutex);
-
-    pointCloud3D->clear();
-    unsigned short* data = reinterpret_cast<unsigned short*>(depth);
-    for (int i = 0; i < FREENECT_FRAME_PIX; ++i) {
-        if (data[i] > 0 && data[i] <= 2048) {
-            double range = baseline * depthCameraParameters.fx
-                           / (1.0 / 8.0 * (disparityOffset
-                                           - static_cast<double>(data[i])));
-
-            if (range > 0.0f) {
-                QVector3D ray = depthProjectionMatrix[i];
-                ray *= range;
-
-                pointCloud3D->push_back(QVector3D(ray.x(), ray.y(), ray.z()));
-            }
-        }
+    const DepthFrame& frame = depthFrames.readSlot();
+    if (pointCloud3DSequence != depthFrames.readSequence()) {
+        pointCloud3DSequence = depthFrames.readSequence();
+        projector.project(reinterpret_cast<const unsigned short*>(frame.depth),
+                          *pointCloud3D);
     }
 
     return pointCloud3D;
 }
 
-QSharedPointer< QVector<Freenect::Vector6D> >
+QSharedPointer<PointCloud>
 Freenect::get6DPointCloudData(void)
 {
-    get3DPointCloudData();
-
-    pointCloud6D->clear();
-    for (int i = 0; i < pointCloud3D->size(); ++i) {
-        Vector6D point;
-
-        point.x = pointCloud3D->at(i).x();
-        point.y = pointCloud3D->at(i).y();
-        point.z = pointCloud3D->at(i).z();
-
-        QVector4D transformedPoint = transformMatrix * QVector4D(point.x, point.y, point.z, 1.0);
-
-        float iz = 1.0 / transformedPoint.z();
-        QVector2D rectifiedPoint(transformedPoint.x() * iz * rgbCameraParameters.fx + rgbCameraParameters.cx,
-                                 transformedPoint.y() * iz * rgbCameraParameters.fy + rgbCameraParameters.cy);
-
-        QVector2D originalPoint;
-        unrectifyPoint(rectifiedPoint, originalPoint, rgbCameraParameters);
-
-        if (originalPoint.x() >= 0.0 && originalPoint.x() < FREENECT_FRAME_W &&
-                originalPoint.y() >= 0.0 && originalPoint.y() < FREENECT_FRAME_H) {
-            int x = static_cast<int>(originalPoint.x());
-            int y = static_cast<int>(originalPoint.y());
-            unsigned char* pixel = reinterpret_cast<unsigned char*>(rgb)
-                                   + (y * FREENECT_FRAME_W + x) * 3;
-
-            point.r = pixel[0];
-            point.g = pixel[1];
-            point.b = pixel[2];
-
-            pointCloud6D->push_back(point);
-        }
+    const DepthFrame& depthFrame = depthFrames.readSlot();
+    const VideoFrame& videoFrame = videoFrames.readSlot();
+    if (pointCloud6DSequence != depthFrames.readSequence() ||
+            pointCloud6DRgbSequence != videoFrames.readSequence()) {
+        pointCloud6DSequence = depthFrames.readSequence();
+        pointCloud6DRgbSequence = videoFrames.readSequence();
+        projector.projectColored(reinterpret_cast<const unsigned short*>(depthFrame.depth),
+                                 reinterpret_cast<const unsigned char*>(videoFrame.rgb),
+                                 *pointCloud6D);
     }
 
     return pointCloud6D;
 }
 
+quint32
+Freenect::getDepthSequence(void) const
+{
+    return depthFrames.readSequence();
+}
+
 int
 Freenect::getTiltAngle(void) const
 {
@@ -389,8 +383,8 @@ Freenect::videoCallback(freenect_device* device, void* video, uint32_t timestamp
 {
     Freenect* freenect = static_cast<Freenect *>(freenect_get_user(device));
 
-    QMutexLocker locker(&freenect->rgbMutex);
-    memcpy(freenect->rgb, video, FREENECT_VIDEO_RGB_SIZE);
+    memcpy(freenect->videoFrames.writeSlot().rgb, video, FREENECT_VIDEO_RGB_SIZE);
+    freenect->videoFrames.publish();
 }
 
 void
@@ -399,12 +393,11 @@ Freenect::depthCallback(freenect_device* device, void* depth, uint32_t timestamp
     Freenect* freenect = static_cast<Freenect *>(freenect_get_user(device));
     uint16_t* data = reinterpret_cast<uint16_t *>(depth);
 
-    QMutexLocker depthLocker(&freenect->depthMutex);
-    memcpy(freenect->depth, data, FREENECT_DEPTH_11BIT_SIZE);
+    DepthFrame& frame = freenect->depthFrames.writeSlot();
+    memcpy(frame.depth, data, FREENECT_DEPTH_11BIT_SIZE);
 
-    QMutexLocker coloredDepthLocker(&freenect->coloredDepthMutex);
     unsigned short* src = reinterpret_cast<unsigned short *>(data);
-    unsigned char* dst = reinterpret_cast<unsigned char *>(freenect->coloredDepth);
+    unsigned char* dst = reinterpret_cast<unsigned char *>(frame.coloredDepth);
     for (int i = 0; i < FREENECT_FRAME_PIX; ++i) {
         unsigned short pval = freenect->gammaTable[src[i]];
         unsigned short lb = pval & 0xFF;
@@ -446,4 +439,6 @@ Freenect::depthCallback(freenect_device* device, void* depth, uint32_t timestamp
             break;
         }
     }
+
+    freenect->depthFrames.publish();
 }
@@ -34,7 +34,6 @@ This file is part of the QGROUNDCONTROL project
 
 #include <libfreenect/libfreenect.h>
 #include <QMatrix4x4>
-#include <QMutex>
 #include <QScopedPointer>
 #include <QSharedPointer>
 #include <QThread>
@@ -42,6 +41,9 @@ This file is part of the QGROUNDCONTROL project
 #include <QVector2D>
 #include <QVector3D>
 
+#include "PointCloudProjector.h"
+#include "TripleBuffer.h"
+
 class Freenect
 {
 public:
@@ -54,17 +56,10 @@ public:
     QSharedPointer<QByteArray> getRgbData(void);
     QSharedPointer<QByteArray> getRawDepthData(void);
     QSharedPointer<QByteArray> getColoredDepthData(void);
-    QSharedPointer< QVector<QVector3D> > get3DPointCloudData(void);
-
-    typedef struct {
-        double x;
-        double y;
-        double z;
-        unsigned char r;
-        unsigned char g;
-        unsigned char b;
-    } Vector6D;
-    QSharedPointer< QVector<Vector6D> > get6DPointCloudData();
+    QSharedPointer<PointCloud> get3DPointCloudData(void);
+    QSharedPointer<PointCloud> get6DPointCloudData(void);
+    /** @brief Sequence number of the depth frame the getters last used, 0 before the first frame */
+    quint32 getDepthSequence(void) const;
 
     int getTiltAngle(void) const;
     void setTiltAngle(int angle);
@@ -123,15 +118,17 @@ private:
     // tilt angle of Kinect camera
     int tiltAngle;
 
-    // rgbd data
-    char rgb[FREENECT_VIDEO_RGB_SIZE];
-    QMutex rgbMutex;
-
-    char depth[FREENECT_DEPTH_11BIT_SIZE];
-    QMutex depthMutex;
+    // rgbd data, written by the libfreenect thread and read by the getters
+    typedef struct {
+        char rgb[FREENECT_VIDEO_RGB_SIZE];
+    } VideoFrame;
+    TripleBuffer<VideoFrame> videoFrames;
 
-    char coloredDepth[FREENECT_VIDEO_RGB_SIZE];
-    QMutex coloredDepthMutex;
+    typedef struct {
+        char depth[FREENECT_DEPTH_11BIT_SIZE];
+        char coloredDepth[FREENECT_VIDEO_RGB_SIZE];
+    } DepthFrame;
+    TripleBuffer<DepthFrame> depthFrames;
 
     // accelerometer data
     double ax, ay, az;
@@ -140,15 +137,24 @@ private:
     // gamma map
     unsigned short gammaTable[2048];
 
-    QVector3D depthProjectionMatrix[FREENECT_FRAME_PIX];
-    QVector2D rgbRectificationMap[FREENECT_FRAME_PIX];
+    // depth image to point cloud conversion
+    PointCloudProjector projector;
 
     // variables for use outside class
     QSharedPointer<QByteArray> rgbData;
     QSharedPointer<QByteArray> rawDepthData;
     QSharedPointer<QByteArray> coloredDepthData;
-    QSharedPointer< QVector<QVector3D> > pointCloud3D;
-    QSharedPointer< QVector<Vector6D> > pointCloud6D;
+    QSharedPointer<PointCloud> pointCloud3D;
+    QSharedPointer<PointCloud> pointCloud6D;
+
+    // sequence numbers of the frames the data above was made from, the
+    // getters only convert again when there is a newer frame
+    quint32 rgbDataSequence;
+    quint32 rawDepthDataSequence;
+    quint32 coloredDepthDataSequence;
+    quint32 pointCloud3DSequence;
+    quint32 pointCloud6DSequence;
+    quint32 pointCloud6DRgbSequence;
 };
 
 #endif // FREENECT_H
@@ -0,0 +1,183 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the class OccupancyMap.
+ *
+ */
+
+#include "OccupancyMap.h"
+
+#include <cmath>
+#include <QMap>
+
+#include "VoxelGrid.h"
+
+OccupancyMap::OccupancyMap(float _resolution, int _capacity)
+    : resolution(_resolution)
+    , capacity(_capacity)
+    , updateCount(0)
+{
+
+}
+
+void
+OccupancyMap::setResolution(float _resolution)
+{
+    resolution = _resolution;
+    clear();
+}
+
+float
+OccupancyMap::getResolution(void) const
+{
+    return resolution;
+}
+
+void
+OccupancyMap::setCapacity(int _capacity)
+{
+    capacity = _capacity;
+    if (cells.size() > capacity) {
+        evict(capacity);
+    }
+}
+
+int
+OccupancyMap::getCapacity(void) const
+{
+    return capacity;
+}
+
+void
+OccupancyMap::clear(void)
+{
+    cells.clear();
+    updateCount = 0;
+}
+
+int
+OccupancyMap::size(void) const
+{
+    return cells.size();
+}
+
+void
+OccupancyMap::insert(const PointCloud& cloud, const QMatrix4x4& pose)
+{
+    ++updateCount;
+
+    float m[12];
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 4; ++col) {
+            m[row * 4 + col] = static_cast<float>(pose(row, col)) / resolution;
+        }
+    }
+
+    for (int i = 0; i < cloud.size; ++i) {
+        float x = cloud.x[i];
+        float y = cloud.y[i];
+        float z = cloud.z[i];
+
+        quint64 k = VoxelGrid::key(0,
+                                   static_cast<int>(floorf(m[0] * x + m[1] * y + m[2] * z + m[3])),
+                                   static_cast<int>(floorf(m[4] * x + m[5] * y + m[6] * z + m[7])),
+                                   static_cast<int>(floorf(m[8] * x + m[9] * y + m[10] * z + m[11])));
+
+        // a voxel counts once per cloud, however many points fall into it
+        Cell& cell = cells[k];
+        if (cell.lastUpdate == updateCount) {
+            continue;
+        }
+        cell.lastUpdate = updateCount;
+
+        // new observations keep some weight once a voxel has been seen often
+        int weight = qMin(static_cast<int>(cell.hits), 15);
+        cell.r = (cell.r * weight + cloud.r[i]) / (weight + 1);
+        cell.g = (cell.g * weight + cloud.g[i]) / (weight + 1);
+        cell.b = (cell.b * weight + cloud.b[i]) / (weight + 1);
+        if (cell.hits < 0xFFFF) {
+            ++cell.hits;
+        }
+    }
+
+    if (cells.size() > capacity) {
+        // evict a bit more than needed so this does not happen every frame
+        evict(capacity - capacity / 10);
+    }
+}
+
+int
+OccupancyMap::extract(PointCloud& out, int minHits) const
+{
+    out.reserve(cells.size());
+
+    int count = 0;
+    QHash<quint64, Cell>::const_iterator it = cells.constBegin();
+    for (; it != cells.constEnd(); ++it) {
+        const Cell& cell = it.value();
+        if (cell.hits < minHits) {
+            continue;
+        }
+
+        out.x[count] = (VoxelGrid::index(it.key(), 0) + 0.5f) * resolution;
+        out.y[count] = (VoxelGrid::index(it.key(), 1) + 0.5f) * resolution;
+        out.z[count] = (VoxelGrid::index(it.key(), 2) + 0.5f) * resolution;
+        out.r[count] = cell.r;
+        out.g[count] = cell.g;
+        out.b[count] = cell.b;
+        ++count;
+    }
+    out.size = count;
+
+    return count;
+}
+
+void
+OccupancyMap::evict(int target)
+{
+    // count the voxels per update, oldest first
+    QMap<quint32, int> ages;
+    QHash<quint64, Cell>::const_iterator it = cells.constBegin();
+    for (; it != cells.constEnd(); ++it) {
+        ++ages[it.value().lastUpdate];
+    }
+
+    int excess = cells.size() - target;
+    quint32 cutoff = 0;
+    QMap<quint32, int>::const_iterator age = ages.constBegin();
+    for (; age != ages.constEnd() && excess > 0; ++age) {
+        cutoff = age.key();
+        excess -= age.value();
+    }
+
+    QHash<quint64, Cell>::iterator cell = cells.begin();
+    while (cell != cells.end()) {
+        if (cell.value().lastUpdate <= cutoff) {
+            cell = cells.erase(cell);
+        } else {
+            ++cell;
+        }
+    }
+}
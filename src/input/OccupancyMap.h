@@ -0,0 +1,92 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the class OccupancyMap.
+ *
+ */
+
+#ifndef OCCUPANCYMAP_H
+#define OCCUPANCYMAP_H
+
+#include <QHash>
+#include <QMatrix4x4>
+
+#include "PointCloudProjector.h"
+
+/**
+ * @brief Accumulates point clouds into a world frame voxel map.
+ *
+ * Each voxel counts the number of clouds it was observed in and keeps a
+ * running mean of its color. The number of voxels is bounded: once the
+ * capacity is exceeded, the voxels that were not observed for the longest
+ * time are dropped.
+ */
+class OccupancyMap
+{
+public:
+    explicit OccupancyMap(float resolution = 0.1f, int capacity = 500000);
+
+    /** @brief Set the edge length of a voxel, clears the map */
+    void setResolution(float resolution);
+    float getResolution(void) const;
+    /** @brief Set the maximum number of voxels */
+    void setCapacity(int capacity);
+    int getCapacity(void) const;
+
+    void clear(void);
+    int size(void) const;
+
+    /** @brief Add a point cloud, pose transforms its points into the map frame */
+    void insert(const PointCloud& cloud, const QMatrix4x4& pose);
+    /**
+     * @brief Get the centers and colors of the voxels observed at least
+     * minHits times
+     * @return the number of points in out
+     */
+    int extract(PointCloud& out, int minHits = 2) const;
+
+private:
+    /** @brief Drop the least recently observed voxels until size() <= target */
+    void evict(int target);
+
+    class Cell
+    {
+    public:
+        Cell() : hits(0), r(0), g(0), b(0), lastUpdate(0) {}
+
+        unsigned short hits;
+        unsigned char r;
+        unsigned char g;
+        unsigned char b;
+        quint32 lastUpdate;
+    };
+
+    QHash<quint64, Cell> cells;
+    float resolution;
+    int capacity;
+    quint32 updateCount;
+};
+
+#endif // OCCUPANCYMAP_H
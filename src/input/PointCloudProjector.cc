@@ -0,0 +1,334 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the class PointCloudProjector.
+ *
+ */
+
+#include "PointCloudProjector.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+PointCloud::PointCloud(int capacity)
+    : size(0)
+{
+    reserve(capacity);
+}
+
+void
+PointCloud::reserve(int capacity)
+{
+    if (x.size() >= capacity) {
+        return;
+    }
+
+    x.resize(capacity);
+    y.resize(capacity);
+    z.resize(capacity);
+    r.resize(capacity);
+    g.resize(capacity);
+    b.resize(capacity);
+}
+
+PointCloudProjector::PointCloudProjector()
+    : colorFx(1.0f)
+    , colorFy(1.0f)
+    , colorCx(0.0f)
+    , colorCy(0.0f)
+    , colorWidth(0)
+    , colorHeight(0)
+{
+    for (int i = 0; i < rangeTableSize; ++i) {
+        rangeTable[i] = 0.0f;
+    }
+    for (int i = 0; i < 12; ++i) {
+        transform[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+    }
+    for (int i = 0; i < 5; ++i) {
+        colorK[i] = 0.0f;
+    }
+}
+
+void
+PointCloudProjector::setDisparityModel(double baseline, double focalLength,
+                                       double disparityOffset)
+{
+    // a raw value of 0 means there is no measurement
+    rangeTable[0] = 0.0f;
+    for (int i = 1; i < rangeTableSize; ++i) {
+        double disparity = 1.0 / 8.0 * (disparityOffset - static_cast<double>(i));
+        double range = 0.0;
+        if (disparity != 0.0) {
+            range = baseline * focalLength / disparity;
+        }
+
+        rangeTable[i] = (range > 0.0) ? static_cast<float>(range) : 0.0f;
+    }
+}
+
+void
+PointCloudProjector::setRays(const QVector<float>& _rayX, const QVector<float>& _rayY)
+{
+    rayX = _rayX;
+    rayY = _rayY;
+}
+
+void
+PointCloudProjector::setColorCamera(const QMatrix4x4& depthToColor,
+                                    double fx, double fy, double cx, double cy,
+                                    const double k[5], int width, int height)
+{
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 4; ++col) {
+            transform[row * 4 + col] = static_cast<float>(depthToColor(row, col));
+        }
+    }
+
+    colorFx = fx;
+    colorFy = fy;
+    colorCx = cx;
+    colorCy = cy;
+    for (int i = 0; i < 5; ++i) {
+        colorK[i] = k[i];
+    }
+    colorWidth = width;
+    colorHeight = height;
+}
+
+int
+PointCloudProjector::project(const unsigned short* depth, PointCloud& cloud) const
+{
+    const int n = rayX.size();
+    cloud.reserve(n);
+
+    const float* rx = rayX.constData();
+    const float* ry = rayY.constData();
+    float* px = cloud.x.data();
+    float* py = cloud.y.data();
+    float* pz = cloud.z.data();
+
+    // every point is written to the next free slot, but the slot is only
+    // taken if the point is valid, so no branch depends on the data
+    int count = 0;
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m128 r = _mm_set_ps(range(depth[i + 3]), range(depth[i + 2]),
+                              range(depth[i + 1]), range(depth[i]));
+        int valid = _mm_movemask_ps(_mm_cmpgt_ps(r, zero));
+        if (valid == 0) {
+            continue;
+        }
+
+        float x[4], y[4], z[4];
+        _mm_storeu_ps(x, _mm_mul_ps(_mm_loadu_ps(rx + i), r));
+        _mm_storeu_ps(y, _mm_mul_ps(_mm_loadu_ps(ry + i), r));
+        _mm_storeu_ps(z, r);
+
+        for (int j = 0; j < 4; ++j) {
+            px[count] = x[j];
+            py[count] = y[j];
+            pz[count] = z[j];
+            count += (valid >> j) & 1;
+        }
+    }
+#endif
+
+    for (; i < n; ++i) {
+        float r = range(depth[i]);
+
+        px[count] = rx[i] * r;
+        py[count] = ry[i] * r;
+        pz[count] = r;
+        count += (r > 0.0f) ? 1 : 0;
+    }
+
+    cloud.size = count;
+    return count;
+}
+
+int
+PointCloudProjector::projectColored(const unsigned short* depth,
+                                    const unsigned char* rgb,
+                                    PointCloud& cloud) const
+{
+    const int n = rayX.size();
+    cloud.reserve(n);
+
+    const float* rx = rayX.constData();
+    const float* ry = rayY.constData();
+    float* px = cloud.x.data();
+    float* py = cloud.y.data();
+    float* pz = cloud.z.data();
+    unsigned char* pr = cloud.r.data();
+    unsigned char* pg = cloud.g.data();
+    unsigned char* pb = cloud.b.data();
+
+    const float* m = transform;
+    const float* k = colorK;
+
+    int count = 0;
+    int i = 0;
+
+#ifdef __SSE2__
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 two = _mm_set1_ps(2.0f);
+    const __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]);
+    const __m128 m2 = _mm_set1_ps(m[2]), m3 = _mm_set1_ps(m[3]);
+    const __m128 m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]);
+    const __m128 m6 = _mm_set1_ps(m[6]), m7 = _mm_set1_ps(m[7]);
+    const __m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]);
+    const __m128 m10 = _mm_set1_ps(m[10]), m11 = _mm_set1_ps(m[11]);
+    const __m128 k0 = _mm_set1_ps(k[0]), k1 = _mm_set1_ps(k[1]);
+    const __m128 k2 = _mm_set1_ps(k[2]), k3 = _mm_set1_ps(k[3]);
+    const __m128 k4 = _mm_set1_ps(k[4]);
+    const __m128 fx = _mm_set1_ps(colorFx), fy = _mm_set1_ps(colorFy);
+    const __m128 cx = _mm_set1_ps(colorCx), cy = _mm_set1_ps(colorCy);
+    const __m128 width = _mm_set1_ps(static_cast<float>(colorWidth));
+    const __m128 height = _mm_set1_ps(static_cast<float>(colorHeight));
+
+    for (; i + 4 <= n; i += 4) {
+        __m128 r = _mm_set_ps(range(depth[i + 3]), range(depth[i + 2]),
+                              range(depth[i + 1]), range(depth[i]));
+        __m128 valid = _mm_cmpgt_ps(r, zero);
+        if (_mm_movemask_ps(valid) == 0) {
+            continue;
+        }
+
+        __m128 x = _mm_mul_ps(_mm_loadu_ps(rx + i), r);
+        __m128 y = _mm_mul_ps(_mm_loadu_ps(ry + i), r);
+        __m128 z = r;
+
+        // transform into the color camera and project
+        __m128 tx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m1, y)),
+                               _mm_add_ps(_mm_mul_ps(m2, z), m3));
+        __m128 ty = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m4, x), _mm_mul_ps(m5, y)),
+                               _mm_add_ps(_mm_mul_ps(m6, z), m7));
+        __m128 tz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m8, x), _mm_mul_ps(m9, y)),
+                               _mm_add_ps(_mm_mul_ps(m10, z), m11));
+        valid = _mm_and_ps(valid, _mm_cmpgt_ps(tz, zero));
+
+        __m128 iz = _mm_div_ps(one, tz);
+        __m128 xn = _mm_mul_ps(tx, iz);
+        __m128 yn = _mm_mul_ps(ty, iz);
+
+        // apply the lens distortion of the color camera
+        __m128 xx = _mm_mul_ps(xn, xn);
+        __m128 yy = _mm_mul_ps(yn, yn);
+        __m128 xy = _mm_mul_ps(xn, yn);
+        __m128 r2 = _mm_add_ps(xx, yy);
+        __m128 dx = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(two, k2), xy),
+                               _mm_mul_ps(k3, _mm_add_ps(r2, _mm_mul_ps(two, xx))));
+        __m128 dy = _mm_add_ps(_mm_mul_ps(k2, _mm_add_ps(r2, _mm_mul_ps(two, yy))),
+                               _mm_mul_ps(_mm_mul_ps(two, k3), xy));
+        __m128 cdist = _mm_add_ps(one, _mm_mul_ps(r2,
+                                  _mm_add_ps(k0, _mm_mul_ps(r2,
+                                             _mm_add_ps(k1, _mm_mul_ps(r2, k4))))));
+        __m128 u = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(xn, cdist), dx), fx), cx);
+        __m128 v = _mm_add_ps(_mm_mul_ps(_mm_add_ps(_mm_mul_ps(yn, cdist), dy), fy), cy);
+
+        // comparisons with NaN are false, so degenerate points drop out here
+        valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(u, zero), _mm_cmplt_ps(u, width)));
+        valid = _mm_and_ps(valid, _mm_and_ps(_mm_cmpge_ps(v, zero), _mm_cmplt_ps(v, height)));
+        int mask = _mm_movemask_ps(valid);
+        if (mask == 0) {
+            continue;
+        }
+
+        // invalid lanes sample pixel (0, 0) instead of reading out of bounds
+        int ui[4], vi[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(ui), _mm_cvttps_epi32(_mm_and_ps(u, valid)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(vi), _mm_cvttps_epi32(_mm_and_ps(v, valid)));
+
+        float xs[4], ys[4], zs[4];
+        _mm_storeu_ps(xs, x);
+        _mm_storeu_ps(ys, y);
+        _mm_storeu_ps(zs, z);
+
+        for (int j = 0; j < 4; ++j) {
+            const unsigned char* pixel = rgb + (vi[j] * colorWidth + ui[j]) * 3;
+
+            px[count] = xs[j];
+            py[count] = ys[j];
+            pz[count] = zs[j];
+            pr[count] = pixel[0];
+            pg[count] = pixel[1];
+            pb[count] = pixel[2];
+            count += (mask >> j) & 1;
+        }
+    }
+#endif
+
+    for (; i < n; ++i) {
+        float r = range(depth[i]);
+        if (r <= 0.0f) {
+            continue;
+        }
+
+        float x = rx[i] * r;
+        float y = ry[i] * r;
+        float z = r;
+
+        float tx = m[0] * x + m[1] * y + m[2] * z + m[3];
+        float ty = m[4] * x + m[5] * y + m[6] * z + m[7];
+        float tz = m[8] * x + m[9] * y + m[10] * z + m[11];
+        if (!(tz > 0.0f)) {
+            continue;
+        }
+
+        float iz = 1.0f / tz;
+        float xn = tx * iz;
+        float yn = ty * iz;
+
+        float r2 = xn * xn + yn * yn;
+        float dx = 2.0f * k[2] * xn * yn + k[3] * (r2 + 2.0f * xn * xn);
+        float dy = k[2] * (r2 + 2.0f * yn * yn) + 2.0f * k[3] * xn * yn;
+        float cdist = 1.0f + r2 * (k[0] + r2 * (k[1] + r2 * k[4]));
+        float u = (xn * cdist + dx) * colorFx + colorCx;
+        float v = (yn * cdist + dy) * colorFy + colorCy;
+
+        if (u >= 0.0f && u < colorWidth && v >= 0.0f && v < colorHeight) {
+            const unsigned char* pixel = rgb
+                                         + (static_cast<int>(v) * colorWidth
+                                            + static_cast<int>(u)) * 3;
+
+            px[count] = x;
+            py[count] = y;
+            pz[count] = z;
+            pr[count] = pixel[0];
+            pg[count] = pixel[1];
+            pb[count] = pixel[2];
+            ++count;
+        }
+    }
+
+    cloud.size = count;
+    return count;
+}
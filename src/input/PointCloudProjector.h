@@ -0,0 +1,115 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the class PointCloudProjector.
+ *
+ */
+
+#ifndef POINTCLOUDPROJECTOR_H
+#define POINTCLOUDPROJECTOR_H
+
+#include <QMatrix4x4>
+#include <QVector>
+
+/**
+ * @brief Point cloud in structure of arrays layout.
+ *
+ * The buffers are allocated once for a full frame and reused for every
+ * frame, only the first size entries are valid.
+ */
+class PointCloud
+{
+public:
+    explicit PointCloud(int capacity = 0);
+
+    void reserve(int capacity);
+
+    int size;
+    QVector<float> x;
+    QVector<float> y;
+    QVector<float> z;
+    QVector<unsigned char> r;
+    QVector<unsigned char> g;
+    QVector<unsigned char> b;
+};
+
+/**
+ * @brief Converts raw Kinect disparity images to point clouds.
+ *
+ * The range of all 2048 raw disparity values is precomputed, as is the
+ * rectified viewing ray of every depth pixel. The kernels process four
+ * pixels at a time with SSE2 where available and write the valid points
+ * into a reused PointCloud without allocating.
+ */
+class PointCloudProjector
+{
+public:
+    PointCloudProjector();
+
+    /** @brief Set the disparity model of the depth camera, fills the range table */
+    void setDisparityModel(double baseline, double focalLength, double disparityOffset);
+    /** @brief Set the rectified viewing ray (x, y, 1) of every depth pixel */
+    void setRays(const QVector<float>& rayX, const QVector<float>& rayY);
+    /** @brief Set the pose and intrinsics of the color camera used for coloring */
+    void setColorCamera(const QMatrix4x4& depthToColor,
+                        double fx, double fy, double cx, double cy,
+                        const double k[5], int width, int height);
+
+    /** @brief Range in meters of a raw disparity value, 0 if there is none */
+    float range(unsigned short disparity) const {
+        return rangeTable[disparity < rangeTableSize ? disparity : 0];
+    }
+
+    int pixelCount(void) const {
+        return rayX.size();
+    }
+
+    /** @brief Convert a depth image to 3D points, returns the number of points */
+    int project(const unsigned short* depth, PointCloud& cloud) const;
+    /**
+     * @brief Convert a depth image to 3D points colored from an RGB image
+     *
+     * Points that do not project into the color image are dropped.
+     * @return the number of points
+     */
+    int projectColored(const unsigned short* depth, const unsigned char* rgb,
+                       PointCloud& cloud) const;
+
+    static const int rangeTableSize = 2048;
+
+private:
+    float rangeTable[rangeTableSize];
+    QVector<float> rayX;
+    QVector<float> rayY;
+
+    // depth to color camera transform, row major 3x4
+    float transform[12];
+    float colorFx, colorFy, colorCx, colorCy;
+    float colorK[5];
+    int colorWidth;
+    int colorHeight;
+};
+
+#endif // POINTCLOUDPROJECTOR_H
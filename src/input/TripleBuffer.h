@@ -0,0 +1,109 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the class TripleBuffer.
+ *
+ */
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <QAtomicInt>
+
+/**
+ * @brief Lock-free triple buffer for one producer and one consumer thread.
+ *
+ * The producer fills the write slot and publishes it, which swaps it with
+ * the middle slot. The consumer swaps its read slot with the middle slot
+ * whenever a new frame was published. Neither side ever waits for the
+ * other: the producer overwrites frames the consumer did not pick up, and
+ * the consumer always gets the newest complete frame.
+ *
+ * Every published frame gets a sequence number, starting at 1. The slots
+ * are zero initialized and have sequence number 0 until the first frame is
+ * published.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer()
+        : buffers()
+        , back(0)
+        , front(1)
+        , middle(2)
+        , published(0)
+    {
+        for (int i = 0; i < 3; ++i) {
+            sequences[i] = 0;
+        }
+    }
+
+    /** @brief Slot the producer fills with the next frame */
+    T& writeSlot(void) {
+        return buffers[back];
+    }
+
+    /** @brief Make the write slot the newest frame, called by the producer */
+    void publish(void) {
+        sequences[back] = ++published;
+        back = middle.fetchAndStoreOrdered(back | newFrame) & indexMask;
+    }
+
+    /**
+     * @brief Newest complete frame, called by the consumer
+     *
+     * The frame stays valid until the next call.
+     */
+    const T& readSlot(void) {
+        if (static_cast<int>(middle) & newFrame) {
+            front = middle.fetchAndStoreOrdered(front) & indexMask;
+        }
+        return buffers[front];
+    }
+
+    /** @brief Sequence number of the frame last returned by readSlot() */
+    quint32 readSequence(void) const {
+        return sequences[front];
+    }
+
+private:
+    enum {
+        indexMask = 0x3,
+        newFrame = 0x4
+    };
+
+    T buffers[3];
+    quint32 sequences[3];
+
+    int back;           ///< Owned by the producer
+    int front;          ///< Owned by the consumer
+    QAtomicInt middle;  ///< Index of the middle slot, newFrame if it was not read yet
+    quint32 published;  ///< Owned by the producer
+
+    Q_DISABLE_COPY(TripleBuffer)
+};
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,167 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the class VoxelGrid.
+ *
+ */
+
+#include "VoxelGrid.h"
+
+#include <cmath>
+
+VoxelGrid::VoxelGrid(float _voxelSize, float _lodDistance)
+    : voxelSize(_voxelSize)
+    , lodDistance(_lodDistance)
+    , stamp(0)
+{
+
+}
+
+void
+VoxelGrid::setVoxelSize(float size)
+{
+    voxelSize = size;
+}
+
+float
+VoxelGrid::getVoxelSize(void) const
+{
+    return voxelSize;
+}
+
+void
+VoxelGrid::setLodDistance(float distance)
+{
+    lodDistance = distance;
+}
+
+float
+VoxelGrid::getLodDistance(void) const
+{
+    return lodDistance;
+}
+
+int
+VoxelGrid::downsample(const PointCloud& in, PointCloud& out)
+{
+    // keep the table at most half full
+    int tableSize = 1024;
+    while (tableSize < in.size * 2) {
+        tableSize <<= 1;
+    }
+    if (slotKeys.size() < tableSize) {
+        slotKeys.resize(tableSize);
+        slotCells.resize(tableSize);
+        slotStamps.fill(0, tableSize);
+        stamp = 0;
+    }
+    ++stamp;
+    if (stamp == 0) {
+        slotStamps.fill(0);
+        stamp = 1;
+    }
+    if (cells.size() < in.size) {
+        cells.resize(in.size);
+    }
+
+    const unsigned int mask = slotKeys.size() - 1;
+    quint64* keys = slotKeys.data();
+    int* slotCell = slotCells.data();
+    quint32* stamps = slotStamps.data();
+    Cell* cell = cells.data();
+
+    float scale[maxLevel + 1];
+    for (int level = 0; level <= maxLevel; ++level) {
+        scale[level] = 1.0f / (voxelSize * static_cast<float>(1 << level));
+    }
+    const float lodDistance2 = lodDistance * lodDistance;
+
+    const float* x = in.x.constData();
+    const float* y = in.y.constData();
+    const float* z = in.z.constData();
+    const unsigned char* r = in.r.constData();
+    const unsigned char* g = in.g.constData();
+    const unsigned char* b = in.b.constData();
+
+    int used = 0;
+    for (int i = 0; i < in.size; ++i) {
+        float distance2 = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+        int level = 0;
+        for (float limit = lodDistance2; level < maxLevel && distance2 > limit;
+                limit *= 4.0f) {
+            ++level;
+        }
+
+        const float s = scale[level];
+        quint64 k = key(level,
+                        static_cast<int>(floorf(x[i] * s)),
+                        static_cast<int>(floorf(y[i] * s)),
+                        static_cast<int>(floorf(z[i] * s)));
+
+        unsigned int slot = static_cast<unsigned int>(
+                                (k * Q_UINT64_C(0x9E3779B97F4A7C15)) >> 32) & mask;
+        while (stamps[slot] == stamp && keys[slot] != k) {
+            slot = (slot + 1) & mask;
+        }
+
+        Cell* c;
+        if (stamps[slot] != stamp) {
+            stamps[slot] = stamp;
+            keys[slot] = k;
+            slotCell[slot] = used;
+
+            c = &cell[used++];
+            c->x = c->y = c->z = 0.0f;
+            c->r = c->g = c->b = 0;
+            c->count = 0;
+        } else {
+            c = &cell[slotCell[slot]];
+        }
+
+        c->x += x[i];
+        c->y += y[i];
+        c->z += z[i];
+        c->r += r[i];
+        c->g += g[i];
+        c->b += b[i];
+        ++c->count;
+    }
+
+    out.reserve(used);
+    for (int i = 0; i < used; ++i) {
+        const Cell& c = cell[i];
+        float w = 1.0f / static_cast<float>(c.count);
+
+        out.x[i] = c.x * w;
+        out.y[i] = c.y * w;
+        out.z[i] = c.z * w;
+        out.r[i] = c.r / c.count;
+        out.g[i] = c.g / c.count;
+        out.b[i] = c.b / c.count;
+    }
+    out.size = used;
+
+    return used;
+}
@@ -0,0 +1,104 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the class VoxelGrid.
+ *
+ */
+
+#ifndef VOXELGRID_H
+#define VOXELGRID_H
+
+#include <QVector>
+
+#include "PointCloudProjector.h"
+
+/**
+ * @brief Voxel grid filter for point clouds.
+ *
+ * All points that fall into the same voxel are replaced by their centroid
+ * and mean color. The voxels grow with the distance from the sensor: up to
+ * the level of detail distance the base voxel size is used, beyond it the
+ * voxel size doubles each time the distance doubles.
+ *
+ * The occupied voxels are found in an open addressing hash table which is
+ * kept across calls, so filtering a frame does not allocate.
+ */
+class VoxelGrid
+{
+public:
+    explicit VoxelGrid(float voxelSize = 0.05f, float lodDistance = 2.0f);
+
+    void setVoxelSize(float size);
+    float getVoxelSize(void) const;
+    void setLodDistance(float distance);
+    float getLodDistance(void) const;
+
+    /**
+     * @brief Downsample a point cloud, in and out must not be the same cloud
+     * @return the number of points in out
+     */
+    int downsample(const PointCloud& in, PointCloud& out);
+
+    /** @brief Hash key of a voxel, the indices are wrapped to 20 bits */
+    static quint64 key(int level, int ix, int iy, int iz) {
+        return (static_cast<quint64>(level & 0x7) << 60)
+               | (static_cast<quint64>(ix & 0xFFFFF) << 40)
+               | (static_cast<quint64>(iy & 0xFFFFF) << 20)
+               | static_cast<quint64>(iz & 0xFFFFF);
+    }
+    /** @brief Voxel index along one axis of a key, sign extended */
+    static int index(quint64 key, int axis) {
+        int i = static_cast<int>((key >> (40 - axis * 20)) & 0xFFFFF);
+        return (i & 0x80000) ? i - 0x100000 : i;
+    }
+
+    /** @brief Coarsest level of detail, the voxel size is doubled per level */
+    static const int maxLevel = 4;
+
+private:
+    typedef struct {
+        float x;
+        float y;
+        float z;
+        int r;
+        int g;
+        int b;
+        int count;
+    } Cell;
+
+    float voxelSize;
+    float lodDistance;
+
+    // hash table from voxel key to cell, a slot is in use if its stamp
+    // equals the current one
+    QVector<quint64> slotKeys;
+    QVector<int> slotCells;
+    QVector<quint32> slotStamps;
+    quint32 stamp;
+
+    QVector<Cell> cells;
+};
+
+#endif // VOXELGRID_H
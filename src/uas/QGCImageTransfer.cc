@@ -0,0 +1,162 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the reassembler for chunked image transfers
+ *
+ */
+
+#include <cstring>
+#include <QtConcurrentRun>
+#include <QDebug>
+
+#include "QGCImageTransfer.h"
+#include "QGC.h"
+
+QGCImageTransfer::QGCImageTransfer(QObject* parent) :
+    QObject(parent),
+    receivedCount(0),
+    payload(0),
+    active(false),
+    startTime(0),
+    retransmissions(0),
+    retransmissionPending(false),
+    duplicates(0),
+    decodeQueued(false)
+{
+    connect(&decoder, SIGNAL(finished()), this, SLOT(decodeFinished()));
+}
+
+QGCImageTransfer::~QGCImageTransfer()
+{
+    decoder.waitForFinished();
+}
+
+bool QGCImageTransfer::start(int size, int packets, int payload)
+{
+    startTime = QGC::groundTimeMilliseconds();
+    bool answer = retransmissionPending;
+    retransmissionPending = false;
+
+    if (size <= 0 || packets <= 0 || payload <= 0) {
+        reset();
+        return false;
+    }
+
+    // Even the answer to our own request is a new capture, chunks of the
+    // previous one would corrupt it. Reuse the buffer memory between images.
+    buffer.resize(size);
+    memset(buffer.data(), 0, size);
+    chunks.fill(false, packets);
+    receivedCount = 0;
+    this->payload = payload;
+    if (!answer) retransmissions = 0;
+    active = true;
+    return answer;
+}
+
+void QGCImageTransfer::requestRetransmission()
+{
+    startTime = QGC::groundTimeMilliseconds();
+    retransmissions++;
+    retransmissionPending = true;
+}
+
+bool QGCImageTransfer::addChunk(int seqnr, const unsigned char* data, int length)
+{
+    if (!active || seqnr < 0 || seqnr >= chunks.size()) return false;
+
+    if (chunks.testBit(seqnr)) {
+        duplicates++;
+        return false;
+    }
+
+    // The last chunk is only partially filled
+    int pos = seqnr * payload;
+    int bytes = qMin(qMin(length, payload), buffer.size() - pos);
+    if (bytes > 0) {
+        memcpy(buffer.data() + pos, data, bytes);
+    }
+
+    chunks.setBit(seqnr);
+    receivedCount++;
+    return isComplete();
+}
+
+QList<int> QGCImageTransfer::missingChunks() const
+{
+    QList<int> missing;
+    if (!active) return missing;
+    for (int i = 0; i < chunks.size(); ++i) {
+        if (!chunks.testBit(i)) missing.append(i);
+    }
+    return missing;
+}
+
+void QGCImageTransfer::decode()
+{
+    if (!active) return;
+
+    if (decoder.isRunning()) {
+        // Only the newest image is decoded next, older ones are outdated
+        queued = buffer;
+        decodeQueued = true;
+    } else {
+        // The copy is shared with the decoder thread until the next image arrives
+        decoder.setFuture(QtConcurrent::run(&QGCImageTransfer::decodeImage, QByteArray(buffer)));
+    }
+    active = false;
+}
+
+void QGCImageTransfer::reset()
+{
+    active = false;
+    receivedCount = 0;
+    chunks.clear();
+    retransmissions = 0;
+    retransmissionPending = false;
+}
+
+QImage QGCImageTransfer::decodeImage(const QByteArray& data)
+{
+    QImage image;
+    image.loadFromData(data);
+    return image;
+}
+
+void QGCImageTransfer::decodeFinished()
+{
+    QImage image = decoder.result();
+    if (image.isNull()) {
+        qDebug() << __FILE__ << __LINE__ << "Could not decode received image";
+    }
+
+    if (decodeQueued) {
+        decodeQueued = false;
+        decoder.setFuture(QtConcurrent::run(&QGCImageTransfer::decodeImage, queued));
+        queued.clear();
+    }
+
+    emit imageDecoded(image);
+}
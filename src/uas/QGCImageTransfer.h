@@ -0,0 +1,139 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the reassembler for chunked image transfers
+ *
+ */
+
+#ifndef QGCIMAGETRANSFER_H
+#define QGCIMAGETRANSFER_H
+
+#include <QObject>
+#include <QBitArray>
+#include <QByteArray>
+#include <QImage>
+#include <QList>
+#include <QFutureWatcher>
+
+/**
+ * @brief Reassembles an image sent as a sequence of ENCAPSULATED_DATA chunks
+ *
+ * Chunks may arrive in any order and more than once. Every chunk is copied
+ * as a whole to its final position and marked in a bitmap, so completion is
+ * detected from the set of received sequence numbers rather than from a
+ * packet count. Every handshake starts a new image: the vehicle answers a
+ * request with a new capture, and the handshake carries no image id to tell
+ * it from the one already buffered.
+ *
+ * Decoding the JPEG data runs in the global thread pool. The decoded image
+ * is delivered through the imageDecoded() signal in the thread owning this
+ * object.
+ */
+class QGCImageTransfer : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QGCImageTransfer(QObject* parent = 0);
+    ~QGCImageTransfer();
+
+    /**
+     * @brief Start receiving an image
+     *
+     * @param size total image size in bytes
+     * @param packets number of chunks the image is split into
+     * @param payload bytes per chunk
+     * @return true if this answers requestRetransmission(), the request count is kept then
+     */
+    bool start(int size, int packets, int payload);
+    /**
+     * @brief Note that the current image is requested again
+     *
+     * Counts the request and restarts the timeout. Only the next handshake
+     * is taken as the answer to this request.
+     */
+    void requestRetransmission();
+    /**
+     * @brief Copy one chunk into the image buffer
+     *
+     * @return true if this chunk completed the image
+     */
+    bool addChunk(int seqnr, const unsigned char* data, int length);
+    /** @brief Decode the received data in the background, missing chunks stay zero */
+    void decode();
+    /** @brief Abort the current transfer */
+    void reset();
+
+    bool isActive() const {
+        return active;
+    }
+    bool isComplete() const {
+        return active && receivedCount == chunks.size();
+    }
+    int getChunkCount() const {
+        return chunks.size();
+    }
+    int getReceivedChunks() const {
+        return receivedCount;
+    }
+    /** @brief Sequence numbers of all chunks which did not arrive yet */
+    QList<int> missingChunks() const;
+    /** @brief Ground time in milliseconds when the transfer was last (re-)started or requested again */
+    quint64 getStartTime() const {
+        return startTime;
+    }
+    /** @brief Number of times the current image was requested again */
+    int getRetransmissions() const {
+        return retransmissions;
+    }
+    /** @brief Number of chunks which arrived more than once */
+    quint64 getDuplicateChunks() const {
+        return duplicates;
+    }
+
+signals:
+    /** @brief A transfer was decoded, the image is null if the data was corrupt */
+    void imageDecoded(const QImage& image);
+
+protected slots:
+    void decodeFinished();
+
+protected:
+    static QImage decodeImage(const QByteArray& data);
+
+    QByteArray buffer;       ///< Image data, chunks are copied to their final position
+    QBitArray chunks;        ///< One bit per received chunk
+    int receivedCount;       ///< Number of set bits in chunks
+    int payload;             ///< Bytes per chunk
+    bool active;             ///< A transfer is in progress
+    quint64 startTime;       ///< Ground time of the last handshake or request in milliseconds
+    int retransmissions;     ///< Requests for the current image
+    bool retransmissionPending; ///< The current image was requested again and the handshake did not arrive yet
+    quint64 duplicates;      ///< Chunks received more than once
+    QFutureWatcher<QImage> decoder; ///< Background JPEG decoder
+    QByteArray queued;       ///< Data to decode once the running decode finished
+    bool decodeQueued;       ///< If queued holds data
+};
+
+#endif // QGCIMAGETRANSFER_H
@@ -71,6 +71,8 @@ UAS::UAS(MAVLinkProtocol* protocol, int id) : UASInterface(),
     pitch(0.0),
     yaw(0.0),
     statusTimeout(new QTimer(this)),
+    imageTransfer(new QGCImageTransfer(this)),
+    imageQuality(50),
     paramsOnceRequested(false),
     airframe(0),
     attitudeKnown(false),
@@ -80,6 +82,7 @@ UAS::UAS(MAVLinkProtocol* protocol, int id) : UASInterface(),
     setBattery(LIPOLY, 3);
     connect(statusTimeout, SIGNAL(timeout()), this, SLOT(updateState()));
     connect(this, SIGNAL(systemSpecsChanged(int)), this, SLOT(writeSettings()));
+    connect(imageTransfer, SIGNAL(imageDecoded(QImage)), this, SLOT(receiveImage(QImage)));
     statusTimeout->start(500);
     readSettings();
 }
@@ -873,35 +876,19 @@ void UAS::receiveMessage(LinkInterface* link, mavlink_message_t message)
             qDebug() << "RECIEVED ACK TO GET IMAGE";
             mavlink_data_transmission_handshake_t p;
             mavlink_msg_data_transmission_handshake_decode(&message, &p);
-            imageSize = p.size;
-            imagePackets = p.packets;
-            imagePayload = p.payload;
             imageQuality = p.jpg_quality;
-            imageStart = QGC::groundTimeMilliseconds();
+            // Every handshake announces a new capture, even if it answers our request
+            imageTransfer->start(p.size, p.packets, p.payload);
         }
         break;
 
         case MAVLINK_MSG_ID_ENCAPSULATED_DATA: {
             mavlink_encapsulated_data_t img;
             mavlink_msg_encapsulated_data_decode(&message, &img);
-            int seq = img.seqnr;
-            int pos = seq * imagePayload;
 
-            for (int i = 0; i < imagePayload; ++i) {
-                if (pos <= imageSize) {
-                    imageRecBuffer[pos] = img.data[i];
-                }
-                ++pos;
-            }
-
-            ++imagePacketsArrived;
-
-            // emit signal if all packets arrived
-            if ((imagePacketsArrived == imagePackets)) {
-                image.loadFromData(imageRecBuffer);
-                emit imageReady(this);
-                // Restart statemachine
-                imagePacketsArrived = 0;
+            // decode in the background once every chunk arrived
+            if (imageTransfer->addChunk(img.seqnr, img.data, MAVLINK_MSG_ENCAPSULATED_DATA_FIELD_DATA_LEN)) {
+                imageTransfer->decode();
 
                 //this->requestImage();
                 //qDebug() << "SENDING REQUEST TO GET NEW IMAGE FROM SYSTEM" << uasId;
@@ -1331,22 +1318,38 @@ void UAS::requestImage()
 #ifdef MAVLINK_ENABLED_PIXHAWK
     qDebug() << "trying to get an image from the uas...";
 
-    if (imagePacketsArrived == 0) {
+    if (!imageTransfer->isActive()) {
         mavlink_message_t msg;
-        mavlink_msg_data_transmission_handshake_pack(mavlink->getSystemId(), mavlink->getComponentId(), &msg, DATA_TYPE_JPEG_IMAGE, 0, 0, 0, 50);
+        mavlink_msg_data_transmission_handshake_pack(mavlink->getSystemId(), mavlink->getComponentId(), &msg, DATA_TYPE_JPEG_IMAGE, 0, 0, 0, imageQuality);
         sendMessage(msg);
-    } else if (QGC::groundTimeMilliseconds() - imageStart >= 1000) {
-        // handshake happened more than 1 second ago, packets should have arrived by now
+    } else if (QGC::groundTimeMilliseconds() - imageTransfer->getStartTime() >= imageTimeout) {
+        // handshake happened more than imageTimeout ago, packets should have arrived by now
         // maybe we missed some packets (dropped along the way)
-        image.loadFromData(imageRecBuffer);
-        emit imageReady(this);
-        // Restart statemachine
-        imagePacketsArrived = 0;
+        if (imageTransfer->getRetransmissions() < imageRetransmissions) {
+            // The handshake has no field for single chunks, so the image is
+            // requested again as a whole. The request counts and restarts the
+            // timeout even if it is lost.
+            qDebug() << "UAS" << uasId << "requesting image again, missing chunks:" << imageTransfer->missingChunks();
+            imageTransfer->requestRetransmission();
+            mavlink_message_t msg;
+            mavlink_msg_data_transmission_handshake_pack(mavlink->getSystemId(), mavlink->getComponentId(), &msg, DATA_TYPE_JPEG_IMAGE, 0, 0, 0, imageQuality);
+            sendMessage(msg);
+        } else {
+            // Show what arrived
+            imageTransfer->decode();
+        }
     }
 #endif
     // default else, wait?
 }
 
+void UAS::receiveImage(const QImage& image)
+{
+    if (image.isNull()) return;
+    this->image = image;
+    emit imageReady(this);
+}
+
 
 /* MANAGEMENT */
 
@@ -36,6 +36,7 @@ This file is part of the QGROUNDCONTROL project
 #include "MG.h"
 #include <MAVLinkProtocol.h>
 #include "QGCMAVLink.h"
+#include "QGCImageTransfer.h"
 
 /**
  * @brief A generic MAVLINK-connected MAV/UAV
@@ -183,14 +184,11 @@ protected: //COMMENTS FOR TEST UNIT
     quint64 lastHeartbeat;      ///< Time of the last heartbeat message
     QTimer* statusTimeout;      ///< Timer for various status timeouts
 
-    int imageSize;              ///< Image size being transmitted (bytes)
-    int imagePackets;           ///< Number of data packets being sent for this image
-    int imagePacketsArrived;    ///< Number of data packets recieved
-    int imagePayload;           ///< Payload size per transmitted packet (bytes). Standard is 254, and decreases when image resolution increases.
+    QGCImageTransfer* imageTransfer; ///< Reassembles the incoming image chunks
     int imageQuality;           ///< JPEG-Quality of the transmitted image (percentage)
-    QByteArray imageRecBuffer;  ///< Buffer for the incoming bytestream
     QImage image;               ///< Image data of last completely transmitted image
-    quint64 imageStart;
+    static const int imageTimeout = 1000;    ///< Time in milliseconds after which missing image chunks are requested again
+    static const int imageRetransmissions = 2; ///< Maximum number of requests for the same image before it is shown incomplete
 
     QMap<int, QMap<QString, float>* > parameters; ///< All parameters
     bool paramsOnceRequested;   ///< If the parameter list has been read at least once
@@ -226,7 +224,8 @@ public:
     }
     int getSystemType();
     QImage getImage();
-    void requestImage(); // ?
+    /** @brief Request a new image or the missing chunks of the image in transmission */
+    void requestImage();
     int getAutopilotType() {
         return autopilot;
     }
@@ -402,6 +401,8 @@ protected slots:
     void writeSettings();
     /** @brief Read settings from disk */
     void readSettings();
+    /** @brief Store a decoded image and notify the views */
+    void receiveImage(const QImage& image);
 
     // MESSAGE RECEPTION
     /** @brief Receive a named value message */
@@ -33,41 +33,26 @@ This file is part of the QGROUNDCONTROL project
 
 CameraView::CameraView(int width, int height, int depth, int channels, QWidget* parent) : QGLWidget(parent)
 {
-    rawImage = NULL;
-    rawBuffer1 = NULL;
-    rawBuffer2 = NULL;
-    rawLastIndex = 0;
-    image = NULL;
     imageStarted = false;
-    // Init to black image
-    //setImageSize(width, height, depth, channels);
     receivedWidth = width;
     receivedHeight = height;
     receivedDepth = depth;
     receivedChannels = channels;
     imageId = -1;
 
-    // Fill with black background
-    QImage fill = QImage(width, height, QImage::Format_Indexed8);
-    fill.setNumColors(1);
-    fill.setColor(0, qRgb(70, 200, 70));
-    fill.fill(CameraView::initialColor);
-    glImage = QGLWidget::convertToGLFormat(fill);
-
-    resize(fill.size());
-
     // Set size once
-    setFixedSize(fill.size());
-    setMinimumSize(fill.size());
-    setMaximumSize(fill.size());
+    resize(width, height);
+    setFixedSize(width, height);
+    setMinimumSize(width, height);
+    setMaximumSize(width, height);
     // Lock down the size
     setSizePolicy(QSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed));
 }
 
 CameraView::~CameraView()
 {
-    delete rawImage;
-    delete image;
+    makeCurrent();
+    texture.release();
 }
 
 void CameraView::addUAS(UASInterface* uas)
@@ -79,47 +64,14 @@ void CameraView::addUAS(UASInterface* uas)
 
 void CameraView::setImageSize(int width, int height, int depth, int channels)
 {
-    // Allocate raw image in correct size
-    if (width != receivedWidth || height != receivedHeight || depth != receivedDepth || channels != receivedChannels || image == NULL) {
-        // Set new size
-        if (width > 0) receivedWidth  = width;
-        if (height > 0) receivedHeight = height;
-        if (depth > 1) receivedDepth = depth;
-        if (channels > 1) receivedChannels = channels;
-
-        rawExpectedBytes = (receivedWidth * receivedHeight * receivedDepth * receivedChannels) / 8;
-        bytesPerLine = rawExpectedBytes / receivedHeight;
-        // Delete old buffers if necessary
-        rawImage = NULL;
-        if (rawBuffer1 != NULL) delete rawBuffer1;
-        if (rawBuffer2 != NULL) delete rawBuffer2;
-
-        rawBuffer1 = (unsigned char*)malloc(rawExpectedBytes);
-        rawBuffer2 = (unsigned char*)malloc(rawExpectedBytes);
-        rawImage = rawBuffer1;
-        // TODO check if old image should be deleted
-
-        // Set image format
-        // 8 BIT GREYSCALE IMAGE
-        if (depth <= 8 && channels == 1) {
-            image = new QImage(receivedWidth, receivedHeight, QImage::Format_Indexed8);
-            // Create matching color table
-            image->setNumColors(256);
-            for (int i = 0; i < 256; i++) {
-                image->setColor(i, qRgb(i, i, i));
-                //qDebug() << __FILE__ << __LINE__ << std::hex << i;
-            }
-
-        }
-        // 32 BIT COLOR IMAGE WITH ALPHA VALUES (#ARGB)
-        else {
-            image = new QImage(receivedWidth, receivedHeight, QImage::Format_ARGB32);
-        }
-
-        // Fill image with black pixels
-        image->fill(CameraView::initialColor);
-        glImage = QGLWidget::convertToGLFormat(*image);
-
+    // Set new size
+    if (width > 0) receivedWidth  = width;
+    if (height > 0) receivedHeight = height;
+    if (depth > 1) receivedDepth = depth;
+    if (channels > 1) receivedChannels = channels;
+
+    // Buffers are only reallocated if the geometry changed
+    if (frames.setFormat(receivedWidth, receivedHeight, receivedDepth, receivedChannels)) {
         qDebug() << __FILE__ << __LINE__ << "Setting up image";
 
         // Set size once
@@ -130,7 +82,6 @@ void CameraView::setImageSize(int width, int height, int depth, int channels)
         setSizePolicy(QSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed));
         resize(receivedWidth, receivedHeight);
     }
-
 }
 
 void CameraView::startImage(int imgid, int width, int height, int depth, int channels)
@@ -143,6 +94,7 @@ void CameraView::startImage(int imgid, int width, int height, int depth, int cha
 
     // Reset image size if necessary
     setImageSize(width, height, depth, channels);
+    frames.beginFrame();
     imageStarted = true;
 }
 
@@ -156,37 +108,14 @@ void CameraView::finishImage()
 
 void CameraView::commitRawDataToGL()
 {
-    //qDebug() << __FILE__ << __LINE__ << "Copying raw data to GL buffer:" << rawImage << receivedWidth << receivedHeight << image->format();
-    if (image != NULL) {
-        QImage::Format format = image->format();
-        QImage* newImage = new QImage(rawImage, receivedWidth, receivedHeight, format);
-        if (format == QImage::Format_Indexed8) {
-            // Create matching color table
-            newImage->setNumColors(256);
-            for (int i = 0; i < 256; i++) {
-                newImage->setColor(i, qRgb(i, i, i));
-                //qDebug() << __FILE__ << __LINE__ << std::hex << i;
-            }
-        }
-
-        glImage = QGLWidget::convertToGLFormat(*newImage);
-        delete image;
-        image = newImage;
-        // Switch buffers
-        if (rawImage == rawBuffer1) {
-            rawImage = rawBuffer2;
-            //qDebug() << "Now buffer 2";
-        } else {
-            rawImage = rawBuffer1;
-            //qDebug() << "Now buffer 1";
-        }
-    }
-    paintGL();
+    frames.commitFrame();
+    update();
 }
 
 void CameraView::saveImage(QString fileName)
 {
-    image->save(fileName);
+    const QImage* image = frames.displayedFrame();
+    if (image) image->save(fileName);
 }
 
 void CameraView::saveImage()
@@ -204,39 +133,23 @@ void CameraView::setPixels(int imgid, const unsigned char* imageData, int length
 
     //    qDebug() << "at" << __FILE__ << __LINE__ << ": Received startindex" << startIndex << "and length" << length << "(" << startIndex+length << "of" << rawExpectedBytes << "bytes)";
 
-    if (imageStarted) {
-        //if (rawLastIndex != startIndex) qDebug() << "PACKET LOSS!";
-
-        if (startIndex+length > rawExpectedBytes) {
-            qDebug() << "CAMERAVIEW: OVERFLOW! startIndex:" << startIndex << "length:" << length << "image raw size" << ((receivedWidth * receivedHeight * receivedChannels * receivedDepth) / 8) - 1;
-        } else {
-            memcpy(rawImage+startIndex, imageData, length);
-
-            rawLastIndex = startIndex+length;
-
-            // Check if we just reached the end of the image
-            if (startIndex+length == rawExpectedBytes) {
-                //qDebug() << "CAMERAVIEW: END OF IMAGE REACHED!";
-                finishImage();
-                rawLastIndex = 0;
-            }
-        }
-
-        //        for (int i = 0; i < length; i++)
-        //        {
-        //            for (int j = 0; j < receivedChannels; j++)
-        //            {
-        //                unsigned int x = (startIndex+i) % receivedWidth;
-        //                unsigned int y = static_cast<unsigned int>((startIndex+i) / receivedWidth);
-        //                qDebug() << "Setting pixel" << x << "," << y << "to" << (unsigned int)*(rawImage+startIndex+i);
-        //            }
-        //        }
+    // Copy the chunk directly into the frame buffer, it is displayed from there
+    if (imageStarted && frames.writePixels(imageData, length, startIndex)) {
+        //qDebug() << "CAMERAVIEW: END OF IMAGE REACHED!";
+        finishImage();
     }
 }
 
 void CameraView::paintGL()
 {
-    glDrawPixels(glImage.width(), glImage.height(), GL_RGBA, GL_UNSIGNED_BYTE, glImage.bits());
+    glClear(GL_COLOR_BUFFER_BIT);
+    const QImage* frame = frames.takePendingFrame();
+    if (frame) {
+        texture.upload(*frame);
+        frames.markUploaded();
+    }
+    texture.draw(width(), height());
+    frames.markDisplayed();
 }
 
 void CameraView::resizeGL(int w, int h)
@@ -35,6 +35,8 @@ This file is part of the PIXHAWK project
 #include <QImage>
 #include <QGLWidget>
 #include "UASInterface.h"
+#include "QGCVideoFramePool.h"
+#include "QGCVideoTexture.h"
 
 class CameraView : public QGLWidget
 {
@@ -46,6 +48,10 @@ public:
     void setImageSize(int width, int height, int depth, int channels);
     void paintGL();
     void resizeGL(int w, int h);
+    /** @brief Frame buffers and latency counters of the video stream */
+    const QGCVideoFramePool& getFramePool() const {
+        return frames;
+    }
 
 public slots:
     void addUAS(UASInterface* uas);
@@ -57,21 +63,14 @@ public slots:
 
 protected:
     // Image buffers
-    unsigned char* rawBuffer1;
-    unsigned char* rawBuffer2;
-    unsigned char* rawImage;
-    unsigned int rawLastIndex;
-    unsigned int rawExpectedBytes;
-    unsigned int bytesPerLine;
+    QGCVideoFramePool frames; ///< Reusable frame buffers, the stream is received directly into them
+    QGCVideoTexture texture;  ///< Displayed image, updated in place
     bool imageStarted;
     static const unsigned char initialColor = 0;
-    QImage* image; ///< Double buffer image
-    QImage glImage; ///< Displayed image
     int receivedDepth;
     int receivedChannels;
     int receivedWidth;
     int receivedHeight;
-    QMap<int, QImage*> images; ///< Reference to the received images
     int imageId; ///< ID of the currently displayed image
 
     void commitRawDataToGL();
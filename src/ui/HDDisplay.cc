@@ -24,6 +24,7 @@
 #include "ui_HDDisplay.h"
 #include "MG.h"
 #include "QGC.h"
+#include "QGCFrameScheduler.h"
 #include <QDebug>
 
 HDDisplay::HDDisplay(QStringList* plotList, QString title, QWidget *parent) :
@@ -41,13 +42,10 @@ HDDisplay::HDDisplay(QStringList* plotList, QString title, QWidget *parent) :
     infoColor(QColor(20, 200, 20)),
     fuelColor(criticalColor),
     warningBlinkRate(5),
-    refreshTimer(new QTimer(this)),
     hardwareAcceleration(true),
     strongStrokeWidth(1.5f),
     normalStrokeWidth(1.0f),
     fineStrokeWidth(0.5f),
-    acceptList(new QStringList()),
-    acceptUnitList(new QStringList()),
     lastPaintTime(0),
     columns(3),
     m_ui(new Ui::HDDisplay)
@@ -112,10 +110,8 @@ HDDisplay::HDDisplay(QStringList* plotList, QString title, QWidget *parent) :
     this->setMinimumHeight(125);
     this->setMinimumWidth(100);
 
-    // Refresh timer
-    refreshTimer->setInterval(180); //
-    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(triggerUpdate()));
-    //connect(refreshTimer, SIGNAL(timeout()), this, SLOT(paintGL()));
+    // Repaint through the central frame scheduler
+    QGCFrameScheduler::instance()->registerWidget(this, updateInterval);
 
     fontDatabase = QFontDatabase();
     const QString fontFileName = ":/general/vera.ttf"; ///< Font file is part of the QRC file and compiled into the app
@@ -149,8 +145,8 @@ void HDDisplay::enableGLRendering(bool enable)
 
 void HDDisplay::triggerUpdate()
 {
-    // Only repaint the regions necessary
-    update(this->geometry());
+    // Repaint with the next frame of the scheduler
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 //void HDDisplay::updateValue(UASInterface* uas, const QString& name, const QString& unit, double value, quint64 msec)
@@ -213,9 +209,8 @@ void HDDisplay::saveState()
 
     QString instruments;
     // Restore instrument settings
-    for (int i = 0; i < acceptList->count(); i++) {
-        QString key = acceptList->at(i);
-        instruments += "|" + QString::number(minValues.value(key, -1.0))+","+key+","+acceptUnitList->at(i)+","+QString::number(maxValues.value(key, +1.0))+","+((symmetric.value(key, false)) ? "s" : "");
+    for (int i = 0; i < gauges.count(); i++) {
+        instruments += "|" + QString::number(gauges.minValues.at(i))+","+gauges.names.at(i)+","+gauges.units.at(i)+","+QString::number(gauges.maxValues.at(i))+","+((gauges.symmetric.at(i)) ? "s" : "");
     }
 
     // qDebug() << "Saving" << instruments;
@@ -238,8 +233,8 @@ void HDDisplay::restoreState()
 QList<QAction*> HDDisplay::getItemRemoveActions()
 {
     QList<QAction*> actions;
-    for(int i = 0; i < acceptList->length(); ++i) {
-        QString gauge = acceptList->at(i);
+    for(int i = 0; i < gauges.count(); ++i) {
+        QString gauge = gauges.names.at(i);
         QAction* remove = new QAction(tr("Remove %1 gauge").arg(gauge), this);
         remove->setStatusTip(tr("Removes the %1 gauge from the view.").arg(gauge));
         remove->setData(gauge);
@@ -254,11 +249,7 @@ void HDDisplay::removeItemByAction()
     QAction* trigger = qobject_cast<QAction*>(QObject::sender());
     if (trigger) {
         QString item = trigger->data().toString();
-        int index = acceptList->indexOf(item);
-        acceptList->removeAt(index);
-        minValues.remove(item);
-        maxValues.remove(item);
-        symmetric.remove(item);
+        gauges.removeGauge(gauges.handle(item));
         adjustGaugeAspectRatio();
     }
 }
@@ -266,9 +257,11 @@ void HDDisplay::removeItemByAction()
 void HDDisplay::addGauge()
 {
     QStringList items;
-    for (int i = 0; i < values.count(); ++i) {
-        QString key = values.keys().at(i);
-        QString unit = units.value(key);
+    QMapIterator<QString, QString> value(gauges.availableValues());
+    while (value.hasNext()) {
+        value.next();
+        QString key = value.key();
+        QString unit = value.value();
         if (unit.contains("deg") || unit.contains("rad")) {
             items.append(QString("%1,%2,%3,%4,s").arg("-180").arg(key).arg(unit).arg("+180"));
         } else {
@@ -295,31 +288,32 @@ void HDDisplay::addGauge(const QString& gauge)
             QString key = parts.at(1);
             QString unit = parts.at(2);
 
-            if (!acceptList->contains(key)) {
+            if (gauges.handle(key) < 0) {
+                float min = -1.0f;
+                float max = 1.0f;
+                bool sym = false;
                 // Convert min to double number
                 val = parts.first().toDouble(&ok);
                 success &= ok;
-                if (ok) minValues.insert(key, val);
+                if (ok) min = val;
                 // Convert max to double number
-                val = parts.at(3).toDouble(&ok);
+                val = parts.value(3).toDouble(&ok);
                 success &= ok;
-                if (ok) maxValues.insert(key, val);
+                if (ok) max = val;
                 // Convert symmetric flag
                 if (parts.length() >= 5) {
                     if (parts.at(4).contains("s")) {
-                        symmetric.insert(key, true);
+                        sym = true;
                     }
                 }
                 if (success) {
-                    // Add value to acceptlist
-                    acceptList->append(key);
-                    acceptUnitList->append(unit);
+                    // Start tracking this value
+                    gauges.addGauge(key, unit, min, max, sym);
                 }
             }
         } else if (parts.count() > 1) {
-            if (!acceptList->contains(gauge)) {
-                acceptList->append(parts.at(0));
-                acceptUnitList->append(parts.at(1));
+            if (gauges.handle(parts.at(0)) < 0) {
+                gauges.addGauge(parts.at(0), parts.at(1));
             }
         }
     }
@@ -362,9 +356,10 @@ void HDDisplay::adjustGaugeAspectRatio()
 {
     // Adjust vheight dynamically according to the number of rows
     float vColWidth = vwidth / columns;
-    int vRows = ceil(acceptList->length()/(float)columns);
+    int vRows = ceil(gauges.count()/(float)columns);
     // Assuming square instruments, vheight is column width*row count
     vheight = vColWidth * vRows;
+    triggerUpdate();
 }
 
 void HDDisplay::setTitle()
@@ -420,9 +415,8 @@ void HDDisplay::renderOverlay()
     float topSpacing = leftSpacing;
     float yCoord = topSpacing + gaugeWidth/2.0f;
 
-    for (int i = 0; i < acceptList->size(); ++i) {
-        QString value = acceptList->at(i);
-        drawGauge(xCoord, yCoord, gaugeWidth/2.0f, minValues.value(value, -1.0f), maxValues.value(value, 1.0f), value, values.value(value, minValues.value(value, 0.0f)), gaugeColor, &painter, symmetric.value(value, false), goodRanges.value(value, qMakePair(0.0f, 0.5f)), critRanges.value(value, qMakePair(0.7f, 1.0f)), true);
+    for (int i = 0; i < gauges.count(); ++i) {
+        drawGauge(xCoord, yCoord, gaugeWidth/2.0f, i, gaugeColor, &painter, true);
         xCoord += gaugeWidth + leftSpacing;
         // Move one row down if necessary
         if (xCoord + gaugeWidth*0.9f > vwidth) {
@@ -430,6 +424,8 @@ void HDDisplay::renderOverlay()
             xCoord = leftSpacing + gaugeWidth/2.0f;
         }
     }
+
+    QGCFrameScheduler::instance()->paintOverlay(this, &painter);
 }
 
 /**
@@ -536,8 +532,16 @@ void HDDisplay::drawChangeRateStrip(float xRef, float yRef, float height, float
     paintText(label, defaultColor, 3.0f, xRef+width/2.0f, yRef+height-((scaledValue - minRate)/(maxRate-minRate))*height - 1.6f, painter);
 }
 
-void HDDisplay::drawGauge(float xRef, float yRef, float radius, float min, float max, QString name, float value, const QColor& color, QPainter* painter, bool symmetric, QPair<float, float> goodRange, QPair<float, float> criticalRange, bool solid)
+void HDDisplay::drawGauge(float xRef, float yRef, float radius, int handle, const QColor& color, QPainter* painter, bool solid)
 {
+    const float min = gauges.minValues.at(handle);
+    const float max = gauges.maxValues.at(handle);
+    const QString& name = gauges.names.at(handle);
+    const float value = gauges.values.at(handle);
+    const bool symmetric = gauges.symmetric.at(handle);
+    const QPair<float, float>& goodRange = gauges.goodRanges.at(handle);
+    const QPair<float, float>& criticalRange = gauges.critRanges.at(handle);
+
     // Draw the circle
     QPen circlePen(Qt::SolidLine);
 
@@ -583,7 +587,7 @@ void HDDisplay::drawGauge(float xRef, float yRef, float radius, float min, float
     QString label;
 
     // Show integer values without decimal places
-    if (intValues.contains(name)) {
+    if (gauges.intValues.at(handle)) {
         label.sprintf("% 05d", (int)value);
     } else {
         label.sprintf("% 06.1f", value);
@@ -657,14 +661,12 @@ void HDDisplay::drawGauge(float xRef, float yRef, float radius, float min, float
 
 void HDDisplay::drawSystemIndicator(float xRef, float yRef, int maxNum, float maxWidth, float maxHeight, QPainter* painter)
 {
-    if (values.size() > 0) {
-        QString selectedKey = values.begin().key();
+    if (gauges.count() > 0) {
         //   | | | | | |
         //   | | | | | |
         //   x speed: 2.54
 
         // One column per value
-        QMapIterator<QString, float> value(values);
 
         float x = xRef;
         float y = yRef;
@@ -675,14 +677,14 @@ void HDDisplay::drawSystemIndicator(float xRef, float yRef, int maxNum, float ma
         const float hspacing = 0.6f;
 
         int i = 0;
-        while (value.hasNext() && i < maxNum && x < maxWidth && y < maxHeight) {
-            value.next();
+        while (i < gauges.count() && i < maxNum && x < maxWidth && y < maxHeight) {
+            const float value = gauges.values.at(i);
             QBrush brush(Qt::SolidPattern);
 
 
-            if (value.value() < 0.01f && value.value() > -0.01f) {
+            if (value < 0.01f && value > -0.01f) {
                 brush.setColor(Qt::gray);
-            } else if (value.value() > 0.01f) {
+            } else if (value > 0.01f) {
                 brush.setColor(Qt::blue);
             } else {
                 brush.setColor(Qt::yellow);
@@ -710,10 +712,10 @@ void HDDisplay::drawSystemIndicator(float xRef, float yRef, int maxNum, float ma
         // Draw detail label
         QString detail = "NO DATA AVAILABLE";
 
-        if (values.contains(selectedKey)) {
-            detail = values.find(selectedKey).key();
+        if (gauges.valuesCount.at(0) > 0) {
+            detail = gauges.names.at(0);
             detail.append(": ");
-            detail.append(QString::number(values.find(selectedKey).value()));
+            detail.append(QString::number(gauges.values.at(0)));
         }
         paintText(detail, QColor(255, 255, 255), 3.0f, xRef, yRef+3.0f*(height+hspacing)+1.0f, painter);
     }
@@ -804,23 +806,19 @@ float HDDisplay::refLineWidthToPen(float line)
 
 void HDDisplay::updateValue(const int uasId, const QString& name, const QString& unit, const int value, const quint64 msec)
 {
-    if (!intValues.contains(name)) intValues.insert(name, true);
-    updateValue(uasId, name, unit, (double)value, msec);
+    Q_UNUSED(uasId);
+    if (gauges.updateValue(name, unit, (double)value, msec, true)) {
+        triggerUpdate();
+    }
 }
 
 void HDDisplay::updateValue(const int uasId, const QString& name, const QString& unit, const double value, const quint64 msec)
 {
     Q_UNUSED(uasId);
-    Q_UNUSED(unit);
-    // Update mean
-    const float oldMean = valuesMean.value(name, 0.0f);
-    const int meanCount = valuesCount.value(name, 0);
-    valuesMean.insert(name, (oldMean * meanCount +  value) / (meanCount + 1));
-    valuesCount.insert(name, meanCount + 1);
-    valuesDot.insert(name, (value - values.value(name, 0.0f)) / ((msec - lastUpdate.value(name, 0))/1000.0f));
-    values.insert(name, value);
-    units.insert(name, unit);
-    lastUpdate.insert(name, msec);
+    // Values not shown as gauge are rejected with a single hash lookup
+    if (gauges.updateValue(name, unit, value, msec)) {
+        triggerUpdate();
+    }
 }
 
 /**
@@ -892,7 +890,7 @@ void HDDisplay::showEvent(QShowEvent* event)
     // React only to internal (pre-display)
     // events
     Q_UNUSED(event);
-    refreshTimer->start(updateInterval);
+    triggerUpdate();
 }
 
 void HDDisplay::hideEvent(QHideEvent* event)
@@ -900,7 +898,6 @@ void HDDisplay::hideEvent(QHideEvent* event)
     // React only to internal (pre-display)
     // events
     Q_UNUSED(event);
-    refreshTimer->stop();
     saveState();
 }
 
@@ -42,6 +42,7 @@ This file is part of the QGROUNDCONTROL project
 #include <cmath>
 
 #include "UASInterface.h"
+#include "HDDisplayGaugeTable.h"
 
 namespace Ui
 {
@@ -117,7 +118,8 @@ protected:
 
     void drawChangeRateStrip(float xRef, float yRef, float height, float minRate, float maxRate, float value, QPainter* painter);
     void drawChangeIndicatorGauge(float xRef, float yRef, float radius, float expectedMaxChange, float value, const QColor& color, QPainter* painter, bool solid=true);
-    void drawGauge(float xRef, float yRef, float radius, float min, float max, const QString name, float value, const QColor& color, QPainter* painter, bool symmetric, QPair<float, float> goodRange, QPair<float, float> criticalRange, bool solid=true);
+    /** @brief Draw the gauge with this handle in the gauge table */
+    void drawGauge(float xRef, float yRef, float radius, int handle, const QColor& color, QPainter* painter, bool solid=true);
     void drawSystemIndicator(float xRef, float yRef, int maxNum, float maxWidth, float maxHeight, QPainter* painter);
     void paintText(QString text, QColor color, float fontSize, float refX, float refY, QPainter* painter);
 
@@ -139,18 +141,7 @@ protected:
 //     virtual void resizeEvent(QResizeEvent* event);
 
     UASInterface* uas;                 ///< The uas currently monitored
-    QMap<QString, float> values;       ///< The variables this HUD displays
-    QMap<QString, QString> units;      ///< The units
-    QMap<QString, float> valuesDot;    ///< First derivative of the variable
-    QMap<QString, float> valuesMean;   ///< Mean since system startup for this variable
-    QMap<QString, int> valuesCount;    ///< Number of values received so far
-    QMap<QString, quint64> lastUpdate; ///< The last update time for this variable
-    QMap<QString, float> minValues;    ///< The minimum value this variable is assumed to have
-    QMap<QString, float> maxValues;    ///< The maximum value this variable is assumed to have
-    QMap<QString, bool> symmetric;     ///< Draw the gauge / dial symmetric bool = yes
-    QMap<QString, bool> intValues;     ///< Is the gauge value an integer?
-    QMap<QString, QPair<float, float> > goodRanges; ///< The range of good values
-    QMap<QString, QPair<float, float> > critRanges; ///< The range of critical values
+    HDDisplayGaugeTable gauges;        ///< The variables this HUD displays, indexed by gauge handle
     double scalingFactor;      ///< Factor used to scale all absolute values to screen coordinates
     float xCenterOffset, yCenterOffset; ///< Offset from center of window in mm coordinates
     float vwidth;              ///< Virtual width of this window, 200 mm per default. This allows to hardcode positions and aspect ratios. This virtual image plane is then scaled to the window size.
@@ -171,7 +162,6 @@ protected:
     // Blink rates
     int warningBlinkRate;      ///< Blink rate of warning messages, will be rounded to the refresh rate
 
-    QTimer* refreshTimer;      ///< The main timer, controls the update rate
     static const int updateInterval = 120; ///< Update interval in milliseconds
     QPainter* hudPainter;
     QFont font;                ///< The HUD font, per default the free Bitstream Vera SANS, which is very close to actual HUD fonts
@@ -182,9 +172,6 @@ protected:
     float normalStrokeWidth;   ///< Normal line stroke width, used throughout the HUD
     float fineStrokeWidth;     ///< Fine line stroke width, used throughout the HUD
 
-    QStringList* acceptList;       ///< Variable names to plot
-    QStringList* acceptUnitList;   ///< Unit names to plot
-
     quint64 lastPaintTime;     ///< Last time this widget was refreshed
     int columns;               ///< Number of instrument columns
 
@@ -0,0 +1,124 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the gauge value table used by the head down display
+ *
+ */
+
+#include "HDDisplayGaugeTable.h"
+
+HDDisplayGaugeTable::HDDisplayGaugeTable()
+{
+}
+
+int HDDisplayGaugeTable::addGauge(const QString& name, const QString& unit, float min, float max, bool symmetric)
+{
+    int h = handle(name);
+    if (h >= 0) return h;
+
+    h = names.size();
+    names.append(name);
+    units.append(unit);
+    // Show the minimum until the first value arrives
+    values.append(min);
+    valuesDot.append(0.0f);
+    valuesMean.append(0.0f);
+    valuesCount.append(0);
+    lastUpdate.append(0);
+    minValues.append(min);
+    maxValues.append(max);
+    this->symmetric.append(symmetric);
+    intValues.append(false);
+    goodRanges.append(qMakePair(0.0f, 0.5f));
+    critRanges.append(qMakePair(0.7f, 1.0f));
+    handles.insert(name, h);
+    return h;
+}
+
+void HDDisplayGaugeTable::removeGauge(int handle)
+{
+    if (handle < 0 || handle >= names.size()) return;
+
+    names.removeAt(handle);
+    units.removeAt(handle);
+    values.remove(handle);
+    valuesDot.remove(handle);
+    valuesMean.remove(handle);
+    valuesCount.remove(handle);
+    lastUpdate.remove(handle);
+    minValues.remove(handle);
+    maxValues.remove(handle);
+    symmetric.remove(handle);
+    intValues.remove(handle);
+    goodRanges.remove(handle);
+    critRanges.remove(handle);
+    rebuildHandles();
+}
+
+void HDDisplayGaugeTable::rebuildHandles()
+{
+    // Keep the removed names in the map so that their samples
+    // are still rejected with a single lookup
+    QMutableHashIterator<QString, int> i(handles);
+    while (i.hasNext()) {
+        i.next();
+        i.setValue(-1);
+    }
+    for (int k = 0; k < names.size(); ++k) {
+        handles.insert(names.at(k), k);
+    }
+}
+
+bool HDDisplayGaugeTable::updateValue(const QString& name, const QString& unit, double value, quint64 msec, bool isInteger)
+{
+    QHash<QString, int>::const_iterator it = handles.constFind(name);
+    if (it == handles.constEnd()) {
+        // First sample of a value not shown, only remember it for the gauge menu
+        handles.insert(name, -1);
+        available.insert(name, unit);
+        return false;
+    }
+
+    const int h = it.value();
+    if (h < 0) return false;
+
+    if (valuesCount.at(h) == 0) available.insert(name, unit);
+    if (isInteger) intValues[h] = true;
+    updateValue(h, value, msec);
+    return true;
+}
+
+void HDDisplayGaugeTable::updateValue(int handle, double value, quint64 msec)
+{
+    const float oldMean = valuesMean.at(handle);
+    const int meanCount = valuesCount.at(handle);
+    valuesMean[handle] = (oldMean * meanCount + value) / (meanCount + 1);
+    valuesCount[handle] = meanCount + 1;
+    if (meanCount > 0) {
+        valuesDot[handle] = (value - values.at(handle)) / ((msec - lastUpdate.at(handle))/1000.0f);
+    }
+    values[handle] = value;
+    lastUpdate[handle] = msec;
+}
@@ -0,0 +1,100 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the gauge value table used by the head down display
+ *
+ */
+
+#ifndef HDDISPLAYGAUGETABLE_H
+#define HDDISPLAYGAUGETABLE_H
+
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief Flat, index-addressed store for the values shown by a HDDisplay
+ *
+ * All gauge properties are kept as parallel arrays (struct of arrays) and
+ * addressed by an integer handle, which is the position of the gauge in the
+ * display order. Incoming samples are resolved with a single hash lookup,
+ * samples of names that are not shown are rejected without further work.
+ */
+class HDDisplayGaugeTable
+{
+public:
+    HDDisplayGaugeTable();
+
+    /** @brief Start tracking a gauge, returns its handle or the existing handle */
+    int addGauge(const QString& name, const QString& unit, float min=-1.0f, float max=1.0f, bool symmetric=false);
+    /** @brief Stop tracking a gauge, handles of the following gauges shift down by one */
+    void removeGauge(int handle);
+
+    /** @brief Handle of a gauge, -1 if the name is not shown */
+    int handle(const QString& name) const {
+        return handles.value(name, -1);
+    }
+    /** @brief Number of gauges */
+    int count() const {
+        return names.size();
+    }
+
+    /** @brief Update a value by name. Returns false if the name is not shown */
+    bool updateValue(const QString& name, const QString& unit, double value, quint64 msec, bool isInteger=false);
+    /** @brief Update a value by handle */
+    void updateValue(int handle, double value, quint64 msec);
+
+    /** @brief All value names seen so far with their units, including the ones not shown */
+    const QMap<QString, QString>& availableValues() const {
+        return available;
+    }
+
+    // Gauge properties, all indexed by handle
+    QStringList names;                ///< The variable names
+    QStringList units;                ///< The units
+    QVector<float> values;            ///< The current values
+    QVector<float> valuesDot;         ///< First derivative of the variable
+    QVector<float> valuesMean;        ///< Mean since system startup for this variable
+    QVector<int> valuesCount;         ///< Number of values received so far
+    QVector<quint64> lastUpdate;      ///< The last update time for this variable
+    QVector<float> minValues;         ///< The minimum value this variable is assumed to have
+    QVector<float> maxValues;         ///< The maximum value this variable is assumed to have
+    QVector<bool> symmetric;          ///< Draw the gauge / dial symmetric bool = yes
+    QVector<bool> intValues;          ///< Is the gauge value an integer?
+    QVector<QPair<float, float> > goodRanges; ///< The range of good values
+    QVector<QPair<float, float> > critRanges; ///< The range of critical values
+
+protected:
+    /** @brief Rebuild the name to handle map after the order changed */
+    void rebuildHandles();
+
+    QHash<QString, int> handles;      ///< Gauge name to handle, -1 for seen but not shown names
+    QMap<QString, QString> available; ///< Seen value names and their units, offered when adding gauges
+};
+
+#endif // HDDISPLAYGAUGETABLE_H
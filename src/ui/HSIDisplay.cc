@@ -38,6 +38,7 @@ This file is part of the QGROUNDCONTROL project
 #include "UASManager.h"
 #include "HSIDisplay.h"
 #include "QGC.h"
+#include "QGCFrameScheduler.h"
 #include "Waypoint.h"
 #include "UASWaypointManager.h"
 #include "Waypoint2DIcon.h"
@@ -48,6 +49,7 @@ This file is part of the QGROUNDCONTROL project
 HSIDisplay::HSIDisplay(QWidget *parent) :
     HDDisplay(NULL, "HSI", parent),
     gpsSatellites(),
+    satelliteTimer(),
     satellitesUsed(0),
     attXSet(0.0f),
     attYSet(0.0f),
@@ -100,8 +102,6 @@ HSIDisplay::HSIDisplay(QWidget *parent) :
     topMargin(12.0f),
     userSetPointSet(false)
 {
-    refreshTimer->setInterval(updateInterval);
-
     columns = 1;
     this->setAutoFillBackground(true);
     QPalette pal = palette();
@@ -132,6 +132,9 @@ HSIDisplay::HSIDisplay(QWidget *parent) :
     layout->setAlignment(spinBox, Qt::AlignBottom | Qt::AlignRight);
     this->setLayout(layout);
 
+    satelliteTimer.setInterval(500);
+    connect(&satelliteTimer, SIGNAL(timeout()), this, SLOT(removeStaleSatellites()));
+
     uas = NULL;
     resetMAVState();
 
@@ -169,6 +172,7 @@ void HSIDisplay::resetMAVState()
     // Setpoints
     positionSetPointKnown = false;
     setPointKnown = false;
+    triggerUpdate();
 }
 
 void HSIDisplay::paintEvent(QPaintEvent * event)
@@ -329,6 +333,8 @@ void HSIDisplay::renderOverlay()
 
     // Draw Field of view to bottom right
     paintText(tr("FOV"), QGC::colorCyan, 2.6f, 62, vheight- 5.0f, &painter);
+
+    QGCFrameScheduler::instance()->paintOverlay(this, &painter);
 }
 
 void HSIDisplay::drawStatusFlag(float x, float y, QString label, bool status, bool known, QPainter& painter)
@@ -431,24 +437,28 @@ void HSIDisplay::updatePositionLock(UASInterface* uas, bool lock)
 {
     Q_UNUSED(uas);
     positionLock = lock;
+    triggerUpdate();
 }
 
 void HSIDisplay::updateAttitudeControllerEnabled(bool enabled)
 {
     attControlEnabled = enabled;
     attControlKnown = true;
+    triggerUpdate();
 }
 
 void HSIDisplay::updatePositionXYControllerEnabled(bool enabled)
 {
     xyControlEnabled = enabled;
     xyControlKnown = true;
+    triggerUpdate();
 }
 
 void HSIDisplay::updatePositionZControllerEnabled(bool enabled)
 {
     zControlEnabled = enabled;
     zControlKnown = true;
+    triggerUpdate();
 }
 
 QPointF HSIDisplay::metricWorldToBody(QPointF world)
@@ -526,6 +536,7 @@ void HSIDisplay::setMetricWidth(double width)
         metricWidth = width;
         emit metricWidthChanged(metricWidth);
     }
+    triggerUpdate();
 }
 
 /**
@@ -552,6 +563,10 @@ void HSIDisplay::setActiveUAS(UASInterface* uas)
         disconnect(this->uas, SIGNAL(visionLocalizationChanged(UASInterface*,int)), this, SLOT(updateVisionLocalization(UASInterface*,int)));
         disconnect(this->uas, SIGNAL(gpsLocalizationChanged(UASInterface*,int)), this, SLOT(updateGpsLocalization(UASInterface*,int)));
         disconnect(this->uas, SIGNAL(irUltraSoundLocalizationChanged(UASInterface*,int)), this, SLOT(updateInfraredUltrasoundLocalization(UASInterface*,int)));
+
+        disconnect(this->uas->getWaypointManager(), SIGNAL(waypointListChanged(int)), this, SLOT(updateWaypoints()));
+        disconnect(this->uas->getWaypointManager(), SIGNAL(waypointChanged(int,Waypoint*)), this, SLOT(updateWaypoints()));
+        disconnect(this->uas->getWaypointManager(), SIGNAL(currentWaypointChanged(quint16)), this, SLOT(updateWaypoints()));
     }
 
     connect(uas, SIGNAL(gpsSatelliteStatusChanged(int,int,float,float,float,bool)), this, SLOT(updateSatellite(int,int,float,float,float,bool)));
@@ -572,9 +587,24 @@ void HSIDisplay::setActiveUAS(UASInterface* uas)
     connect(uas, SIGNAL(gpsLocalizationChanged(UASInterface*,int)), this, SLOT(updateGpsLocalization(UASInterface*,int)));
     connect(uas, SIGNAL(irUltraSoundLocalizationChanged(UASInterface*,int)), this, SLOT(updateInfraredUltrasoundLocalization(UASInterface*,int)));
 
+    connect(uas->getWaypointManager(), SIGNAL(waypointListChanged(int)), this, SLOT(updateWaypoints()));
+    connect(uas->getWaypointManager(), SIGNAL(waypointChanged(int,Waypoint*)), this, SLOT(updateWaypoints()));
+    connect(uas->getWaypointManager(), SIGNAL(currentWaypointChanged(quint16)), this, SLOT(updateWaypoints()));
+
     this->uas = uas;
 
+    // The satellites of the previous MAV are no longer valid
+    qDeleteAll(gpsSatellites);
+    gpsSatellites.clear();
+    satelliteTimer.stop();
+
     resetMAVState();
+    triggerUpdate();
+}
+
+void HSIDisplay::updateWaypoints()
+{
+    triggerUpdate();
 }
 
 void HSIDisplay::updateSpeed(UASInterface* uas, double vx, double vy, double vz, quint64 time)
@@ -585,6 +615,7 @@ void HSIDisplay::updateSpeed(UASInterface* uas, double vx, double vy, double vz,
     this->vy = vy;
     this->vz = vz;
     this->speed = sqrt(pow(vx, 2.0) + pow(vy, 2.0) + pow(vz, 2.0));
+    triggerUpdate();
 }
 
 void HSIDisplay::setBodySetpointCoordinateXY(double x, double y)
@@ -602,12 +633,14 @@ void HSIDisplay::setBodySetpointCoordinateXY(double x, double y)
         uas->setLocalPositionSetpoint(uiXSetCoordinate, uiYSetCoordinate, uiZSetCoordinate, uiYawSet);
         qDebug() << "Setting new setpoint at x: " << x << "metric y:" << y;
     }
+    triggerUpdate();
 }
 
 void HSIDisplay::setBodySetpointCoordinateZ(double z)
 {
     // Set coordinates and send them out to MAV
     uiZSetCoordinate = z;
+    triggerUpdate();
 }
 
 void HSIDisplay::sendBodySetPointCoordinates()
@@ -623,6 +656,7 @@ void HSIDisplay::updateAttitudeSetpoints(UASInterface* uas, double rollDesired,
     attYSet = rollDesired;
     attYawSet = yawDesired;
     altitudeSet = thrustDesired;
+    triggerUpdate();
 }
 
 void HSIDisplay::updateAttitude(UASInterface* uas, double roll, double pitch, double yaw, quint64 time)
@@ -632,6 +666,7 @@ void HSIDisplay::updateAttitude(UASInterface* uas, double roll, double pitch, do
     this->roll = roll;
     this->pitch = pitch;
     this->yaw = yaw;
+    triggerUpdate();
 }
 
 void HSIDisplay::updatePositionSetpoints(int uasid, float xDesired, float yDesired, float zDesired, float yawDesired, quint64 usec)
@@ -651,6 +686,7 @@ void HSIDisplay::updatePositionSetpoints(int uasid, float xDesired, float yDesir
     //    posYSet = yDesired;
     //    posZSet = zDesired;
     //    posYawSet = yawDesired;
+    triggerUpdate();
 }
 
 void HSIDisplay::updateLocalPosition(UASInterface*, double x, double y, double z, quint64 usec)
@@ -659,6 +695,7 @@ void HSIDisplay::updateLocalPosition(UASInterface*, double x, double y, double z
     this->y = y;
     this->z = z;
     localAvailable = usec;
+    triggerUpdate();
 }
 
 void HSIDisplay::updateGlobalPosition(UASInterface*, double lat, double lon, double alt, quint64 usec)
@@ -667,6 +704,7 @@ void HSIDisplay::updateGlobalPosition(UASInterface*, double lat, double lon, dou
     this->lon = lon;
     this->alt = alt;
     globalAvailable = usec;
+    triggerUpdate();
 }
 
 void HSIDisplay::updateSatellite(int uasid, int satid, float elevation, float azimuth, float snr, bool used)
@@ -679,12 +717,35 @@ void HSIDisplay::updateSatellite(int uasid, int satid, float elevation, float az
     } else {
         gpsSatellites.insert(satid, new GPSSatellite(satid, elevation, azimuth, snr, used));
     }
+    if (!satelliteTimer.isActive()) satelliteTimer.start();
+    triggerUpdate();
+}
+
+void HSIDisplay::removeStaleSatellites()
+{
+    quint64 currTime = MG::TIME::getGroundTimeNowUsecs();
+    bool removed = false;
+
+    QMutableMapIterator<int, GPSSatellite*> i(gpsSatellites);
+    while (i.hasNext()) {
+        i.next();
+        // Remove satellites without update in the last second
+        if (i.value()->lastUpdate + 1000000 < currTime) {
+            delete i.value();
+            i.remove();
+            removed = true;
+        }
+    }
+
+    if (gpsSatellites.isEmpty()) satelliteTimer.stop();
+    if (removed) triggerUpdate();
 }
 
 void HSIDisplay::updatePositionYawControllerEnabled(bool enabled)
 {
     yawControlEnabled = enabled;
     yawControlKnown = true;
+    triggerUpdate();
 }
 
 /**
@@ -696,6 +757,7 @@ void HSIDisplay::updateLocalization(UASInterface* uas, int fix)
     positionFix = fix;
     positionFixKnown = true;
     //qDebug() << "LOCALIZATION FIX CALLED";
+    triggerUpdate();
 }
 /**
  * @param fix 0: lost, 1: at least one satellite, but no GPS fix, 2: 2D localization, 3: 3D localization
@@ -705,6 +767,7 @@ void HSIDisplay::updateGpsLocalization(UASInterface* uas, int fix)
     Q_UNUSED(uas);
     gpsFix = fix;
     gpsFixKnown = true;
+    triggerUpdate();
 }
 /**
  * @param fix 0: lost, 1: 2D local position hold, 2: 2D localization, 3: 3D localization
@@ -715,6 +778,7 @@ void HSIDisplay::updateVisionLocalization(UASInterface* uas, int fix)
     visionFix = fix;
     visionFixKnown = true;
     //qDebug() << "VISION FIX GOT CALLED";
+    triggerUpdate();
 }
 
 /**
@@ -725,6 +789,7 @@ void HSIDisplay::updateInfraredUltrasoundLocalization(UASInterface* uas, int fix
     Q_UNUSED(uas);
     iruFix = fix;
     iruFixKnown = true;
+    triggerUpdate();
 }
 
 QColor HSIDisplay::getColorForSNR(float snr)
@@ -877,17 +942,8 @@ void HSIDisplay::drawGPS(QPainter &painter)
         i.next();
         GPSSatellite* sat = i.value();
 
-        // Check if update is not older than 5 seconds, else delete satellite
-        if (sat->lastUpdate + 1000000 < currTime) {
-            // Delete and go to next satellite
-            gpsSatellites.remove(i.key());
-            if (i.hasNext()) {
-                i.next();
-                sat = i.value();
-            } else {
-                continue;
-            }
-        }
+        // Skip satellites without update in the last second, removeStaleSatellites() deletes them
+        if (sat->lastUpdate + 1000000 < currTime) continue;
 
         if (sat) {
             // Draw satellite
@@ -1024,24 +1080,22 @@ void HSIDisplay::wheelEvent(QWheelEvent* event)
     }
     metricWidth = qBound(0.1, metricWidth, 9999.0);
     emit metricWidthChanged(metricWidth);
+    triggerUpdate();
 }
 
 void HSIDisplay::showEvent(QShowEvent* event)
 {
     // React only to internal (pre-display)
     // events
-    Q_UNUSED(event) {
-        refreshTimer->start(updateInterval);
-    }
+    Q_UNUSED(event);
+    triggerUpdate();
 }
 
 void HSIDisplay::hideEvent(QHideEvent* event)
 {
     // React only to internal (post-display)
     // events
-    Q_UNUSED(event) {
-        refreshTimer->stop();
-    }
+    Q_UNUSED(event);
 }
 
 void HSIDisplay::updateJoystick(double roll, double pitch, double yaw, double thrust, int xHat, int yHat)
@@ -55,6 +55,8 @@ public slots:
     /** @brief Set the width in meters this widget shows from top */
     void setMetricWidth(double width);
     void updateSatellite(int uasid, int satid, float azimuth, float direction, float snr, bool used);
+    /** @brief The waypoint list or one of its waypoints changed */
+    void updateWaypoints();
     void updateAttitudeSetpoints(UASInterface*, double rollDesired, double pitchDesired, double yawDesired, double thrustDesired, quint64 usec);
     void updateAttitude(UASInterface* uas, double roll, double pitch, double yaw, quint64 time);
     void updatePositionSetpoints(int uasid, float xDesired, float yDesired, float zDesired, float yawDesired, quint64 usec);
@@ -90,6 +92,8 @@ signals:
 
 protected slots:
     void renderOverlay();
+    /** @brief Remove satellites without recent update */
+    void removeStaleSatellites();
     void drawGPS(QPainter &painter);
     void drawObjects(QPainter &painter);
     void drawPositionDirection(float xRef, float yRef, float radius, const QColor& color, QPainter* painter);
@@ -169,6 +173,7 @@ protected:
     };
 
     QMap<int, GPSSatellite*> gpsSatellites;
+    QTimer satelliteTimer;    ///< Checks for stale satellites while any are shown
     unsigned int satellitesUsed;
 
     // Current controller values
@@ -45,6 +45,7 @@ This file is part of the QGROUNDCONTROL project
 #include "HUD.h"
 #include "MG.h"
 #include "QGC.h"
+#include "QGCFrameScheduler.h"
 
 // Fix for some platforms, e.g. windows
 #ifndef GL_MULTISAMPLE
@@ -86,12 +87,6 @@ HUD::HUD(int width, int height, QWidget* parent)
       vheight(150.0f),
       vGaugeSpacing(50.0f),
       vPitchPerDeg(6.0f), ///< 4 mm y translation per degree)
-      rawBuffer1(NULL),
-      rawBuffer2(NULL),
-      rawImage(NULL),
-      rawLastIndex(0),
-      rawExpectedBytes(0),
-      bytesPerLine(1),
       imageStarted(false),
       receivedDepth(8),
       receivedChannels(1),
@@ -104,12 +99,13 @@ HUD::HUD(int width, int height, QWidget* parent)
       infoColor(QColor(20, 200, 20)),
       fuelColor(criticalColor),
       warningBlinkRate(5),
-      refreshTimer(new QTimer(this)),
       noCamera(true),
       hardwareAcceleration(true),
       strongStrokeWidth(1.5f),
       normalStrokeWidth(1.0f),
       fineStrokeWidth(0.5f),
+      pitchLadderWidth(40.0f),
+      layerScalingFactor(0.0),
       waypointName(""),
       roll(0.0f),
       pitch(0.0f),
@@ -134,9 +130,7 @@ HUD::HUD(int width, int height, QWidget* parent)
       offlineDirectory(""),
       nextOfflineImage(""),
       hudInstrumentsEnabled(true),
-      videoEnabled(false),
-      xImageFactor(1.0),
-      yImageFactor(1.0)
+      videoEnabled(false)
 {
     // Set auto fill to false
     setAutoFillBackground(false);
@@ -160,10 +154,8 @@ HUD::HUD(int width, int height, QWidget* parent)
 
     //glImage = QGLWidget::convertToGLFormat(fill);
 
-    // Refresh timer
-    refreshTimer->setInterval(updateInterval);
-    //connect(refreshTimer, SIGNAL(timeout()), this, SLOT(update()));
-    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(paintHUD()));
+    // Repaint through the central frame scheduler
+    QGCFrameScheduler::instance()->registerWidget(this, updateInterval, "paintHUD");
 
     // Resize to correct size and fill with image
     //glDrawPixels(glImage.width(), glImage.height(), GL_RGBA, GL_UNSIGNED_BYTE, glImage.bits());
@@ -201,7 +193,8 @@ HUD::HUD(int width, int height, QWidget* parent)
 
 HUD::~HUD()
 {
-    refreshTimer->stop();
+    makeCurrent();
+    videoTexture.release();
 }
 
 QSize HUD::sizeHint() const
@@ -214,15 +207,13 @@ void HUD::showEvent(QShowEvent* event)
     // React only to internal (pre-display)
     // events
     Q_UNUSED(event)
-    refreshTimer->start(updateInterval);
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::hideEvent(QHideEvent* event)
 {
-    // React only to internal (pre-display)
-    // events
+    // Hidden widgets are skipped by the frame scheduler
     Q_UNUSED(event);
-    refreshTimer->stop();
 }
 
 void HUD::contextMenuEvent (QContextMenuEvent* event)
@@ -325,6 +316,7 @@ void HUD::updateAttitude(UASInterface* uas, double roll, double pitch, double ya
     this->roll = roll;
     this->pitch = pitch;
     this->yaw = yaw;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::updateBattery(UASInterface* uas, double voltage, double percent, int seconds)
@@ -338,6 +330,7 @@ void HUD::updateBattery(UASInterface* uas, double voltage, double percent, int s
     } else {
         fuelColor = infoColor;
     }
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::receiveHeartbeat(UASInterface*)
@@ -358,6 +351,7 @@ void HUD::updateLocalPosition(UASInterface* uas,double x,double y,double z,quint
     this->xPos = x;
     this->yPos = y;
     this->zPos = z;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::updateGlobalPosition(UASInterface* uas,double lat, double lon, double altitude, quint64 timestamp)
@@ -367,6 +361,7 @@ void HUD::updateGlobalPosition(UASInterface* uas,double lat, double lon, double
     this->lat = lat;
     this->lon = lon;
     this->alt = altitude;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::updateSpeed(UASInterface* uas,double x,double y,double z,quint64 timestamp)
@@ -379,6 +374,7 @@ void HUD::updateSpeed(UASInterface* uas,double x,double y,double z,quint64 times
     double newTotalSpeed = sqrt(xSpeed*xSpeed + ySpeed*ySpeed + zSpeed*zSpeed);
     totalAcc = (newTotalSpeed - totalSpeed) / ((double)(lastSpeedUpdate - timestamp)/1000.0);
     totalSpeed = newTotalSpeed;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 /**
@@ -392,6 +388,7 @@ void HUD::updateState(UASInterface* uas,QString state)
     // Only one UAS is connected at a time
     Q_UNUSED(uas);
     this->state = state;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 /**
@@ -406,6 +403,7 @@ void HUD::updateMode(int id,QString mode, QString description)
     Q_UNUSED(id);
     Q_UNUSED(description);
     this->mode = mode;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::updateLoad(UASInterface* uas, double load)
@@ -664,22 +662,22 @@ void HUD::paintHUD()
         if (videoEnabled) {
             if (nextOfflineImage != "" && QFileInfo(nextOfflineImage).exists()) {
                 qDebug() << __FILE__ << __LINE__ << "template image:" << nextOfflineImage;
-                QImage fill = QImage(nextOfflineImage);
-
-                xImageFactor = width() / (float)fill.width();
-                yImageFactor = height() / (float)fill.height();
-
-                glImage = QGLWidget::convertToGLFormat(fill);
+                videoTexture.upload(QImage(nextOfflineImage));
 
                 // Reset to save load efforts
                 nextOfflineImage = "";
             }
 
-            glRasterPos2i(0, 0);
+            // Upload the newest streamed frame, if any arrived since the last paint
+            const QImage* frame = frames.takePendingFrame();
+            if (frame) {
+                videoTexture.upload(*frame);
+                frames.markUploaded();
+            }
 
-            glPixelZoom(xImageFactor, yImageFactor);
             // Resize to correct size and fill with image
-            glDrawPixels(glImage.width(), glImage.height(), GL_RGBA, GL_UNSIGNED_BYTE, glImage.bits());
+            videoTexture.draw(width(), height());
+            frames.markDisplayed();
         } else {
             // Blue / brown background
             paintCenterBackground(roll, pitch, yawTrans);
@@ -696,10 +694,19 @@ void HUD::paintHUD()
 
             // QT PAINTING
             //makeCurrent();
+            // Re-render the cached layers only if the size changed
+            if (layerScalingFactor != scalingFactor || staticLayer.size() != size()) {
+                renderStaticLayers();
+            }
+
             QPainter painter;
             painter.begin(this);
             painter.setRenderHint(QPainter::Antialiasing, true);
             painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
+
+            // All fixed indicators and instrument frames
+            painter.drawPixmap(0, 0, staticLayer);
+
             painter.translate((this->vwidth/2.0+xCenterOffset)*scalingFactor, (this->vheight/2.0+yCenterOffset)*scalingFactor);
 
 
@@ -714,72 +721,20 @@ void HUD::paintHUD()
             paintText(state, infoColor, 2.0f, (-vwidth/2.0) + 10, -vheight/2.0 + 15, &painter);
             // BATTERY
             paintText(fuelStatus, fuelColor, 2.0f, (-vwidth/2.0) + 10, -vheight/2.0 + 20, &painter);
+            // VIDEO
+            if (videoEnabled && frames.getCompletedFrames() > 0) {
+                const QGCVideoFramePool::Latency& latency = frames.getLatency(QGCVideoFramePool::STAGE_TOTAL);
+                QString videoStatus = tr("VIDEO %1 ms, %2 dropped, %3 incomplete")
+                                      .arg(latency.mean(), 0, 'f', 0)
+                                      .arg(frames.getDroppedFrames())
+                                      .arg(frames.getIncompleteFrames());
+                paintText(videoStatus, infoColor, 2.0f, (-vwidth/2.0) + 10, -vheight/2.0 + 25, &painter);
+            }
             // Waypoint
             paintText(waypointName, defaultColor, 2.0f, (-vwidth/3.0) + 10, +vheight/3.0 + 15, &painter);
 
-            // YAW INDICATOR
-            //
-            //      .
-            //    .   .
-            //   .......
-            //
-            const float yawIndicatorWidth = 4.0f;
-            const float yawIndicatorY = vheight/2.0f - 10.0f;
-            QPolygon yawIndicator(4);
-            yawIndicator.setPoint(0, QPoint(refToScreenX(0.0f), refToScreenY(yawIndicatorY)));
-            yawIndicator.setPoint(1, QPoint(refToScreenX(yawIndicatorWidth/2.0f), refToScreenY(yawIndicatorY+yawIndicatorWidth)));
-            yawIndicator.setPoint(2, QPoint(refToScreenX(-yawIndicatorWidth/2.0f), refToScreenY(yawIndicatorY+yawIndicatorWidth)));
-            yawIndicator.setPoint(3, QPoint(refToScreenX(0.0f), refToScreenY(yawIndicatorY)));
-            painter.setPen(defaultColor);
-            painter.drawPolyline(yawIndicator);
-
-            // CENTER
-
-            // HEADING INDICATOR
-            //
-            //    __      __
-            //       \/\/
-            //
-            const float hIndicatorWidth = 7.0f;
-            const float hIndicatorY = -25.0f;
-            const float hIndicatorYLow = hIndicatorY + hIndicatorWidth / 6.0f;
-            const float hIndicatorSegmentWidth = hIndicatorWidth / 7.0f;
-            QPolygon hIndicator(7);
-            hIndicator.setPoint(0, QPoint(refToScreenX(0.0f-hIndicatorWidth/2.0f), refToScreenY(hIndicatorY)));
-            hIndicator.setPoint(1, QPoint(refToScreenX(0.0f-hIndicatorWidth/2.0f+hIndicatorSegmentWidth*1.75f), refToScreenY(hIndicatorY)));
-            hIndicator.setPoint(2, QPoint(refToScreenX(0.0f-hIndicatorSegmentWidth*1.0f), refToScreenY(hIndicatorYLow)));
-            hIndicator.setPoint(3, QPoint(refToScreenX(0.0f), refToScreenY(hIndicatorY)));
-            hIndicator.setPoint(4, QPoint(refToScreenX(0.0f+hIndicatorSegmentWidth*1.0f), refToScreenY(hIndicatorYLow)));
-            hIndicator.setPoint(5, QPoint(refToScreenX(0.0f+hIndicatorWidth/2.0f-hIndicatorSegmentWidth*1.75f), refToScreenY(hIndicatorY)));
-            hIndicator.setPoint(6, QPoint(refToScreenX(0.0f+hIndicatorWidth/2.0f), refToScreenY(hIndicatorY)));
-            painter.setPen(defaultColor);
-            painter.drawPolyline(hIndicator);
-
-
-            // SETPOINT
-            const float centerWidth = 4.0f;
-            painter.setPen(defaultColor);
-            painter.setBrush(Qt::NoBrush);
-            // TODO
-            //painter.drawEllipse(QPointF(refToScreenX(qMin(10.0f, values.value("roll desired", 0.0f) * 10.0f)), refToScreenY(qMin(10.0f, values.value("pitch desired", 0.0f) * 10.0f))), refToScreenX(centerWidth/2.0f), refToScreenX(centerWidth/2.0f));
-
-            const float centerCrossWidth = 10.0f;
-            // left
-            painter.drawLine(QPointF(refToScreenX(-centerWidth / 2.0f), refToScreenY(0.0f)), QPointF(refToScreenX(-centerCrossWidth / 2.0f), refToScreenY(0.0f)));
-            // right
-            painter.drawLine(QPointF(refToScreenX(centerWidth / 2.0f), refToScreenY(0.0f)), QPointF(refToScreenX(centerCrossWidth / 2.0f), refToScreenY(0.0f)));
-            // top
-            painter.drawLine(QPointF(refToScreenX(0.0f), refToScreenY(-centerWidth / 2.0f)), QPointF(refToScreenX(0.0f), refToScreenY(-centerCrossWidth / 2.0f)));
-
-
-
             // COMPASS
             const float compassY = -vheight/2.0f + 10.0f;
-            QRectF compassRect(QPointF(refToScreenX(-5.0f), refToScreenY(compassY)), QSizeF(refToScreenX(10.0f), refToScreenY(5.0f)));
-            painter.setBrush(Qt::NoBrush);
-            painter.setPen(Qt::SolidLine);
-            painter.setPen(defaultColor);
-            painter.drawRoundedRect(compassRect, 2, 2);
             QString yawAngle;
 
             //    const float yawDeg = ((values.value("yaw", 0.0f)/M_PI)*180.0f)+180.f;
@@ -791,10 +746,10 @@ void HUD::paintHUD()
             paintText(yawAngle, defaultColor, 3.5f, -4.3f, compassY+ 0.97f, &painter);
 
             // CHANGE RATE STRIPS
-            drawChangeRateStrip(-51.0f, -50.0f, 15.0f, -1.0f, 1.0f, -zSpeed, &painter);
+            drawChangeRateStrip(-51.0f, -50.0f, 15.0f, -1.0f, 1.0f, -zSpeed, &painter, false);
 
             // CHANGE RATE STRIPS
-            drawChangeRateStrip(49.0f, -50.0f, 15.0f, -1.0f, 1.0f, totalAcc, &painter);
+            drawChangeRateStrip(49.0f, -50.0f, 15.0f, -1.0f, 1.0f, totalAcc, &painter, false);
 
             // GAUGES
 
@@ -807,10 +762,10 @@ void HUD::paintHUD()
                 gaugeAltitude = -zPos;
             }
 
-            drawChangeIndicatorGauge(-vGaugeSpacing, -15.0f, 10.0f, 2.0f, gaugeAltitude, defaultColor, &painter, false);
+            drawChangeIndicatorGauge(-vGaugeSpacing, -15.0f, 10.0f, 2.0f, gaugeAltitude, defaultColor, &painter, false, false);
 
             // Right speed gauge
-            drawChangeIndicatorGauge(vGaugeSpacing, -15.0f, 10.0f, 5.0f, totalSpeed, defaultColor, &painter, false);
+            drawChangeIndicatorGauge(vGaugeSpacing, -15.0f, 10.0f, 5.0f, totalSpeed, defaultColor, &painter, false, false);
 
 
             // Waypoint name
@@ -831,12 +786,21 @@ void HUD::paintHUD()
             // PITCH
 
             paintPitchLines(pitchLP, &painter);
+
+            painter.resetTransform();
+            QGCFrameScheduler::instance()->paintOverlay(this, &painter);
             painter.end();
         } else {
             QPainter painter;
             painter.begin(this);
+            QGCFrameScheduler::instance()->paintOverlay(this, &painter);
             painter.end();
         }
+
+        // Keep refreshing until the low-pass filtered attitude has settled
+        if (fabs(rollLP - roll) > 0.001f || fabs(pitchLP - pitch) > 0.001f || fabs(yawLP - yaw) > 0.001f || fabs(yawInt) > 0.001f) {
+            QGCFrameScheduler::instance()->markDirty(this);
+        }
         //glDisable(GL_MULTISAMPLE);
 
 
@@ -845,6 +809,130 @@ void HUD::paintHUD()
     }
 }
 
+void HUD::renderStaticLayers()
+{
+    layerScalingFactor = scalingFactor;
+
+    staticLayer = QPixmap(size());
+    staticLayer.fill(Qt::transparent);
+
+    QPainter painter;
+    painter.begin(&staticLayer);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
+    painter.translate((this->vwidth/2.0+xCenterOffset)*scalingFactor, (this->vheight/2.0+yCenterOffset)*scalingFactor);
+
+    // COORDINATE FRAME IS NOW (0,0) at CENTER OF WIDGET
+
+    // YAW INDICATOR
+    //
+    //      .
+    //    .   .
+    //   .......
+    //
+    const float yawIndicatorWidth = 4.0f;
+    const float yawIndicatorY = vheight/2.0f - 10.0f;
+    QPolygon yawIndicator(4);
+    yawIndicator.setPoint(0, QPoint(refToScreenX(0.0f), refToScreenY(yawIndicatorY)));
+    yawIndicator.setPoint(1, QPoint(refToScreenX(yawIndicatorWidth/2.0f), refToScreenY(yawIndicatorY+yawIndicatorWidth)));
+    yawIndicator.setPoint(2, QPoint(refToScreenX(-yawIndicatorWidth/2.0f), refToScreenY(yawIndicatorY+yawIndicatorWidth)));
+    yawIndicator.setPoint(3, QPoint(refToScreenX(0.0f), refToScreenY(yawIndicatorY)));
+    painter.setPen(defaultColor);
+    painter.drawPolyline(yawIndicator);
+
+    // CENTER
+
+    // HEADING INDICATOR
+    //
+    //    __      __
+    //       \/\/
+    //
+    const float hIndicatorWidth = 7.0f;
+    const float hIndicatorY = -25.0f;
+    const float hIndicatorYLow = hIndicatorY + hIndicatorWidth / 6.0f;
+    const float hIndicatorSegmentWidth = hIndicatorWidth / 7.0f;
+    QPolygon hIndicator(7);
+    hIndicator.setPoint(0, QPoint(refToScreenX(0.0f-hIndicatorWidth/2.0f), refToScreenY(hIndicatorY)));
+    hIndicator.setPoint(1, QPoint(refToScreenX(0.0f-hIndicatorWidth/2.0f+hIndicatorSegmentWidth*1.75f), refToScreenY(hIndicatorY)));
+    hIndicator.setPoint(2, QPoint(refToScreenX(0.0f-hIndicatorSegmentWidth*1.0f), refToScreenY(hIndicatorYLow)));
+    hIndicator.setPoint(3, QPoint(refToScreenX(0.0f), refToScreenY(hIndicatorY)));
+    hIndicator.setPoint(4, QPoint(refToScreenX(0.0f+hIndicatorSegmentWidth*1.0f), refToScreenY(hIndicatorYLow)));
+    hIndicator.setPoint(5, QPoint(refToScreenX(0.0f+hIndicatorWidth/2.0f-hIndicatorSegmentWidth*1.75f), refToScreenY(hIndicatorY)));
+    hIndicator.setPoint(6, QPoint(refToScreenX(0.0f+hIndicatorWidth/2.0f), refToScreenY(hIndicatorY)));
+    painter.setPen(defaultColor);
+    painter.drawPolyline(hIndicator);
+
+
+    // SETPOINT
+    const float centerWidth = 4.0f;
+    painter.setPen(defaultColor);
+    painter.setBrush(Qt::NoBrush);
+    // TODO
+    //painter.drawEllipse(QPointF(refToScreenX(qMin(10.0f, values.value("roll desired", 0.0f) * 10.0f)), refToScreenY(qMin(10.0f, values.value("pitch desired", 0.0f) * 10.0f))), refToScreenX(centerWidth/2.0f), refToScreenX(centerWidth/2.0f));
+
+    const float centerCrossWidth = 10.0f;
+    // left
+    painter.drawLine(QPointF(refToScreenX(-centerWidth / 2.0f), refToScreenY(0.0f)), QPointF(refToScreenX(-centerCrossWidth / 2.0f), refToScreenY(0.0f)));
+    // right
+    painter.drawLine(QPointF(refToScreenX(centerWidth / 2.0f), refToScreenY(0.0f)), QPointF(refToScreenX(centerCrossWidth / 2.0f), refToScreenY(0.0f)));
+    // top
+    painter.drawLine(QPointF(refToScreenX(0.0f), refToScreenY(-centerWidth / 2.0f)), QPointF(refToScreenX(0.0f), refToScreenY(-centerCrossWidth / 2.0f)));
+
+    // COMPASS
+    const float compassY = -vheight/2.0f + 10.0f;
+    QRectF compassRect(QPointF(refToScreenX(-5.0f), refToScreenY(compassY)), QSizeF(refToScreenX(10.0f), refToScreenY(5.0f)));
+    painter.setBrush(Qt::NoBrush);
+    painter.setPen(Qt::SolidLine);
+    painter.setPen(defaultColor);
+    painter.drawRoundedRect(compassRect, 2, 2);
+
+    // CHANGE RATE STRIPS
+    drawChangeRateStripFrame(-51.0f, -50.0f, 15.0f, &painter);
+    drawChangeRateStripFrame(49.0f, -50.0f, 15.0f, &painter);
+
+    // GAUGES
+    drawChangeIndicatorGaugeFrame(-vGaugeSpacing, -15.0f, 10.0f, defaultColor, &painter, false);
+    drawChangeIndicatorGaugeFrame(vGaugeSpacing, -15.0f, 10.0f, defaultColor, &painter, false);
+
+    painter.end();
+
+    renderPitchLadder();
+}
+
+/**
+ * The ladder is rendered once in screen pixels with the horizon at the vertical
+ * center. Each frame only blits it with the current roll / pitch transformation,
+ * which the OpenGL paint engine does from a cached texture.
+ */
+void HUD::renderPitchLadder()
+{
+    const float lineDistance = 5.0f; ///< One pitch line every 5 degrees
+    const float posIncrement = vPitchPerDeg * lineDistance;
+    // Cover the diagonal plus the maximum pitch offset, as paintPitchLines() does
+    const float posLimit = sqrt(pow(vwidth, 2.0f) + pow(vheight, 2.0f)) + vPitchPerDeg * M_PI;
+    const int lines = (int)ceil(posLimit / posIncrement);
+    const float halfHeight = lines * posIncrement + posIncrement / 2.0f;
+
+    pitchLadder = QPixmap(qMax(1, (int)ceil(refToScreenX(pitchLadderWidth))), qMax(1, (int)ceil(refToScreenY(2.0f * halfHeight))));
+    pitchLadder.fill(Qt::transparent);
+
+    QPainter painter;
+    painter.begin(&pitchLadder);
+    painter.setRenderHint(QPainter::Antialiasing, true);
+    painter.setRenderHint(QPainter::HighQualityAntialiasing, true);
+    // Ladder center is the horizon
+    painter.translate(pitchLadder.width() / 2.0, pitchLadder.height() / 2.0);
+    painter.setPen(defaultColor);
+
+    QString label;
+    for (int i = 1; i <= lines; ++i) {
+        const int deg = (int)(i * lineDistance);
+        paintPitchLinePos(label.sprintf("%3d", deg), 0.0f, -i * posIncrement, &painter);
+        paintPitchLineNeg(label.sprintf("%3d", -deg), 0.0f, i * posIncrement, &painter);
+    }
+    painter.end();
+}
+
 /*
 void HUD::paintGL()
 {
@@ -1046,41 +1134,13 @@ void HUD::paintGL()
  */
 void HUD::paintPitchLines(float pitch, QPainter* painter)
 {
-    QString label;
+    const float offsetAbs = pitch * vPitchPerDeg;
 
-    const float yDeg = vPitchPerDeg;
-    const float lineDistance = 5.0f; ///< One pitch line every 10 degrees
-    const float posIncrement = yDeg * lineDistance;
-    float posY = posIncrement;
-    const float posLimit = sqrt(pow(vwidth, 2.0f) + pow(vheight, 2.0f));
-
-    const float offsetAbs = pitch * yDeg;
-
-    float offset = pitch;
-    if (offset < 0) offset = -offset;
-    int offsetCount = 0;
-    while (offset > lineDistance) {
-        offset -= lineDistance;
-        offsetCount++;
+    // Pitch ladder rungs and labels from the layer cache
+    if (pitchLadder.isNull() || layerScalingFactor != scalingFactor) {
+        renderStaticLayers();
     }
-
-    int iPos = (int)(0.5f + lineDistance); ///< The first line
-    int iNeg = (int)(-0.5f - lineDistance); ///< The first line
-
-    offset *= yDeg;
-
-
-    painter->setPen(defaultColor);
-
-    posY = -offsetAbs + posIncrement; //+ 100;// + lineDistance;
-
-    while (posY < posLimit) {
-        paintPitchLinePos(label.sprintf("%3d", iPos), 0.0f, -posY, painter);
-        posY += posIncrement;
-        iPos += (int)lineDistance;
-    }
-
-
+    painter->drawPixmap(QPointF(-pitchLadder.width() / 2.0, refToScreenY(offsetAbs) - pitchLadder.height() / 2.0), pitchLadder);
 
     // HORIZON
     //
@@ -1096,19 +1156,6 @@ void HUD::paintPitchLines(float pitch, QPainter* painter)
     drawLine(0.0f-diagonal, offsetAbs, 0.0f-pitchGap/2.0f, offsetAbs, lineWidth, horizonColor, painter);
     // Right horizon
     drawLine(0.0f+pitchGap/2.0f, offsetAbs, 0.0f+diagonal, offsetAbs, lineWidth, horizonColor, painter);
-
-
-
-    label.clear();
-
-    posY = offsetAbs  + posIncrement;
-
-
-    while (posY < posLimit) {
-        paintPitchLineNeg(label.sprintf("%3d", iNeg), 0.0f, posY, painter);
-        posY += posIncrement;
-        iNeg -= (int)lineDistance;
-    }
 }
 
 void HUD::paintPitchLinePos(QString text, float refPosX, float refPosY, QPainter* painter)
@@ -1235,7 +1282,30 @@ void HUD::drawPolygon(QPolygonF refPolygon, QPainter* painter)
     painter->drawPolygon(draw);
 }
 
-void HUD::drawChangeRateStrip(float xRef, float yRef, float height, float minRate, float maxRate, float value, QPainter* painter)
+void HUD::drawChangeRateStripFrame(float xRef, float yRef, float height, QPainter* painter)
+{
+    QBrush brush(defaultColor, Qt::NoBrush);
+    painter->setBrush(brush);
+    QPen rectPen(Qt::SolidLine);
+    rectPen.setWidth(0);
+    rectPen.setColor(defaultColor);
+    painter->setPen(rectPen);
+
+    const float width = height / 8.0f;
+    const float lineWidth = 0.5f;
+
+    // Indicator lines
+    // Top horizontal line
+    drawLine(xRef, yRef, xRef+width, yRef, lineWidth, defaultColor, painter);
+    // Vertical main line
+    drawLine(xRef+width/2.0f, yRef, xRef+width/2.0f, yRef+height, lineWidth, defaultColor, painter);
+    // Zero mark
+    drawLine(xRef, yRef+height/2.0f, xRef+width, yRef+height/2.0f, lineWidth, defaultColor, painter);
+    // Horizontal bottom line
+    drawLine(xRef, yRef+height, xRef+width, yRef+height, lineWidth, defaultColor, painter);
+}
+
+void HUD::drawChangeRateStrip(float xRef, float yRef, float height, float minRate, float maxRate, float value, QPainter* painter, bool withFrame)
 {
     QBrush brush(defaultColor, Qt::NoBrush);
     painter->setBrush(brush);
@@ -1262,17 +1332,9 @@ void HUD::drawChangeRateStrip(float xRef, float yRef, float height, float minRat
     //           -
 
     const float width = height / 8.0f;
-    const float lineWidth = 0.5f;
 
-    // Indicator lines
-    // Top horizontal line
-    drawLine(xRef, yRef, xRef+width, yRef, lineWidth, defaultColor, painter);
-    // Vertical main line
-    drawLine(xRef+width/2.0f, yRef, xRef+width/2.0f, yRef+height, lineWidth, defaultColor, painter);
-    // Zero mark
-    drawLine(xRef, yRef+height/2.0f, xRef+width, yRef+height/2.0f, lineWidth, defaultColor, painter);
-    // Horizontal bottom line
-    drawLine(xRef, yRef+height, xRef+width, yRef+height, lineWidth, defaultColor, painter);
+    // Indicator lines, cached in the static layer if not drawn here
+    if (withFrame) drawChangeRateStripFrame(xRef, yRef, height, painter);
 
     // Text
     QString label;
@@ -1357,7 +1419,7 @@ void HUD::drawChangeRateStrip(float xRef, float yRef, float height, float minRat
 //    }
 //}
 
-void HUD::drawChangeIndicatorGauge(float xRef, float yRef, float radius, float expectedMaxChange, float value, const QColor& color, QPainter* painter, bool solid)
+void HUD::drawChangeIndicatorGaugeFrame(float xRef, float yRef, float radius, const QColor& color, QPainter* painter, bool solid)
 {
     // Draw the circle
     QPen circlePen(Qt::SolidLine);
@@ -1367,6 +1429,12 @@ void HUD::drawChangeIndicatorGauge(float xRef, float yRef, float radius, float e
     painter->setBrush(Qt::NoBrush);
     painter->setPen(circlePen);
     drawCircle(xRef, yRef, radius, 200.0f, 170.0f, 1.0f, color, painter);
+}
+
+void HUD::drawChangeIndicatorGauge(float xRef, float yRef, float radius, float expectedMaxChange, float value, const QColor& color, QPainter* painter, bool solid, bool withFrame)
+{
+    // Circle, cached in the static layer if not drawn here
+    if (withFrame) drawChangeIndicatorGaugeFrame(xRef, yRef, radius, color, painter, solid);
 
     QString label;
     label.sprintf("%05.1f", value);
@@ -1442,51 +1510,19 @@ void HUD::selectWaypoint(int uasId, int id)
 {
     Q_UNUSED(uasId);
     waypointName = tr("WP") + QString::number(id);
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::setImageSize(int width, int height, int depth, int channels)
 {
-    // Allocate raw image in correct size
-    if (width != receivedWidth || height != receivedHeight || depth != receivedDepth || channels != receivedChannels || image == NULL) {
-        // Set new size
-        if (width > 0) receivedWidth  = width;
-        if (height > 0) receivedHeight = height;
-        if (depth > 1) receivedDepth = depth;
-        if (channels > 1) receivedChannels = channels;
-
-        rawExpectedBytes = (receivedWidth * receivedHeight * receivedDepth * receivedChannels) / 8;
-        bytesPerLine = rawExpectedBytes / receivedHeight;
-        // Delete old buffers if necessary
-        rawImage = NULL;
-        if (rawBuffer1 != NULL) delete rawBuffer1;
-        if (rawBuffer2 != NULL) delete rawBuffer2;
-
-        rawBuffer1 = (unsigned char*)malloc(rawExpectedBytes);
-        rawBuffer2 = (unsigned char*)malloc(rawExpectedBytes);
-        rawImage = rawBuffer1;
-        // TODO check if old image should be deleted
-
-        // Set image format
-        // 8 BIT GREYSCALE IMAGE
-        if (depth <= 8 && channels == 1) {
-            image = new QImage(receivedWidth, receivedHeight, QImage::Format_Indexed8);
-            // Create matching color table
-            image->setNumColors(256);
-            for (int i = 0; i < 256; i++) {
-                image->setColor(i, qRgb(i, i, i));
-                //qDebug() << __FILE__ << __LINE__ << std::hex << i;
-            }
-
-        }
-        // 32 BIT COLOR IMAGE WITH ALPHA VALUES (#ARGB)
-        else {
-            image = new QImage(receivedWidth, receivedHeight, QImage::Format_ARGB32);
-        }
-
-        // Fill first channel of image with black pixels
-        image->fill(0);
-        glImage = QGLWidget::convertToGLFormat(*image);
-
+    // Set new size
+    if (width > 0) receivedWidth  = width;
+    if (height > 0) receivedHeight = height;
+    if (depth > 1) receivedDepth = depth;
+    if (channels > 1) receivedChannels = channels;
+
+    // Buffers are only reallocated if the geometry changed
+    if (frames.setFormat(receivedWidth, receivedHeight, receivedDepth, receivedChannels)) {
         qDebug() << __FILE__ << __LINE__ << "Setting up image";
 
         // Set size once
@@ -1497,7 +1533,6 @@ void HUD::setImageSize(int width, int height, int depth, int channels)
         //setSizePolicy(QSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed));
         //resize(receivedWidth, receivedHeight);
     }
-
 }
 
 void HUD::startImage(int imgid, int width, int height, int depth, int channels)
@@ -1510,6 +1545,7 @@ void HUD::startImage(int imgid, int width, int height, int depth, int channels)
 
     // Reset image size if necessary
     setImageSize(width, height, depth, channels);
+    frames.beginFrame();
     imageStarted = true;
 }
 
@@ -1523,37 +1559,14 @@ void HUD::finishImage()
 
 void HUD::commitRawDataToGL()
 {
-    qDebug() << __FILE__ << __LINE__ << "Copying raw data to GL buffer:" << rawImage << receivedWidth << receivedHeight << image->format();
-    if (image != NULL) {
-        QImage::Format format = image->format();
-        QImage* newImage = new QImage(rawImage, receivedWidth, receivedHeight, format);
-        if (format == QImage::Format_Indexed8) {
-            // Create matching color table
-            newImage->setNumColors(256);
-            for (int i = 0; i < 256; i++) {
-                newImage->setColor(i, qRgb(i, i, i));
-                //qDebug() << __FILE__ << __LINE__ << std::hex << i;
-            }
-        }
-
-        glImage = QGLWidget::convertToGLFormat(*newImage);
-        delete image;
-        image = newImage;
-        // Switch buffers
-        if (rawImage == rawBuffer1) {
-            rawImage = rawBuffer2;
-            //qDebug() << "Now buffer 2";
-        } else {
-            rawImage = rawBuffer1;
-            //qDebug() << "Now buffer 1";
-        }
-    }
-    update();
+    frames.commitFrame();
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::saveImage(QString fileName)
 {
-    image->save(fileName);
+    const QImage* image = frames.displayedFrame();
+    if (image) image->save(fileName);
 }
 
 void HUD::saveImage()
@@ -1568,6 +1581,7 @@ void HUD::startImage(quint64 timestamp)
     if (videoEnabled && offlineDirectory != "") {
         // Load and diplay image file
         nextOfflineImage = QString(offlineDirectory + "/%1.bmp").arg(timestamp);
+        QGCFrameScheduler::instance()->markDirty(this);
     }
 }
 
@@ -1582,11 +1596,13 @@ void HUD::selectOfflineDirectory()
 void HUD::enableHUDInstruments(bool enabled)
 {
     hudInstrumentsEnabled = enabled;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::enableVideo(bool enabled)
 {
     videoEnabled = enabled;
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void HUD::setPixels(int imgid, const unsigned char* imageData, int length, int startIndex)
@@ -1594,32 +1610,9 @@ void HUD::setPixels(int imgid, const unsigned char* imageData, int length, int s
     Q_UNUSED(imgid);
     //    qDebug() << "at" << __FILE__ << __LINE__ << ": Received startindex" << startIndex << "and length" << length << "(" << startIndex+length << "of" << rawExpectedBytes << "bytes)";
 
-    if (imageStarted) {
-        //if (rawLastIndex != startIndex) qDebug() << "PACKET LOSS!";
-
-        if (startIndex+length > rawExpectedBytes) {
-            qDebug() << "HUD: OVERFLOW! startIndex:" << startIndex << "length:" << length << "image raw size" << ((receivedWidth * receivedHeight * receivedChannels * receivedDepth) / 8) - 1;
-        } else {
-            memcpy(rawImage+startIndex, imageData, length);
-
-            rawLastIndex = startIndex+length;
-
-            // Check if we just reached the end of the image
-            if (startIndex+length == rawExpectedBytes) {
-                //qDebug() << "HUD: END OF IMAGE REACHED!";
-                finishImage();
-                rawLastIndex = 0;
-            }
-        }
-
-        //        for (int i = 0; i < length; i++)
-        //        {
-        //            for (int j = 0; j < receivedChannels; j++)
-        //            {
-        //                unsigned int x = (startIndex+i) % receivedWidth;
-        //                unsigned int y = (unsigned int)((startIndex+i) / receivedWidth);
-        //                qDebug() << "Setting pixel" << x << "," << y << "to" << (unsigned int)*(rawImage+startIndex+i);
-        //            }
-        //        }
+    // Copy the chunk directly into the frame buffer, it is displayed from there
+    if (imageStarted && frames.writePixels(imageData, length, startIndex)) {
+        //qDebug() << "HUD: END OF IMAGE REACHED!";
+        finishImage();
     }
 }
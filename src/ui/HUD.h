@@ -33,11 +33,14 @@ This file is part of the QGROUNDCONTROL project
 #define HUD_H
 
 #include <QImage>
+#include <QPixmap>
 #include <QGLWidget>
 #include <QPainter>
 #include <QFontDatabase>
 #include <QTimer>
 #include "UASInterface.h"
+#include "QGCVideoFramePool.h"
+#include "QGCVideoTexture.h"
 
 /**
  * @brief Displays a Head Up Display (HUD)
@@ -55,6 +58,10 @@ public:
 
     void setImageSize(int width, int height, int depth, int channels);
     void resizeGL(int w, int h);
+    /** @brief Frame buffers and latency counters of the video stream */
+    const QGCVideoFramePool& getFramePool() const {
+        return frames;
+    }
 
 public slots:
     void initializeGL();
@@ -106,13 +113,19 @@ protected slots:
     void drawEllipse(float refX, float refY, float radiusX, float radiusY, float startDeg, float endDeg, float lineWidth, const QColor& color, QPainter* painter);
     void drawCircle(float refX, float refY, float radius, float startDeg, float endDeg, float lineWidth, const QColor& color, QPainter* painter);
 
-    void drawChangeRateStrip(float xRef, float yRef, float height, float minRate, float maxRate, float value, QPainter* painter);
-    void drawChangeIndicatorGauge(float xRef, float yRef, float radius, float expectedMaxChange, float value, const QColor& color, QPainter* painter, bool solid=true);
+    void drawChangeRateStrip(float xRef, float yRef, float height, float minRate, float maxRate, float value, QPainter* painter, bool withFrame=true);
+    void drawChangeRateStripFrame(float xRef, float yRef, float height, QPainter* painter);
+    void drawChangeIndicatorGauge(float xRef, float yRef, float radius, float expectedMaxChange, float value, const QColor& color, QPainter* painter, bool solid=true, bool withFrame=true);
+    void drawChangeIndicatorGaugeFrame(float xRef, float yRef, float radius, const QColor& color, QPainter* painter, bool solid=true);
 
     void drawPolygon(QPolygonF refPolygon, QPainter* painter);
 
 protected:
     void commitRawDataToGL();
+    /** @brief Render all instrument parts which do not change between frames into the layer caches */
+    void renderStaticLayers();
+    /** @brief Render the pitch ladder rungs and labels into the ladder cache */
+    void renderPitchLadder();
     /** @brief Convert reference coordinates to screen coordinates */
     float refToScreenX(float x);
     /** @brief Convert reference coordinates to screen coordinates */
@@ -132,8 +145,6 @@ protected:
 
     static const int updateInterval = 40;
 
-    QImage* image; ///< Double buffer image
-    QImage glImage; ///< The background / camera image
     UASInterface* uas; ///< The uas currently monitored
     float yawInt; ///< The yaw integral. Used to damp the yaw indication.
     QString mode; ///< The current vehicle mode
@@ -150,12 +161,8 @@ protected:
     int yCenter; ///< Center of the HUD instrument in pixel coordinates. Allows to off-center the whole instrument in its OpenGL window, e.g. to fit another instrument
 
     // Image buffers
-    unsigned char* rawBuffer1; ///< Double buffer 1 for the image
-    unsigned char* rawBuffer2; ///< Double buffer 2 for the image
-    unsigned char* rawImage;   ///< Pointer to current complete image
-    int rawLastIndex;          ///< The last byte index received of the image
-    int rawExpectedBytes;      ///< Number of raw image bytes expected. Calculated by: image depth * channels * widht * height / 8
-    int bytesPerLine;          ///< Bytes per image line. Is calculated as: image depth * channels * width / 8
+    QGCVideoFramePool frames;  ///< Reusable frame buffers, the stream is received directly into them
+    QGCVideoTexture videoTexture; ///< The background / camera image, updated in place
     bool imageStarted;         ///< If an image is currently in transmission
     int receivedDepth;         ///< Image depth in bit for the current image
     int receivedChannels;      ///< Number of color channels
@@ -173,8 +180,11 @@ protected:
     // Blink rates
     int warningBlinkRate;      ///< Blink rate of warning messages, will be rounded to the refresh rate
 
-    QTimer* refreshTimer;      ///< The main timer, controls the update rate
     QPainter* hudPainter;
+    QPixmap staticLayer;       ///< Fixed indicators and instrument frames, rendered once per size change
+    QPixmap pitchLadder;       ///< Pitch ladder rungs and labels, the horizon is at the vertical center
+    float pitchLadderWidth;    ///< Width of the pitch ladder cache in reference units
+    double layerScalingFactor; ///< Scaling factor the layer caches were rendered with
     QFont font;                ///< The HUD font, per default the free Bitstream Vera SANS, which is very close to actual HUD fonts
     QFontDatabase fontDatabase;///< Font database, only used to load the TrueType font file (the HUD font is directly loaded from file rather than from the system)
     bool noCamera;             ///< No camera images available, draw the ground/sky box to indicate the horizon
@@ -209,8 +219,6 @@ protected:
     QString nextOfflineImage;
     bool hudInstrumentsEnabled;
     bool videoEnabled;
-    float xImageFactor;
-    float yImageFactor;
     QAction* enableHUDAction;
     QAction* enableVideoAction;
     QAction* selectOfflineDirectoryAction;
@@ -20,6 +20,7 @@
 #include "UASInterface.h"
 #include "UASManager.h"
 #include "MAV2DIcon.h"
+#include "MAV2DTrail.h"
 #include "Waypoint2DIcon.h"
 #include "UASWaypointManager.h"
 
@@ -32,6 +33,7 @@ MapWidget::MapWidget(QWidget *parent) :
     zoomLevel(0),
     uasIcons(),
     uasTrails(),
+    trailMemory(32*1024*1024),
     mav(NULL),
     lastUpdate(0),
     initialized(false),
@@ -157,6 +159,26 @@ void MapWidget::init()
         mapMenu->addSeparator();
         //    mapMenu->addAction(yahooActionOverlay);
 
+        // Offline operation from the tile cache
+        offlineAction = new QAction(tr("Offline (cached maps only)"), this);
+        offlineAction->setCheckable(true);
+        settings.beginGroup("QGC_MAPWIDGET");
+        offlineAction->setChecked(settings.value("OFFLINE", false).toBool());
+        settings.endGroup();
+        mc->setOfflineMode(offlineAction->isChecked());
+        connect(offlineAction, SIGNAL(toggled(bool)), this, SLOT(setOfflineMode(bool)));
+        mapMenu->addAction(offlineAction);
+
+        // Flight trails, their memory is shared by all MAVs
+        trailAction = new QAction(tr("Show flight trails"), this);
+        trailAction->setCheckable(true);
+        settings.beginGroup("QGC_MAPWIDGET");
+        trailAction->setChecked(settings.value("TRAILS", true).toBool());
+        trailMemory = settings.value("TRAIL_MEMORY_MB", 32).toInt() * 1024 * 1024;
+        settings.endGroup();
+        connect(trailAction, SIGNAL(toggled(bool)), this, SLOT(setTrailsVisible(bool)));
+        mapMenu->addAction(trailAction);
+
         mapButton = new QPushButton(this);
         mapButton->setText("Map Source");
         mapButton->setMenu(mapMenu);
@@ -297,6 +319,29 @@ void MapWidget::goTo()
 }
 
 
+void MapWidget::setOfflineMode(bool offline)
+{
+    mc->setOfflineMode(offline);
+
+    QSettings settings;
+    settings.beginGroup("QGC_MAPWIDGET");
+    settings.setValue("OFFLINE", offline);
+    settings.endGroup();
+}
+
+void MapWidget::setTrailsVisible(bool visible)
+{
+    foreach (MAV2DTrail* trail, uasTrails) {
+        trail->setVisible(visible);
+    }
+    if (isVisible()) mc->updateRequestNew();
+
+    QSettings settings;
+    settings.beginGroup("QGC_MAPWIDGET");
+    settings.setValue("TRAILS", visible);
+    settings.endGroup();
+}
+
 void MapWidget::mapproviderSelected(QAction* action)
 {
     if (mc) {
@@ -822,58 +867,36 @@ void MapWidget::updateGlobalPosition(UASInterface* uas, double lat, double lon,
     Q_UNUSED(usec);
     Q_UNUSED(alt); // FIXME Use altitude
     if (mc) {
-        // create a LineString
-        //QList<Point*> points;
-        // Points with a circle
-        // A QPen can be used to customize the
-        //pointpen->setWidth(3);
-        //points.append(new CirclePoint(lat, lon, 10, uas->getUASName(), Point::Middle, pointpen));
-
         qmapcontrol::Point* p;
-        QPointF coordinate;
-        coordinate.setX(lon);
-        coordinate.setY(lat);
 
         if (!uasIcons.contains(uas->getUASID())) {
-            // Get the UAS color
-            QColor uasColor = uas->getColor();
+            // Trail, added first so that the icon is drawn on top of it
+            QPen* linepen = new QPen(uas->getColor().darker());
+            linepen->setWidth(2);
+            MAV2DTrail* trail = new MAV2DTrail(uas->getUASID(), linepen);
+            trail->setVisible(trailAction->isChecked());
+            uasTrails.insert(uas->getUASID(), trail);
+            mc->layer("Waypoints")->addGeometry(trail);
+
+            // All trails share the same memory budget
+            foreach (MAV2DTrail* t, uasTrails) {
+                t->setMemoryLimit(trailMemory / uasTrails.count());
+            }
 
             // Icon
-            //QPen* pointpen = new QPen(uasColor);
             qDebug() << "2D MAP: ADDING" << uas->getUASName() << __FILE__ << __LINE__;
             p = new MAV2DIcon(uas, 68, uas->getSystemType(), uas->getColor(), QString("%1").arg(uas->getUASID()), qmapcontrol::Point::Middle);
             uasIcons.insert(uas->getUASID(), p);
             mc->layer("Waypoints")->addGeometry(p);
-
-            // Line
-            // A QPen also can use transparency
-
-            //        QList<qmapcontrol::Point*> points;
-            //        points.append(new qmapcontrol::Point(coordinate.x(), coordinate.y()));
-            //        QPen* linepen = new QPen(uasColor.darker());
-            //        linepen->setWidth(2);
-
-            //        // Create tracking line string
-            //        qmapcontrol::LineString* ls = new qmapcontrol::LineString(points, QString("%1").arg(uas->getUASID()), linepen);
-            //        uasTrails.insert(uas->getUASID(), ls);
-
-            //        // Add the LineString to the layer
-            //        mc->layer("Waypoints")->addGeometry(ls);
         } else {
-            //        p = dynamic_cast<MAV2DIcon*>(uasIcons.value(uas->getUASID()));
-            //        if (p)
-            //        {
             p = uasIcons.value(uas->getUASID());
             p->setCoordinate(QPointF(lon, lat));
-            //p->setYaw(uas->getYaw());
-            //        }
-            // Extend trail
-            //        uasTrails.value(uas->getUASID())->addPoint(new qmapcontrol::Point(coordinate.x(), coordinate.y()));
         }
 
-        if (isVisible()) mc->updateRequest(p->boundingBox().toRect());
+        // Extend trail
+        uasTrails.value(uas->getUASID())->addFix(lat, lon);
 
-        //if (isVisible()) mc->updateRequestNew();//(uasTrails.value(uas->getUASID())->boundingBox().toRect());
+        if (isVisible()) mc->updateRequest(p->boundingBox().toRect());
 
         if (this->mav && uas->getUASID() == this->mav->getUASID()) {
             // Limit the position update rate
@@ -1035,11 +1058,8 @@ void MapWidget::clearPath(int uas)
     Q_UNUSED(uas);
     if (mc) {
         mc->layer("Tracking")->clearGeometries();
-        foreach (qmapcontrol::LineString* ls, uasTrails) {
-            QPen* linepen = ls->pen();
-            delete ls;
-            qmapcontrol::LineString* lsNew = new qmapcontrol::LineString(QList<qmapcontrol::Point*>(), "", linepen);
-            mc->layer("Tracking")->addGeometry(lsNew);
+        foreach (MAV2DTrail* trail, uasTrails) {
+            trail->clear();
         }
         // FIXME update this with update request only for bounding box of trails
         if (isVisible()) mc->updateRequestNew();//(QRect(0, 0, width(), height()));
@@ -46,6 +46,7 @@ This file is part of the QGROUNDCONTROL project
 class QMenu;
 class Waypoint;
 class Waypoint2DIcon;
+class MAV2DTrail;
 
 namespace Ui
 {
@@ -115,6 +116,8 @@ protected:
     QAction* yahooActionOverlay;
     QAction* googleActionMap;
     QAction* googleSatAction;
+    QAction* offlineAction;  ///< Serve map tiles only from the cache
+    QAction* trailAction;    ///< Show the flight trails of all MAVs
 
 
     QPushButton* followgps;
@@ -142,7 +145,8 @@ protected:
     //Layer* gSatLayer;
 
     QMap<int, qmapcontrol::Point*> uasIcons;
-    QMap<int, qmapcontrol::LineString*> uasTrails;
+    QMap<int, MAV2DTrail*> uasTrails;
+    int trailMemory;                  ///< Memory shared by all trails, in bytes
     QMap<int, QPen*> mavPens;
     //QMap<int, QList<qmapcontrol::Point*> > mavWps;
     //QMap<int, qmapcontrol::LineString*> waypointPaths;
@@ -164,6 +168,10 @@ protected slots:
     /** @brief Create the graphic representation of the waypoint */
     void createWaypointGraphAtMap(int id, const QPointF coordinate);
     void mapproviderSelected(QAction* action);
+    /** @brief Disable network access for map tiles, only cached tiles are shown */
+    void setOfflineMode(bool offline);
+    /** @brief Show or hide the flight trails */
+    void setTrailsVisible(bool visible);
 
 signals:
     //void movePoint(QPointF newCoord);
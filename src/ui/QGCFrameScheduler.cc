@@ -0,0 +1,236 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the central repaint scheduler for instrument widgets
+ *
+ */
+
+#include <QApplication>
+#include <QEvent>
+#include <QWidget>
+#include <QPainter>
+#include <QSettings>
+#include <QTime>
+#include "QGCFrameScheduler.h"
+#include "MG.h"
+
+#define QGC_FRAMESCHEDULER_KEY QString("QGC_FRAMESCHEDULER_")
+
+/**
+ * This class follows the singleton design pattern
+ * @see http://en.wikipedia.org/wiki/Singleton_pattern
+ * A call to this function thus returns the only instance of this object
+ * the call can occur at any place in the code, no reference to the
+ * QGCFrameScheduler object has to be passed.
+ */
+QGCFrameScheduler* QGCFrameScheduler::instance()
+{
+    static QGCFrameScheduler* _instance = 0;
+    if(_instance == 0) {
+        _instance = new QGCFrameScheduler();
+        // Set the application as parent to ensure that this object
+        // will be destroyed when the main application exits
+        _instance->setParent(qApp);
+    }
+    return _instance;
+}
+
+QGCFrameScheduler::QGCFrameScheduler(QObject* parent) : QObject(parent),
+    lastFrame(0),
+    slowdown(1.0f),
+    overlayEnabled(false)
+{
+    QSettings settings;
+    settings.sync();
+    overlayEnabled = settings.value(QGC_FRAMESCHEDULER_KEY+"overlay", overlayEnabled).toBool();
+
+    frameTimer.setInterval(frameInterval);
+    connect(&frameTimer, SIGNAL(timeout()), this, SLOT(renderFrame()));
+}
+
+void QGCFrameScheduler::registerWidget(QWidget* widget, int minInterval, const char* refreshSlot, bool continuous)
+{
+    if (!widget) return;
+
+    Client client;
+    client.widget = widget;
+    client.slot = QByteArray(refreshSlot);
+    client.minInterval = minInterval;
+    client.continuous = continuous;
+    client.dirty = true;
+    client.lastRefresh = 0;
+    client.paintTime = 0.0f;
+    client.maxPaintTime = 0;
+    client.frames = 0;
+    client.skipped = 0;
+
+    if (!clients.contains(widget)) {
+        connect(widget, SIGNAL(destroyed(QObject*)), this, SLOT(unregisterWidget(QObject*)));
+        widget->installEventFilter(this);
+    }
+    clients.insert(widget, client);
+
+    wake();
+}
+
+void QGCFrameScheduler::unregisterWidget(QObject* widget)
+{
+    clients.remove(widget);
+    if (clients.isEmpty()) frameTimer.stop();
+}
+
+void QGCFrameScheduler::markDirty(QWidget* widget)
+{
+    QHash<QObject*, Client>::iterator i = clients.find(widget);
+    if (i == clients.end()) return;
+
+    Client& client = i.value();
+    if (client.dirty && (!widget->isVisible() || widget->visibleRegion().isEmpty())) {
+        // The pending refresh is replaced without ever being shown
+        client.skipped++;
+    }
+    client.dirty = true;
+    wake();
+}
+
+void QGCFrameScheduler::wake()
+{
+    if (frameTimer.isActive()) return;
+    // The idle time before this frame is no event loop latency
+    lastFrame = 0;
+    frameTimer.start();
+}
+
+bool QGCFrameScheduler::eventFilter(QObject* object, QEvent* event)
+{
+    if (event->type() == QEvent::Show) {
+        QHash<QObject*, Client>::const_iterator i = clients.constFind(object);
+        if (i != clients.constEnd() && (i.value().dirty || i.value().continuous)) wake();
+    }
+    return QObject::eventFilter(object, event);
+}
+
+void QGCFrameScheduler::setOverlayEnabled(bool enabled)
+{
+    overlayEnabled = enabled;
+
+    QSettings settings;
+    settings.setValue(QGC_FRAMESCHEDULER_KEY+"overlay", overlayEnabled);
+    settings.sync();
+
+    // Repaint everything to show / remove the overlay
+    QMutableHashIterator<QObject*, Client> i(clients);
+    while (i.hasNext()) {
+        i.next();
+        i.value().dirty = true;
+    }
+    wake();
+    emit overlayEnabledChanged(enabled);
+}
+
+void QGCFrameScheduler::renderFrame()
+{
+    const quint64 now = MG::TIME::getGroundTimeNow();
+    // A late timer means the event loop is busy with other work
+    int latency = 0;
+    if (lastFrame != 0) latency = qMax(0, (int)(now - lastFrame) - frameInterval);
+    lastFrame = now;
+
+    QTime frameTime;
+    frameTime.start();
+
+    // Visible widgets still waiting for a refresh after this frame
+    bool pending = false;
+
+    QMutableHashIterator<QObject*, Client> i(clients);
+    while (i.hasNext()) {
+        i.next();
+        Client& client = i.value();
+        if (!client.dirty && !client.continuous) continue;
+
+        // Keep the widget dirty, it is refreshed as soon as it is shown or marked dirty again
+        if (!client.widget->isVisible() || client.widget->visibleRegion().isEmpty()) continue;
+
+        if (now - client.lastRefresh < (quint64)(client.minInterval * slowdown)) {
+            pending = true;
+            continue;
+        }
+
+        QTime paintTime;
+        paintTime.start();
+        if (!client.slot.isEmpty()) {
+            QMetaObject::invokeMethod(client.widget, client.slot.constData(), Qt::DirectConnection);
+        } else {
+            client.widget->repaint();
+        }
+        const int elapsed = paintTime.elapsed();
+
+        client.paintTime = client.paintTime * 0.9f + elapsed * 0.1f;
+        client.maxPaintTime = qMax(client.maxPaintTime, elapsed);
+        client.frames++;
+        client.dirty = false;
+        client.lastRefresh = now;
+        if (client.continuous) pending = true;
+    }
+
+    // Stretch all refresh intervals if the frame used up the budget,
+    // recover slowly once the GUI thread is idle again
+    const int busy = frameTime.elapsed() + latency;
+    if (busy > frameInterval) {
+        slowdown = qMin((float)maxSlowdown, slowdown * 1.25f);
+    } else if (busy < frameInterval / 4) {
+        slowdown = qMax(1.0f, slowdown * 0.95f);
+    }
+
+    // Nothing left to paint, markDirty() and showing a widget restart the timer
+    if (!pending) frameTimer.stop();
+}
+
+void QGCFrameScheduler::paintOverlay(QWidget* widget, QPainter* painter)
+{
+    if (!overlayEnabled || !painter) return;
+
+    QHash<QObject*, Client>::const_iterator i = clients.constFind(widget);
+    if (i == clients.constEnd()) return;
+
+    const Client& client = i.value();
+    QString text = QString("%1 ms avg, %2 ms max, %3 frames, %4 skipped, x%5")
+                   .arg(client.paintTime, 0, 'f', 1)
+                   .arg(client.maxPaintTime)
+                   .arg(client.frames)
+                   .arg(client.skipped)
+                   .arg(slowdown, 0, 'f', 2);
+
+    painter->save();
+    QFont font = painter->font();
+    font.setPixelSize(10);
+    painter->setFont(font);
+    QRect rect = painter->fontMetrics().boundingRect(text).adjusted(-2, -2, 2, 2);
+    rect.moveTopLeft(QPoint(0, 0));
+    painter->fillRect(rect, QColor(0, 0, 0, 160));
+    painter->setPen(Qt::yellow);
+    painter->drawText(rect, Qt::AlignCenter, text);
+    painter->restore();
+}
@@ -0,0 +1,126 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the central repaint scheduler for instrument widgets
+ *
+ */
+
+#ifndef QGCFRAMESCHEDULER_H
+#define QGCFRAMESCHEDULER_H
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+#include <QByteArray>
+
+class QWidget;
+class QPainter;
+
+/**
+ * @brief Central frame scheduler for the instrument widgets
+ *
+ * Instead of running one refresh timer per widget, widgets register here and
+ * mark themselves dirty when new data arrives. All repaints are coalesced into
+ * one frame per frame interval. Widgets that are hidden (e.g. in an inactive
+ * dock tab) or fully covered are skipped until they become visible again, and
+ * all refresh intervals are stretched if painting saturates the GUI thread.
+ * The frame timer only runs while a visible widget has a refresh pending.
+ *
+ * This class follows the singleton design pattern
+ * @see http://en.wikipedia.org/wiki/Singleton_pattern
+ */
+class QGCFrameScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    /** @brief Get the singleton instance */
+    static QGCFrameScheduler* instance();
+
+    /**
+     * @brief Register a widget for scheduled repaints
+     *
+     * @param widget the widget to refresh
+     * @param minInterval minimum time between two refreshes, in milliseconds
+     * @param refreshSlot normalized slot name (e.g. "paintHUD") invoked instead of repaint(), can be NULL
+     * @param continuous refresh even if the widget was not marked dirty, e.g. for animations
+     */
+    void registerWidget(QWidget* widget, int minInterval, const char* refreshSlot=0, bool continuous=false);
+    /** @brief Mark the widget for repaint in the next possible frame */
+    void markDirty(QWidget* widget);
+    /** @brief Paint the statistics of this widget, to be called at the end of its paint routine */
+    void paintOverlay(QWidget* widget, QPainter* painter);
+    /** @brief Check if the paint time overlay is shown */
+    bool isOverlayEnabled() const {
+        return overlayEnabled;
+    }
+    /** @brief Current factor all refresh intervals are stretched with, 1 if the CPU is not saturated */
+    float getSlowdown() const {
+        return slowdown;
+    }
+
+public slots:
+    /** @brief Remove a widget from the schedule */
+    void unregisterWidget(QObject* widget);
+    /** @brief Show / hide the paint time overlay */
+    void setOverlayEnabled(bool enabled);
+
+signals:
+    void overlayEnabledChanged(bool enabled);
+
+protected slots:
+    /** @brief Refresh all dirty and visible widgets which are due */
+    void renderFrame();
+
+protected:
+    QGCFrameScheduler(QObject* parent=0);
+    /** @brief Restart the frame timer when a widget is shown again */
+    bool eventFilter(QObject* object, QEvent* event);
+    /** @brief Start the frame timer if it is idle */
+    void wake();
+
+    /** @brief Book keeping for one registered widget */
+    struct Client {
+        QWidget* widget;        ///< The registered widget
+        QByteArray slot;        ///< Slot to call instead of repaint(), empty for repaint()
+        int minInterval;        ///< Minimum refresh interval in milliseconds
+        bool continuous;        ///< Refresh even when not dirty
+        bool dirty;             ///< New data arrived since the last refresh
+        quint64 lastRefresh;    ///< Time of the last refresh, milliseconds since epoch
+        float paintTime;        ///< Low-pass filtered paint time in milliseconds
+        int maxPaintTime;       ///< Maximum paint time in milliseconds
+        quint64 frames;         ///< Number of refreshes
+        quint64 skipped;        ///< Number of dirty refreshes dropped because the widget was not visible
+    };
+
+    QHash<QObject*, Client> clients; ///< All registered widgets
+    QTimer frameTimer;               ///< Triggers the frames
+    static const int frameInterval = 16; ///< Frame budget in milliseconds, roughly one frame per vsync
+    static const int maxSlowdown = 8;    ///< Maximum factor the refresh intervals are stretched with
+    quint64 lastFrame;               ///< Time of the last frame, used to measure the event loop latency
+    float slowdown;                  ///< Current stretch factor of all refresh intervals
+    bool overlayEnabled;             ///< Paint the statistics overlay
+};
+
+#endif // QGCFRAMESCHEDULER_H
@@ -8,6 +8,7 @@
 #include "MAVLinkProtocol.h"
 #include "MAVLinkSettingsWidget.h"
 #include "GAudioOutput.h"
+#include "QGCFrameScheduler.h"
 
 //, Qt::WindowFlags flags
 
@@ -55,6 +56,10 @@ QGCSettingsWidget::QGCSettingsWidget(QWidget *parent, Qt::WindowFlags flags) :
     connect(ui->indoorStyle, SIGNAL(clicked()), MainWindow::instance(), SLOT(loadIndoorStyle()));
     connect(ui->outdoorStyle, SIGNAL(clicked()), MainWindow::instance(), SLOT(loadOutdoorStyle()));
 
+    // Instrument paint time overlay
+    ui->paintTimeOverlayCheckBox->setChecked(QGCFrameScheduler::instance()->isOverlayEnabled());
+    connect(ui->paintTimeOverlayCheckBox, SIGNAL(toggled(bool)), QGCFrameScheduler::instance(), SLOT(setOverlayEnabled(bool)));
+
     // Close / destroy
     connect(ui->buttonBox, SIGNAL(accepted()), this, SLOT(deleteLater()));
 
@@ -0,0 +1,220 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the frame pool used for streamed camera images
+ *
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <QDebug>
+
+#include "QGCVideoFramePool.h"
+#include "MG.h"
+
+void QGCVideoFramePool::Latency::add(quint64 value)
+{
+    if (samples == 0 || value < min) min = value;
+    if (samples == 0 || value > max) max = value;
+    last = value;
+    total += value;
+    samples++;
+}
+
+QGCVideoFramePool::QGCVideoFramePool() :
+    width(0),
+    height(0),
+    depth(0),
+    channels(0),
+    expectedBytes(0),
+    filling(-1),
+    ready(-1),
+    shown(-1),
+    completed(0),
+    displayed(0),
+    dropped(0),
+    incomplete(0)
+{
+    grayTable.resize(256);
+    for (int i = 0; i < 256; i++) {
+        grayTable[i] = qRgb(i, i, i);
+    }
+}
+
+QGCVideoFramePool::~QGCVideoFramePool()
+{
+    releaseBuffers();
+}
+
+void QGCVideoFramePool::releaseBuffers()
+{
+    for (int i = 0; i < frameCount; i++) {
+        // Drop the image first, it references the buffer
+        frames[i].image = QImage();
+        free(frames[i].buffer);
+        frames[i] = Frame();
+    }
+}
+
+bool QGCVideoFramePool::setFormat(int width, int height, int depth, int channels)
+{
+    if (width <= 0 || height <= 0 || depth <= 0 || channels <= 0) return false;
+    if (width == this->width && height == this->height && depth == this->depth && channels == this->channels) return false;
+
+    releaseBuffers();
+
+    this->width = width;
+    this->height = height;
+    this->depth = depth;
+    this->channels = channels;
+    expectedBytes = (width * height * depth * channels) / 8;
+    filling = -1;
+    ready = -1;
+    shown = -1;
+
+    // 8 BIT GREYSCALE IMAGE, else 32 BIT COLOR IMAGE WITH ALPHA VALUES (#ARGB)
+    bool gray = (depth <= 8 && channels == 1);
+    QImage::Format format = gray ? QImage::Format_Indexed8 : QImage::Format_ARGB32;
+    int bytesPerLine = gray ? width : width * 4;
+    // Never let the image read past the received data
+    int bufferBytes = qMax(expectedBytes, bytesPerLine * height);
+
+    for (int i = 0; i < frameCount; i++) {
+        frames[i].buffer = static_cast<unsigned char*>(malloc(bufferBytes));
+        memset(frames[i].buffer, 0, bufferBytes);
+        frames[i].image = QImage(frames[i].buffer, width, height, bytesPerLine, format);
+        if (gray) frames[i].image.setColorTable(grayTable);
+    }
+
+    qDebug() << __FILE__ << __LINE__ << "Allocated" << frameCount << "video frames of" << width << "x" << height << "pixels";
+    return true;
+}
+
+int QGCVideoFramePool::freeFrame() const
+{
+    for (int i = 0; i < frameCount; i++) {
+        if (i != filling && i != ready && i != shown) return i;
+    }
+    return -1;
+}
+
+void QGCVideoFramePool::beginFrame()
+{
+    if (expectedBytes == 0) return;
+
+    if (filling >= 0) {
+        // The previous frame never completed, reuse its buffer
+        incomplete++;
+    } else {
+        filling = freeFrame();
+    }
+    frames[filling].received = 0;
+    frames[filling].firstPacket = MG::TIME::getGroundTimeNow();
+}
+
+bool QGCVideoFramePool::writePixels(const unsigned char* data, int length, int startIndex)
+{
+    if (filling < 0) return false;
+
+    if (startIndex < 0 || length < 0 || startIndex + length > expectedBytes) {
+        qDebug() << "VIDEO: OVERFLOW! startIndex:" << startIndex << "length:" << length << "image raw size" << expectedBytes;
+        return false;
+    }
+
+    memcpy(frames[filling].buffer + startIndex, data, length);
+    frames[filling].received += length;
+
+    // Check if we just reached the end of the image
+    return (startIndex + length == expectedBytes);
+}
+
+void QGCVideoFramePool::commitFrame()
+{
+    if (filling < 0) return;
+
+    Frame& frame = frames[filling];
+    frame.completed = MG::TIME::getGroundTimeNow();
+    latency[STAGE_RECEIVE].add(frame.completed - frame.firstPacket);
+    completed++;
+    // Frames with lost packets are still shown, but counted
+    if (frame.received < expectedBytes) incomplete++;
+
+    // A complete frame which was never displayed is superseded
+    if (ready >= 0) dropped++;
+    ready = filling;
+    filling = -1;
+}
+
+const QImage* QGCVideoFramePool::takePendingFrame()
+{
+    if (ready < 0) return NULL;
+
+    // The frame on screen goes back to the pool
+    shown = ready;
+    ready = -1;
+
+    Frame& frame = frames[shown];
+    frame.uploadStart = MG::TIME::getGroundTimeNow();
+    frame.uploaded = 0;
+    latency[STAGE_QUEUE].add(frame.uploadStart - frame.completed);
+    return &frame.image;
+}
+
+void QGCVideoFramePool::markUploaded()
+{
+    if (shown < 0 || frames[shown].uploaded != 0) return;
+
+    Frame& frame = frames[shown];
+    frame.uploaded = MG::TIME::getGroundTimeNow();
+    latency[STAGE_UPLOAD].add(frame.uploaded - frame.uploadStart);
+}
+
+void QGCVideoFramePool::markDisplayed()
+{
+    // Only the first time a frame reaches the screen counts
+    if (shown < 0 || frames[shown].firstPacket == 0) return;
+
+    Frame& frame = frames[shown];
+    latency[STAGE_TOTAL].add(MG::TIME::getGroundTimeNow() - frame.firstPacket);
+    frame.firstPacket = 0;
+    displayed++;
+}
+
+const QImage* QGCVideoFramePool::displayedFrame() const
+{
+    if (shown < 0) return NULL;
+    return &frames[shown].image;
+}
+
+void QGCVideoFramePool::resetStatistics()
+{
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        latency[i] = Latency();
+    }
+    completed = 0;
+    displayed = 0;
+    dropped = 0;
+    incomplete = 0;
+}
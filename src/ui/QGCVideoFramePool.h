@@ -0,0 +1,173 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the frame pool used for streamed camera images
+ *
+ */
+
+#ifndef QGCVIDEOFRAMEPOOL_H
+#define QGCVIDEOFRAMEPOOL_H
+
+#include <QImage>
+#include <QVector>
+
+/**
+ * @brief Fixed set of reusable image buffers for raw camera streams
+ *
+ * Image packets are copied straight from the link into the pixel memory
+ * of one of the pooled frames. Each frame is wrapped by a QImage once when
+ * the stream geometry changes, so neither receiving nor displaying a frame
+ * allocates memory. Three frames suffice: one being received, one complete
+ * and waiting for display and one currently on screen. A complete frame
+ * that is superseded before it was displayed is counted as dropped.
+ *
+ * The pool also keeps latency counters for every stage a frame passes from
+ * its first packet to the screen. The HUD shows the total latency and the
+ * dropped and incomplete frames next to its status lines.
+ */
+class QGCVideoFramePool
+{
+public:
+    /** @brief Pipeline stages with latency measurements */
+    enum Stage {
+        STAGE_RECEIVE = 0, ///< First packet until the frame is complete
+        STAGE_QUEUE,       ///< Frame complete until the upload to the GPU starts
+        STAGE_UPLOAD,      ///< Duration of the upload to the GPU
+        STAGE_TOTAL,       ///< First packet until the frame is on screen
+        STAGE_COUNT
+    };
+
+    /** @brief Latency statistics of one stage, all times in milliseconds */
+    struct Latency {
+        Latency() : samples(0), last(0), min(0), max(0), total(0) {}
+        void add(quint64 value);
+        double mean() const {
+            return (samples > 0) ? (double)total / samples : 0.0;
+        }
+        quint64 samples;
+        quint64 last;
+        quint64 min;
+        quint64 max;
+        quint64 total;
+    };
+
+    QGCVideoFramePool();
+    ~QGCVideoFramePool();
+
+    /**
+     * @brief Set the stream geometry
+     *
+     * The buffers are only reallocated if the geometry actually changed.
+     * @return true if the buffers were reallocated
+     */
+    bool setFormat(int width, int height, int depth, int channels);
+    /** @brief Start receiving a new frame, an unfinished previous frame is discarded */
+    void beginFrame();
+    /**
+     * @brief Copy a chunk of image data into the frame being received
+     *
+     * @return true if this chunk completed the frame
+     */
+    bool writePixels(const unsigned char* data, int length, int startIndex);
+    /** @brief Mark the frame being received as complete and ready for display */
+    void commitFrame();
+    /** @brief Check if a complete frame is waiting for display */
+    bool hasPendingFrame() const {
+        return ready >= 0;
+    }
+    /**
+     * @brief Take the newest complete frame for display
+     *
+     * The previously displayed frame is returned to the pool.
+     * @return the frame to upload or NULL if no new frame is available
+     */
+    const QImage* takePendingFrame();
+    /** @brief Report that the upload of the taken frame finished */
+    void markUploaded();
+    /** @brief Report that the taken frame is now on screen */
+    void markDisplayed();
+    /** @brief The frame currently on screen, NULL if none was displayed yet */
+    const QImage* displayedFrame() const;
+
+    bool isReceiving() const {
+        return filling >= 0;
+    }
+    int getExpectedBytes() const {
+        return expectedBytes;
+    }
+    const Latency& getLatency(Stage stage) const {
+        return latency[stage];
+    }
+    quint64 getCompletedFrames() const {
+        return completed;
+    }
+    quint64 getDisplayedFrames() const {
+        return displayed;
+    }
+    quint64 getDroppedFrames() const {
+        return dropped;
+    }
+    quint64 getIncompleteFrames() const {
+        return incomplete;
+    }
+    /** @brief Reset all latency and frame counters */
+    void resetStatistics();
+
+protected:
+    static const int frameCount = 3;
+
+    struct Frame {
+        Frame() : buffer(NULL), received(0), firstPacket(0), completed(0), uploadStart(0), uploaded(0) {}
+        unsigned char* buffer; ///< Pixel memory, owned by the pool
+        QImage image;          ///< Image wrapping the pixel memory
+        int received;          ///< Number of bytes written since the first packet
+        quint64 firstPacket;   ///< Ground time of the first packet
+        quint64 completed;     ///< Ground time the last packet arrived
+        quint64 uploadStart;   ///< Ground time the upload started
+        quint64 uploaded;      ///< Ground time the upload finished
+    };
+
+    /** @brief Find a frame which is neither received, pending nor displayed */
+    int freeFrame() const;
+    void releaseBuffers();
+
+    Frame frames[frameCount];
+    QVector<QRgb> grayTable; ///< Color table shared by all 8 bit frames
+    int width;
+    int height;
+    int depth;
+    int channels;
+    int expectedBytes;       ///< Bytes of one complete frame
+    int filling;             ///< Index of the frame being received, -1 if none
+    int ready;               ///< Index of the newest complete frame, -1 if none
+    int shown;               ///< Index of the frame on screen, -1 if none
+    Latency latency[STAGE_COUNT];
+    quint64 completed;
+    quint64 displayed;
+    quint64 dropped;
+    quint64 incomplete;
+};
+
+#endif // QGCVIDEOFRAMEPOOL_H
@@ -0,0 +1,140 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Implementation of the persistent texture used to display camera frames
+ *
+ */
+
+#include "QGCVideoTexture.h"
+
+// OpenGL 1.2 pixel formats, not defined by all platform headers
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+#ifndef GL_UNSIGNED_INT_8_8_8_8_REV
+#define GL_UNSIGNED_INT_8_8_8_8_REV 0x8367
+#endif
+
+QGCVideoTexture::QGCVideoTexture() :
+    texture(0),
+    textureWidth(0),
+    textureHeight(0),
+    textureFormat(0)
+{
+}
+
+void QGCVideoTexture::upload(const QImage& image)
+{
+    if (image.isNull()) return;
+
+    // Streamed frames are either grayscale or ARGB and are uploaded
+    // in place. Anything else (e.g. logged images) is converted first.
+    const QImage* source = &image;
+    QImage converted;
+    bool gray = (image.format() == QImage::Format_Indexed8 && image.isGrayscale());
+    if (!gray && image.format() != QImage::Format_ARGB32 && image.format() != QImage::Format_RGB32) {
+        converted = image.convertToFormat(QImage::Format_ARGB32);
+        source = &converted;
+    }
+
+    GLenum format = gray ? GL_LUMINANCE : GL_BGRA;
+    GLenum type = gray ? GL_UNSIGNED_BYTE : GL_UNSIGNED_INT_8_8_8_8_REV;
+    int bytesPerPixel = gray ? 1 : 4;
+
+    if (texture == 0) {
+        glGenTextures(1, &texture);
+    }
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, source->bytesPerLine() / bytesPerPixel);
+
+    if (source->width() != textureWidth || source->height() != textureHeight || format != textureFormat) {
+        // Allocate the storage once for this geometry
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+        glTexImage2D(GL_TEXTURE_2D, 0, gray ? GL_LUMINANCE : GL_RGBA, source->width(), source->height(), 0, format, type, source->bits());
+        textureWidth = source->width();
+        textureHeight = source->height();
+        textureFormat = format;
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, textureWidth, textureHeight, format, type, source->bits());
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void QGCVideoTexture::draw(int width, int height)
+{
+    if (texture == 0) return;
+
+    glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_CURRENT_BIT);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glOrtho(0, width, 0, height, -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    glDisable(GL_BLEND);
+    glEnable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+
+    // The first image line is the top of the screen
+    glBegin(GL_QUADS);
+    glTexCoord2f(0.0f, 1.0f);
+    glVertex2i(0, 0);
+    glTexCoord2f(1.0f, 1.0f);
+    glVertex2i(width, 0);
+    glTexCoord2f(1.0f, 0.0f);
+    glVertex2i(width, height);
+    glTexCoord2f(0.0f, 0.0f);
+    glVertex2i(0, height);
+    glEnd();
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glPopMatrix();
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopAttrib();
+}
+
+void QGCVideoTexture::release()
+{
+    if (texture != 0) {
+        glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+    textureWidth = 0;
+    textureHeight = 0;
+    textureFormat = 0;
+}
@@ -0,0 +1,70 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the persistent texture used to display camera frames
+ *
+ */
+
+#ifndef QGCVIDEOTEXTURE_H
+#define QGCVIDEOTEXTURE_H
+
+#include <QImage>
+#include <QGLWidget>
+
+/**
+ * @brief OpenGL texture which is allocated once and updated in place
+ *
+ * Frames are uploaded with glTexSubImage2D straight from the QImage pixel
+ * memory: 8 bit grayscale frames as luminance, 32 bit frames in their native
+ * BGRA layout. This avoids the conversion to the GL image format and the
+ * per-frame image copy. The image is flipped while drawing by the texture
+ * coordinates instead of in memory.
+ *
+ * All methods have to be called with the GL context of the owning widget
+ * current.
+ */
+class QGCVideoTexture
+{
+public:
+    QGCVideoTexture();
+
+    /** @brief Copy the image into the texture, the texture is only reallocated on size or format changes */
+    void upload(const QImage& image);
+    /** @brief Draw the texture stretched over a viewport of the given size */
+    void draw(int width, int height);
+    /** @brief Delete the GL texture */
+    void release();
+    bool isValid() const {
+        return texture != 0;
+    }
+
+protected:
+    GLuint texture;         ///< GL texture name, 0 if not allocated
+    int textureWidth;       ///< Width of the allocated texture in pixels
+    int textureHeight;      ///< Height of the allocated texture in pixels
+    GLenum textureFormat;   ///< Pixel format of the allocated texture
+};
+
+#endif // QGCVIDEOTEXTURE_H
@@ -0,0 +1,217 @@
+#include "MAV2DTrail.h"
+#include <QPainter>
+
+#include <qmath.h>
+
+const double MAV2DTrail::minSpacing = 0.00001;
+
+MAV2DTrail::MAV2DTrail(int uasid, QPen* pen, int memoryLimit)
+    : Geometry(QString("%1").arg(uasid)),
+      uasid(uasid),
+      fixes(),
+      capacity(0),
+      stored(0),
+      baseSeq(0),
+      nextSeq(0),
+      bounds(),
+      boundsValid(true),
+      polyline(),
+      vertexSeq(),
+      polylineStart(0),
+      polylineEnd(0),
+      polylineBounds(),
+      polylineZoom(-1),
+      polylineAdapter(NULL)
+{
+    GeometryType = "LineString";
+    mypen = pen;
+    setMemoryLimit(memoryLimit);
+}
+
+MAV2DTrail::~MAV2DTrail()
+{
+}
+
+void MAV2DTrail::addFix(double latitude, double longitude)
+{
+    if (stored > 0) {
+        // Drop fixes that do not move the trail, e.g. while the MAV is hovering
+        const QPointF& last = fix(nextSeq-1);
+        double dx = (longitude - last.x()) * qCos(latitude / 180.0 * M_PI);
+        double dy = latitude - last.y();
+        if (dx*dx + dy*dy < minSpacing*minSpacing) return;
+    }
+
+    if (stored == fixes.size() && fixes.size() < capacity) {
+        // The ring did not wrap yet, grow it instead of dropping a fix
+        if (fixes.size() == fixes.capacity()) {
+            fixes.reserve(qMin(capacity, qMax(int(initialFixes), 2 * fixes.size())));
+        }
+        fixes.append(QPointF(longitude, latitude));
+        stored++;
+    } else {
+        // The oldest fix is overwritten, the bounds may shrink
+        fixes[(nextSeq - baseSeq) % fixes.size()] = QPointF(longitude, latitude);
+        boundsValid = false;
+    }
+    nextSeq++;
+
+    if (boundsValid) {
+        if (stored == 1) {
+            bounds = QRectF(longitude, latitude, 0, 0);
+        } else {
+            bounds.setLeft(qMin(bounds.left(), longitude));
+            bounds.setRight(qMax(bounds.right(), longitude));
+            bounds.setTop(qMin(bounds.top(), latitude));
+            bounds.setBottom(qMax(bounds.bottom(), latitude));
+        }
+    }
+}
+
+void MAV2DTrail::clear()
+{
+    fixes.clear();
+    stored = 0;
+    baseSeq = 0;
+    nextSeq = 0;
+    bounds = QRectF();
+    boundsValid = true;
+    polylineAdapter = NULL;
+    polyline.clear();
+    vertexSeq.clear();
+    polylineStart = 0;
+    polylineEnd = 0;
+    polylineBounds = QRect();
+}
+
+void MAV2DTrail::setMemoryLimit(int bytes)
+{
+    int limit = qMax(2, bytes / bytesPerFix);
+    if (limit == capacity) return;
+    capacity = limit;
+
+    // Keep the newest fixes in order, the ring grows from there when needed
+    int keep = qMin(stored, capacity);
+    QVector<QPointF> resized;
+    resized.reserve(keep);
+    for (quint64 seq = nextSeq - keep; seq < nextSeq; seq++) {
+        resized.append(fix(seq));
+    }
+    if (keep < stored) boundsValid = false;
+    fixes = resized;
+    stored = keep;
+    baseSeq = nextSeq - keep;
+
+    // Polyline vertices may now point at dropped fixes
+    polylineAdapter = NULL;
+}
+
+QRectF MAV2DTrail::boundingBox()
+{
+    if (!boundsValid) {
+        boundsValid = true;
+        bounds = QRectF();
+        for (quint64 seq = nextSeq - stored; seq < nextSeq; seq++) {
+            const QPointF& c = fix(seq);
+            if (seq == nextSeq - stored) {
+                bounds = QRectF(c, QSizeF(0, 0));
+            } else {
+                bounds.setLeft(qMin(bounds.left(), c.x()));
+                bounds.setRight(qMax(bounds.right(), c.x()));
+                bounds.setTop(qMin(bounds.top(), c.y()));
+                bounds.setBottom(qMax(bounds.bottom(), c.y()));
+            }
+        }
+    }
+    return bounds;
+}
+
+bool MAV2DTrail::Touches(qmapcontrol::Point* geom, const qmapcontrol::MapAdapter* mapadapter)
+{
+    Q_UNUSED(geom);
+    Q_UNUSED(mapadapter);
+    // The trail cannot be selected or dragged
+    return false;
+}
+
+QList<qmapcontrol::Point*>& MAV2DTrail::points()
+{
+    return noPoints;
+}
+
+void MAV2DTrail::appendVertex(const qmapcontrol::MapAdapter* mapadapter, quint64 seq)
+{
+    QPoint p = mapadapter->coordinateToDisplay(fix(seq));
+    if (polyline.size() > polylineStart) {
+        QPoint d = p - polyline.last();
+        if (d.x()*d.x() + d.y()*d.y() < pixelTolerance*pixelTolerance) return;
+    }
+    polyline.append(p);
+    vertexSeq.append(seq);
+    polylineBounds |= QRect(p, QSize(1, 1));
+}
+
+void MAV2DTrail::rebuild(const qmapcontrol::MapAdapter* mapadapter)
+{
+    polyline.clear();
+    vertexSeq.clear();
+    polylineStart = 0;
+    polylineBounds = QRect();
+    polylineZoom = mapadapter->currentZoom();
+    polylineAdapter = mapadapter;
+    for (polylineEnd = nextSeq - stored; polylineEnd < nextSeq; polylineEnd++) {
+        appendVertex(mapadapter, polylineEnd);
+    }
+}
+
+void MAV2DTrail::extend(const qmapcontrol::MapAdapter* mapadapter)
+{
+    quint64 oldest = nextSeq - stored;
+    if (polylineAdapter != mapadapter || polylineZoom != mapadapter->currentZoom() || polylineEnd < oldest) {
+        rebuild(mapadapter);
+        return;
+    }
+
+    // Forget the vertices of fixes which dropped out of the ring buffer
+    while (polylineStart < vertexSeq.size() && vertexSeq[polylineStart] < oldest) {
+        polylineStart++;
+    }
+    if (polylineStart > 1024 && polylineStart > vertexSeq.size() / 2) {
+        polyline.remove(0, polylineStart);
+        vertexSeq.remove(0, polylineStart);
+        polylineStart = 0;
+        polylineBounds = polyline.boundingRect();
+    }
+
+    for (; polylineEnd < nextSeq; polylineEnd++) {
+        appendVertex(mapadapter, polylineEnd);
+    }
+}
+
+void MAV2DTrail::draw(QPainter* painter, const qmapcontrol::MapAdapter* mapadapter, const QRect &viewport, const QPoint offset)
+{
+    Q_UNUSED(offset);
+    if (!visible || stored < 2) return;
+
+    extend(mapadapter);
+
+    // Always end at the latest fix, even if it was too close to the last vertex
+    QPoint head = mapadapter->coordinateToDisplay(fix(nextSeq-1));
+    int penWidth = mypen ? qMax(1, mypen->width()) : 1;
+    QRect area = (polylineBounds | QRect(head, QSize(1, 1))).adjusted(-penWidth, -penWidth, penWidth, penWidth);
+    if (!viewport.intersects(area)) return;
+
+    bool tail = (vertexSeq.isEmpty() || vertexSeq.last() != nextSeq-1);
+    if (tail) polyline.append(head);
+
+    if (mypen != 0) {
+        painter->save();
+        painter->setPen(*mypen);
+    }
+    painter->drawPolyline(polyline.constData() + polylineStart, polyline.size() - polylineStart);
+    if (mypen != 0) {
+        painter->restore();
+    }
+
+    if (tail) polyline.remove(polyline.size()-1);
+}
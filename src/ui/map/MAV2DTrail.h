@@ -0,0 +1,97 @@
+#ifndef MAV2DTRAIL_H
+#define MAV2DTRAIL_H
+
+#include <QPen>
+#include <QPolygon>
+#include <QVector>
+#include "qmapcontrol.h"
+
+/**
+ * @brief Flight trail of one MAV on the 2D map
+ *
+ * The raw position fixes are kept in a ring buffer which grows with the
+ * trail up to the capacity the memory limit allows, so a trail never grows
+ * beyond its memory limit: once it is full, the oldest fixes are dropped.
+ * Fixes closer than minSpacing to the previous one are not stored at all.
+ *
+ * The polyline that is painted is built in map pixels for the current zoom
+ * level and only keeps a vertex if it is at least pixelTolerance away from
+ * the previous one. It is extended with each new fix and only rebuilt from
+ * the raw fixes when the zoom level or the map adapter changes.
+ */
+class MAV2DTrail : public qmapcontrol::Geometry
+{
+public:
+    /*!
+     * @param uasid the id of the tracked system
+     * @param pen QPen for drawing
+     * @param memoryLimit the number of bytes this trail may use
+     */
+    MAV2DTrail(int uasid, QPen* pen=0, int memoryLimit = 1024*1024);
+    virtual ~MAV2DTrail();
+
+    /** @brief Append a position fix to the end of the trail */
+    void addFix(double latitude, double longitude);
+    /** @brief Remove all fixes */
+    void clear();
+    /** @brief Number of raw fixes currently stored */
+    int count() const {
+        return stored;
+    }
+    /** @brief Limit the memory used by this trail, drops the oldest fixes if needed */
+    void setMemoryLimit(int bytes);
+    int memoryLimit() const {
+        return capacity * bytesPerFix;
+    }
+    /** @brief Get system id */
+    int getUASId() const {
+        return uasid;
+    }
+
+    virtual QRectF boundingBox();
+    virtual bool Touches(qmapcontrol::Point* geom, const qmapcontrol::MapAdapter* mapadapter);
+    virtual void draw(QPainter* painter, const qmapcontrol::MapAdapter* mapadapter, const QRect &viewport, const QPoint offset);
+    virtual QList<qmapcontrol::Point*>& points();
+
+    /** @brief Worst case memory needed per fix: the raw fix and its polyline vertex */
+    static const int bytesPerFix = sizeof(QPointF) + sizeof(QPoint) + sizeof(quint64);
+    /** @brief Minimum distance between two stored fixes, in degrees (about 1 m) */
+    static const double minSpacing;
+    /** @brief Minimum distance between two polyline vertices, in pixels */
+    static const int pixelTolerance = 2;
+    /** @brief Number of fixes the ring buffer is first allocated for */
+    static const int initialFixes = 256;
+
+protected:
+    /** @brief Rebuild the polyline from all raw fixes */
+    void rebuild(const qmapcontrol::MapAdapter* mapadapter);
+    /** @brief Append the fixes that were added since the last draw to the polyline */
+    void extend(const qmapcontrol::MapAdapter* mapadapter);
+    /** @brief Append one fix to the polyline if it is far enough from the last vertex */
+    void appendVertex(const qmapcontrol::MapAdapter* mapadapter, quint64 seq);
+    /** @brief Raw fix with the given sequence number, must still be stored */
+    const QPointF& fix(quint64 seq) const {
+        return fixes[(seq - baseSeq) % fixes.size()];
+    }
+
+    int uasid;                  ///< ID of tracked system
+    QVector<QPointF> fixes;     ///< Ring buffer of raw fixes (longitude, latitude)
+    int capacity;               ///< Number of fixes the ring buffer may grow to
+    int stored;                 ///< Number of valid fixes in the ring buffer
+    quint64 baseSeq;            ///< Sequence number of the fix in the first element of the ring
+    quint64 nextSeq;            ///< Sequence number of the next fix
+    QRectF bounds;              ///< Bounding box of the stored fixes
+    bool boundsValid;           ///< False after old fixes were dropped
+
+    QPolygon polyline;          ///< Simplified trail in map pixels
+    QVector<quint64> vertexSeq; ///< Sequence number of the fix behind each vertex
+    int polylineStart;          ///< First vertex whose fix is still stored
+    quint64 polylineEnd;        ///< Sequence number of the next fix to append
+    QRect polylineBounds;       ///< Bounding box of the polyline
+    int polylineZoom;           ///< Zoom level the polyline was built for
+    const qmapcontrol::MapAdapter* polylineAdapter; ///< Map adapter the polyline was built for
+
+    QList<qmapcontrol::Point*> noPoints; ///< A trail has no Point geometries
+};
+
+#endif // MAV2DTRAIL_H
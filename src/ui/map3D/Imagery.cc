@@ -34,6 +34,7 @@ This file is part of the QGROUNDCONTROL project
 #include <cmath>
 #include <iomanip>
 #include <sstream>
+#include <QDesktopServices>
 
 const double WGS84_A = 6378137.0;
 const double WGS84_ECCSQ = 0.00669437999013;
@@ -41,9 +42,15 @@ const double WGS84_ECCSQ = 0.00669437999013;
 const int MAX_ZOOM_LEVEL = 20;
 
 Imagery::Imagery()
-    : textureCache(new TextureCache(1000))
 {
+    // downloaded tiles are kept on disk across restarts
+    QString diskCacheDir =
+        QDesktopServices::storageLocation(QDesktopServices::CacheLocation);
+    if (!diskCacheDir.isEmpty()) {
+        diskCacheDir += "/imagery";
+    }
 
+    textureCache.reset(new TextureCache(1000, 4, diskCacheDir));
 }
 
 Imagery::ImageryType
@@ -237,9 +244,13 @@ Imagery::draw3D(double radius, double tileResolution,
 bool
 Imagery::update(void)
 {
-    textureCache->sync();
+    return textureCache->sync();
+}
 
-    return true;
+bool
+Imagery::isUploading(void) const
+{
+    return textureCache->isUploading();
 }
 
 void
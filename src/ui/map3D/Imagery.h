@@ -70,7 +70,10 @@ public:
                 double xOffset, double yOffset, double zOffset,
                 const QString& utmZone);
 
+    // uploads decoded tiles, returns true while tiles are still on their way
     bool update(void);
+    // true while decoded tiles wait for their upload
+    bool isUploading(void) const;
 
     static void LLtoUTM(double latitude, double longitude,
                         double& utmNorthing, double& utmEasting,
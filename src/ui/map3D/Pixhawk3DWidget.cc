@@ -38,6 +38,9 @@
 #include <osgDB/ReadFile>
 #include <osg/LineWidth>
 #include <osg/ShapeDrawable>
+#ifdef QGC_LIBFREENECT_ENABLED
+#include <QtConcurrentRun>
+#endif
 
 #include "PixhawkCheetahGeode.h"
 #include "UASManager.h"
@@ -56,9 +59,17 @@ Pixhawk3DWidget::Pixhawk3DWidget(QWidget* parent)
     , displayRGBD2D(false)
     , displayRGBD3D(false)
     , enableRGBDColor(true)
+    , enableRGBDFilter(false)
+    , enableOccupancyMap(false)
     , enableTarget(false)
     , followCamera(true)
     , enableFreenect(false)
+#ifdef QGC_LIBFREENECT_ENABLED
+    , rgbdVoxelSize(0.05f)
+    , rgbdSequence(0)
+    , rgbdJobFiltered(false)
+    , rgbdJobAccumulated(false)
+#endif
     , frame(MAV_FRAME_GLOBAL)
     , lastRobotX(0.0f)
     , lastRobotY(0.0f)
@@ -101,6 +112,12 @@ Pixhawk3DWidget::Pixhawk3DWidget(QWidget* parent)
     if (enableFreenect) {
         rgbd3DNode = createRGBD3D();
         egocentricMap->addChild(rgbd3DNode);
+
+        // the occupancy map is kept relative to an origin in the world
+        // frame, like the trails
+        occupancyNode = new osg::MatrixTransform;
+        occupancyNode->addChild(createRGBD3D());
+        rollingMap->addChild(occupancyNode);
     }
 
     setupHUD();
@@ -112,11 +129,23 @@ Pixhawk3DWidget::Pixhawk3DWidget(QWidget* parent)
 
     connect(UASManager::instance(), SIGNAL(activeUASSet(UASInterface*)),
             this, SLOT(setActiveUAS(UASInterface*)));
+
+    // frames are drawn when telemetry arrives, the trails show all systems
+    connect(UASManager::instance(), SIGNAL(UASCreated(UASInterface*)),
+            this, SLOT(addUAS(UASInterface*)));
+    foreach (UASInterface* system, UASManager::instance()->getUASList()) {
+        addUAS(system);
+    }
+
+    // the HUD shows the position of the cursor
+    setMouseTracking(true);
 }
 
 Pixhawk3DWidget::~Pixhawk3DWidget()
 {
-
+#ifdef QGC_LIBFREENECT_ENABLED
+    rgbdFilterJob.waitForFinished();
+#endif
 }
 
 /**
@@ -131,6 +160,20 @@ void Pixhawk3DWidget::setActiveUAS(UASInterface* uas)
     }
 
     this->uas = uas;
+    requestRedraw();
+}
+
+void
+Pixhawk3DWidget::addUAS(UASInterface* system)
+{
+    connect(system, SIGNAL(attitudeChanged(UASInterface*,double,double,double,quint64)),
+            this, SLOT(requestRedraw()));
+    connect(system, SIGNAL(localPositionChanged(UASInterface*,double,double,double,quint64)),
+            this, SLOT(requestRedraw()));
+    connect(system, SIGNAL(globalPositionChanged(UASInterface*,double,double,double,quint64)),
+            this, SLOT(requestRedraw()));
+    connect(system->getWaypointManager(), SIGNAL(waypointListChanged()),
+            this, SLOT(requestRedraw()));
 }
 
 void
@@ -162,7 +205,9 @@ Pixhawk3DWidget::showTrail(int32_t state)
 {
     if (state == Qt::Checked) {
         if (!displayTrail) {
-            trail.clear();
+            foreach (osg::ref_ptr<TrailNode> trail, trails) {
+                trail->clear();
+            }
         }
 
         displayTrail = true;
@@ -505,6 +550,23 @@ Pixhawk3DWidget::buildLayout(void)
     connect(recenterButton, SIGNAL(clicked()), this, SLOT(recenter()));
     connect(followCameraCheckBox, SIGNAL(stateChanged(int)),
             this, SLOT(toggleFollowCamera(int)));
+
+    // every control changes what is drawn
+    connect(frameComboBox, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(requestRedraw()));
+    connect(gridCheckBox, SIGNAL(stateChanged(int)),
+            this, SLOT(requestRedraw()));
+    connect(trailCheckBox, SIGNAL(stateChanged(int)),
+            this, SLOT(requestRedraw()));
+    connect(waypointsCheckBox, SIGNAL(stateChanged(int)),
+            this, SLOT(requestRedraw()));
+    connect(mapComboBox, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(requestRedraw()));
+    connect(modelComboBox, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(requestRedraw()));
+    connect(recenterButton, SIGNAL(clicked()), this, SLOT(requestRedraw()));
+    connect(followCameraCheckBox, SIGNAL(stateChanged(int)),
+            this, SLOT(requestRedraw()));
 }
 
 void
@@ -557,7 +619,10 @@ Pixhawk3DWidget::display(void)
 
 #ifdef QGC_LIBFREENECT_ENABLED
     if (enableFreenect && (displayRGBD2D || displayRGBD3D)) {
-        updateRGBD();
+        updateRGBD(robotX, robotY, robotZ);
+
+        // the Kinect streams continuously, poll it at the frame rate
+        requestRedraw();
     }
 #endif
     updateHUD(robotX, robotY, robotZ, robotRoll, robotPitch, robotYaw, utmZone);
@@ -571,6 +636,8 @@ Pixhawk3DWidget::display(void)
     rollingMap->setChildValue(targetNode, enableTarget);
     if (enableFreenect) {
         egocentricMap->setChildValue(rgbd3DNode, displayRGBD3D);
+        rollingMap->setChildValue(occupancyNode,
+                                  displayRGBD3D && enableOccupancyMap);
     }
     hudGroup->setChildValue(rgb2DGeode, displayRGBD2D);
     hudGroup->setChildValue(depth2DGeode, displayRGBD2D);
@@ -595,6 +662,26 @@ Pixhawk3DWidget::keyPressEvent(QKeyEvent* event)
         case 'C':
             enableRGBDColor = !enableRGBDColor;
             break;
+        case 'f':
+        case 'F':
+            setFrameStatsVisible(!isFrameStatsVisible());
+            break;
+        case 'v':
+        case 'V':
+            enableRGBDFilter = !enableRGBDFilter;
+            break;
+        case 'm':
+        case 'M':
+            enableOccupancyMap = !enableOccupancyMap;
+            break;
+#ifdef QGC_LIBFREENECT_ENABLED
+        case '[':
+            rgbdVoxelSize = qMax(rgbdVoxelSize * 0.5f, 0.01f);
+            break;
+        case ']':
+            rgbdVoxelSize = qMin(rgbdVoxelSize * 2.0f, 0.8f);
+            break;
+#endif
         }
     }
 
@@ -665,18 +752,26 @@ void
 Pixhawk3DWidget::getPosition(double& x, double& y, double& z,
                              QString& utmZone)
 {
-    if (uas) {
+    getPosition(uas, x, y, z, utmZone);
+}
+
+void
+Pixhawk3DWidget::getPosition(UASInterface* system,
+                             double& x, double& y, double& z,
+                             QString& utmZone) const
+{
+    if (system) {
         if (frame == MAV_FRAME_GLOBAL) {
-            double latitude = uas->getLatitude();
-            double longitude = uas->getLongitude();
-            double altitude = uas->getAltitude();
+            double latitude = system->getLatitude();
+            double longitude = system->getLongitude();
+            double altitude = system->getAltitude();
 
             Imagery::LLtoUTM(latitude, longitude, x, y, utmZone);
             z = -altitude;
         } else if (frame == MAV_FRAME_LOCAL) {
-            x = uas->getLocalX();
-            y = uas->getLocalY();
-            z = uas->getLocalZ();
+            x = system->getLocalX();
+            y = system->getLocalY();
+            z = system->getLocalZ();
         }
     }
 }
@@ -750,33 +845,11 @@ Pixhawk3DWidget::createGrid(void)
     return geode;
 }
 
-osg::ref_ptr<osg::Geode>
+osg::ref_ptr<osg::Group>
 Pixhawk3DWidget::createTrail(void)
 {
-    osg::ref_ptr<osg::Geode> geode(new osg::Geode());
-    trailGeometry = new osg::Geometry();
-    trailGeometry->setUseDisplayList(false);
-    geode->addDrawable(trailGeometry.get());
-
-    trailVertices = new osg::Vec3dArray;
-    trailGeometry->setVertexArray(trailVertices);
-
-    trailDrawArrays = new osg::DrawArrays(osg::PrimitiveSet::LINE_STRIP);
-    trailGeometry->addPrimitiveSet(trailDrawArrays);
-
-    osg::ref_ptr<osg::Vec4Array> color(new osg::Vec4Array);
-    color->push_back(osg::Vec4(1.0f, 0.0f, 0.0f, 1.0f));
-    trailGeometry->setColorArray(color);
-    trailGeometry->setColorBinding(osg::Geometry::BIND_OVERALL);
-
-    osg::ref_ptr<osg::StateSet> stateset(new osg::StateSet);
-    osg::ref_ptr<osg::LineWidth> linewidth(new osg::LineWidth());
-    linewidth->setWidth(1.0f);
-    stateset->setAttributeAndModes(linewidth, osg::StateAttribute::ON);
-    stateset->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
-    trailGeometry->setStateSet(stateset);
-
-    return geode;
+    // one TrailNode per system is added once it reports a position
+    return osg::ref_ptr<osg::Group>(new osg::Group());
 }
 
 osg::ref_ptr<Imagery>
@@ -966,42 +1039,44 @@ Pixhawk3DWidget::updateHUD(double robotX, double robotY, double robotZ,
 void
 Pixhawk3DWidget::updateTrail(double robotX, double robotY, double robotZ)
 {
-    if (robotX == 0.0f || robotY == 0.0f || robotZ == 0.0f) {
-        return;
-    }
+    osg::Vec3d robotPosition(robotY, robotX, -robotZ);
+
+    QList<UASInterface*> systems = UASManager::instance()->getUASList();
+    foreach (UASInterface* system, systems) {
+        double x = 0.0, y = 0.0, z = 0.0;
+        QString utmZone;
+        getPosition(system, x, y, z, utmZone);
 
-    bool addToTrail = false;
-    if (trail.size() > 0) {
-        if (fabs(robotX - trail[trail.size() - 1].x()) > 0.01f ||
-                fabs(robotY - trail[trail.size() - 1].y()) > 0.01f ||
-                fabs(robotZ - trail[trail.size() - 1].z()) > 0.01f) {
-            addToTrail = true;
+        if (x == 0.0f || y == 0.0f || z == 0.0f) {
+            continue;
         }
-    } else {
-        addToTrail = true;
-    }
 
-    if (addToTrail) {
-        osg::Vec3d p(robotX, robotY, robotZ);
-        if (trail.size() == trail.capacity()) {
-            memcpy(trail.data(), trail.data() + 1,
-                   (trail.size() - 1) * sizeof(osg::Vec3d));
-            trail[trail.size() - 1] = p;
-        } else {
-            trail.append(p);
+        osg::ref_ptr<TrailNode>& trail = trails[system->getUASID()];
+        if (!trail.valid()) {
+            QColor color = system->getColor();
+            trail = new TrailNode(osg::Vec4(color.redF(), color.greenF(),
+                                            color.blueF(), 1.0f),
+                                  trailBudget);
+            trailNode->addChild(trail);
+
+            int capacity = trailBudget / trails.size();
+            foreach (osg::ref_ptr<TrailNode> t, trails) {
+                t->setCapacity(capacity);
+            }
         }
-    }
 
-    trailVertices->clear();
-    for (int i = 0; i < trail.size(); ++i) {
-        trailVertices->push_back(osg::Vec3d(trail[i].y() - robotY,
-                                            trail[i].x() - robotX,
-                                            -(trail[i].z() - robotZ)));
-    }
+        osg::Vec3d p(y, x, -z);
+        const osg::Vec3d& last = trail->getLastPoint();
+        if (trail->isEmpty() ||
+                fabs(p.x() - last.x()) > 0.01f ||
+                fabs(p.y() - last.y()) > 0.01f ||
+                fabs(p.z() - last.z()) > 0.01f) {
+            trail->addPoint(p);
+        }
 
-    trailDrawArrays->setFirst(0);
-    trailDrawArrays->setCount(trailVertices->size());
-    trailGeometry->dirtyBound();
+        // only the transform follows the robot, the vertices stay as they are
+        trail->setOffset(robotPosition);
+    }
 }
 
 void
@@ -1070,7 +1145,14 @@ Pixhawk3DWidget::updateImagery(double originX, double originY, double originZ,
                             zone);
     }
 
-    mapNode->update();
+    if (mapNode->update()) {
+        // every upload shows new tiles, downloads are only polled
+        if (mapNode->isUploading()) {
+            requestRedraw();
+        } else {
+            requestIdleRedraw();
+        }
+    }
 }
 
 void
@@ -1220,7 +1302,7 @@ float colormap_jet[128][3] = {
 
 #ifdef QGC_LIBFREENECT_ENABLED
 void
-Pixhawk3DWidget::updateRGBD(void)
+Pixhawk3DWidget::updateRGBD(double robotX, double robotY, double robotZ)
 {
     QSharedPointer<QByteArray> rgb = freenect->getRgbData();
     if (!rgb.isNull()) {
@@ -1240,23 +1322,112 @@ Pixhawk3DWidget::updateRGBD(void)
         depthImage->dirty();
     }
 
-    QSharedPointer< QVector<Freenect::Vector6D> > pointCloud =
-        freenect->get6DPointCloudData();
+    osg::Vec3d robotPosition(robotY, robotX, -robotZ);
+    occupancyNode->setMatrix(osg::Matrixd::translate(occupancyOrigin - robotPosition));
+
+    // Freenect reuses its point cloud, so no new frame is taken while the
+    // worker still reads the last one
+    if (!rgbdFilterJob.isFinished()) {
+        return;
+    }
 
     osg::Geometry* geometry = rgbd3DNode->getDrawable(0)->asGeometry();
+    if (rgbdJobFiltered) {
+        setPointCloud(geometry, filteredCloud, true);
+    }
+    if (rgbdJobAccumulated) {
+        osg::Geode* geode = static_cast<osg::Geode*>(occupancyNode->getChild(0));
+        setPointCloud(geode->getDrawable(0)->asGeometry(), occupancyCloud, false);
+    }
+    rgbdJobFiltered = false;
+    rgbdJobAccumulated = false;
+
+    QSharedPointer<PointCloud> pointCloud = freenect->get6DPointCloudData();
+    if (!enableRGBDFilter) {
+        setPointCloud(geometry, *pointCloud, true);
+    }
 
+    // each depth frame is filtered and accumulated only once
+    if ((enableRGBDFilter || enableOccupancyMap) &&
+            freenect->getDepthSequence() != rgbdSequence) {
+        rgbdSequence = freenect->getDepthSequence();
+
+        if (enableOccupancyMap && occupancyMap.size() == 0) {
+            occupancyOrigin = robotPosition;
+        }
+
+        // camera frame to world frame relative to the occupancy origin,
+        // osg multiplies row vectors from the left
+        osg::Matrixd cameraToWorld =
+            osg::Matrixd(1.0, 0.0, 0.0, 0.0,
+                         0.0, 0.0, -1.0, 0.0,
+                         0.0, 1.0, 0.0, 0.0,
+                         0.0, 0.0, 0.0, 1.0)
+            * osg::Matrixd::rotate(robotAttitude->getAttitude())
+            * osg::Matrixd::translate(robotPosition - occupancyOrigin);
+
+        QMatrix4x4 pose;
+        for (int row = 0; row < 4; ++row) {
+            for (int col = 0; col < 4; ++col) {
+                pose(row, col) = cameraToWorld(col, row);
+            }
+        }
+
+        rgbdJobFiltered = enableRGBDFilter;
+        rgbdJobAccumulated = enableOccupancyMap;
+        rgbdFilterJob = QtConcurrent::run(this, &Pixhawk3DWidget::filterRGBD,
+                                          pointCloud, pose,
+                                          enableRGBDFilter ? rgbdVoxelSize : 0.0f,
+                                          enableOccupancyMap);
+    }
+}
+
+void
+Pixhawk3DWidget::filterRGBD(const QSharedPointer<PointCloud>& cloud,
+                            const QMatrix4x4& pose,
+                            float voxelSize, bool accumulate)
+{
+    const PointCloud* points = cloud.data();
+    if (voxelSize > 0.0f) {
+        voxelGrid.setVoxelSize(voxelSize);
+        voxelGrid.downsample(*cloud, filteredCloud);
+        points = &filteredCloud;
+    }
+
+    if (accumulate) {
+        occupancyMap.insert(*points, pose);
+        occupancyMap.extract(occupancyCloud);
+    }
+}
+
+void
+Pixhawk3DWidget::setPointCloud(osg::Geometry* geometry, const PointCloud& cloud,
+                               bool cameraFrame)
+{
     osg::Vec3Array* vertices = static_cast<osg::Vec3Array*>(geometry->getVertexArray());
     osg::Vec4Array* colors = static_cast<osg::Vec4Array*>(geometry->getColorArray());
-    for (int i = 0; i < pointCloud->size(); ++i) {
-        double x = pointCloud->at(i).x;
-        double y = pointCloud->at(i).y;
-        double z = pointCloud->at(i).z;
-        (*vertices)[i].set(x, z, -y);
-
-        if (enableRGBDColor) {
-            (*colors)[i].set(pointCloud->at(i).r / 255.0f,
-                             pointCloud->at(i).g / 255.0f,
-                             pointCloud->at(i).b / 255.0f,
+    if (static_cast<int>(vertices->size()) < cloud.size) {
+        vertices->resize(cloud.size);
+        colors->resize(cloud.size);
+    }
+
+    const float* px = cloud.x.constData();
+    const float* py = cloud.y.constData();
+    const float* pz = cloud.z.constData();
+    for (int i = 0; i < cloud.size; ++i) {
+        double x = px[i];
+        double y = py[i];
+        double z = pz[i];
+        if (cameraFrame) {
+            (*vertices)[i].set(x, z, -y);
+        } else {
+            (*vertices)[i].set(x, y, z);
+        }
+
+        if (enableRGBDColor || !cameraFrame) {
+            (*colors)[i].set(cloud.r[i] / 255.0f,
+                             cloud.g[i] / 255.0f,
+                             cloud.b[i] / 255.0f,
                              1.0f);
         } else {
             double dist = sqrt(x * x + y * y + z * z);
@@ -1270,11 +1441,12 @@ Pixhawk3DWidget::updateRGBD(void)
 
     if (geometry->getNumPrimitiveSets() == 0) {
         geometry->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::POINTS,
-                                  0, pointCloud->size()));
+                                  0, cloud.size));
     } else {
         osg::DrawArrays* drawarrays = static_cast<osg::DrawArrays*>(geometry->getPrimitiveSet(0));
-        drawarrays->setCount(pointCloud->size());
+        drawarrays->setCount(cloud.size);
     }
+    geometry->dirtyBound();
 }
 #endif
 
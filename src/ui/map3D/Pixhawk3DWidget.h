@@ -32,15 +32,21 @@
 #ifndef PIXHAWK3DWIDGET_H
 #define PIXHAWK3DWIDGET_H
 
+#include <osg/MatrixTransform>
 #include <osgText/Text>
 
 #include "HUDScaleGeode.h"
 #include "Imagery.h"
 #include "ImageWindowGeode.h"
+#include "TrailNode.h"
 #include "WaypointGroupNode.h"
 
 #ifdef QGC_LIBFREENECT_ENABLED
+#include <QFuture>
+
 #include "Freenect.h"
+#include "OccupancyMap.h"
+#include "VoxelGrid.h"
 #endif
 
 #include "Q3DWidget.h"
@@ -62,6 +68,7 @@ public slots:
     void setActiveUAS(UASInterface* uas);
 
 private slots:
+    void addUAS(UASInterface* system);
     void selectFrame(QString text);
     void showGrid(int state);
     void showTrail(int state);
@@ -97,9 +104,12 @@ private:
     void getPosition(double& x, double& y, double& z,
                      QString& utmZone);
     void getPosition(double& x, double& y, double& z);
+    void getPosition(UASInterface* system,
+                     double& x, double& y, double& z,
+                     QString& utmZone) const;
 
     osg::ref_ptr<osg::Geode> createGrid(void);
-    osg::ref_ptr<osg::Geode> createTrail(void);
+    osg::ref_ptr<osg::Group> createTrail(void);
     osg::ref_ptr<Imagery> createMap(void);
     osg::ref_ptr<osg::Geode> createRGBD3D(void);
     osg::ref_ptr<osg::Node> createTarget(void);
@@ -116,7 +126,12 @@ private:
     void updateWaypoints(void);
     void updateTarget(double robotX, double robotY);
 #ifdef QGC_LIBFREENECT_ENABLED
-    void updateRGBD(void);
+    void updateRGBD(double robotX, double robotY, double robotZ);
+    void filterRGBD(const QSharedPointer<PointCloud>& cloud,
+                    const QMatrix4x4& pose,
+                    float voxelSize, bool accumulate);
+    void setPointCloud(osg::Geometry* geometry, const PointCloud& cloud,
+                       bool cameraFrame);
 #endif
 
     int findWaypoint(int mouseX, int mouseY);
@@ -138,12 +153,15 @@ private:
     bool displayRGBD2D;
     bool displayRGBD3D;
     bool enableRGBDColor;
+    bool enableRGBDFilter;
+    bool enableOccupancyMap;
     bool enableTarget;
 
     bool followCamera;
 
-    osg::ref_ptr<osg::Vec3dArray> trailVertices;
-    QVarLengthArray<osg::Vec3d, 10000> trail;
+    // trails of all systems, they share trailBudget vertices
+    QMap<int, osg::ref_ptr<TrailNode> > trails;
+    static const int trailBudget = 100000;
 
     osg::ref_ptr<osg::Node> vehicleModel;
     osg::ref_ptr<osg::Geometry> hudBackgroundGeometry;
@@ -154,15 +172,27 @@ private:
     osg::ref_ptr<osg::Image> rgbImage;
     osg::ref_ptr<osg::Image> depthImage;
     osg::ref_ptr<osg::Geode> gridNode;
-    osg::ref_ptr<osg::Geode> trailNode;
-    osg::ref_ptr<osg::Geometry> trailGeometry;
-    osg::ref_ptr<osg::DrawArrays> trailDrawArrays;
+    osg::ref_ptr<osg::Group> trailNode;
     osg::ref_ptr<Imagery> mapNode;
     osg::ref_ptr<WaypointGroupNode> waypointGroupNode;
     osg::ref_ptr<osg::Node> targetNode;
     osg::ref_ptr<osg::Geode> rgbd3DNode;
+    osg::ref_ptr<osg::MatrixTransform> occupancyNode;
 #ifdef QGC_LIBFREENECT_ENABLED
     QScopedPointer<Freenect> freenect;
+
+    // voxel filter and occupancy map, they run on a worker thread and
+    // only touch the members below while rgbdFilterJob is running
+    VoxelGrid voxelGrid;
+    OccupancyMap occupancyMap;
+    PointCloud filteredCloud;
+    PointCloud occupancyCloud;
+    QFuture<void> rgbdFilterJob;
+    float rgbdVoxelSize;
+    quint32 rgbdSequence;
+    bool rgbdJobFiltered;
+    bool rgbdJobAccumulated;
+    osg::Vec3d occupancyOrigin;
 #endif
     bool enableFreenect;
 
@@ -32,9 +32,12 @@ This file is part of the QGROUNDCONTROL project
 #include "Q3DWidget.h"
 #include "QGC.h"
 
+#include <sstream>
+
 #include <osg/Geometry>
 #include <osg/LineWidth>
 #include <osg/MatrixTransform>
+#include <osg/Timer>
 #ifdef Q_OS_MACX
 #include <Carbon/Carbon.h>
 #endif
@@ -49,7 +52,11 @@ Q3DWidget::Q3DWidget(QWidget* parent)
     , robotAttitude(new osg::PositionAttitudeTransform())
     , hudGroup(new osg::Switch())
     , hudProjectionMatrix(new osg::Projection)
+    , scheduledRate(0.0f)
+    , redrawRequested(false)
+    , frameInterval(0.0)
     , fps(30.0f)
+    , idleFps(5.0f)
 {
     // set initial camera parameters
     cameraParams.minZoomRange = 2.0f;
@@ -62,6 +69,9 @@ Q3DWidget::Q3DWidget(QWidget* parent)
     setThreadingModel(osgViewer::Viewer::SingleThreaded);
 
     setFocusPolicy(Qt::StrongFocus);
+
+    timer.setSingleShot(true);
+    lastFrame.start();
 }
 
 Q3DWidget::~Q3DWidget()
@@ -105,6 +115,18 @@ Q3DWidget::init(float fps)
     cameraManipulator->setMinZoomRange(cameraParams.minZoomRange);
     cameraManipulator->setDistance(cameraParams.minZoomRange * 2.0);
 
+    // set up frame time display, hidden by default
+    frameStatsText = new osgText::Text;
+    frameStatsText->setCharacterSize(11);
+    frameStatsText->setFont("images/Vera.ttf");
+    frameStatsText->setAxisAlignment(osgText::Text::SCREEN);
+    frameStatsText->setColor(osg::Vec4(1.0f, 1.0f, 0.0f, 1.0f));
+    frameStatsText->setDataVariance(osg::Object::DYNAMIC);
+    frameStatsText->setPosition(osg::Vec3(10, height() - 40, -1.5));
+    frameStatsGeode = new osg::Geode;
+    frameStatsGeode->addDrawable(frameStatsText);
+    hudGroup->addChild(frameStatsGeode, false);
+
     connect(&timer, SIGNAL(timeout()), this, SLOT(redraw()));
     // DO NOT START TIMER IN INITIALIZATION! IT IS STARTED IN THE SHOW EVENT
 }
@@ -114,7 +136,7 @@ void Q3DWidget::showEvent(QShowEvent* event)
     // React only to internal (pre/post-display)
     // events
     Q_UNUSED(event)
-    timer.start(static_cast<int>(floorf(1000.0f / fps)));
+    requestRedraw();
 }
 
 void Q3DWidget::hideEvent(QHideEvent* event)
@@ -260,13 +282,59 @@ Q3DWidget::getGlobalCursorPosition(int32_t cursorX, int32_t cursorY, double z)
     return std::make_pair(projectedPoint.y(), projectedPoint.x());
 }
 
+void
+Q3DWidget::setFrameStatsVisible(bool visible)
+{
+    // the GPU timer queries are only issued while the times are shown
+    getCamera()->getStats()->collectStats("rendering", visible);
+    getCamera()->getStats()->collectStats("gpu", visible);
+    getViewerStats()->collectStats("update", visible);
+
+    hudGroup->setChildValue(frameStatsGeode, visible);
+    requestRedraw();
+}
+
+bool
+Q3DWidget::isFrameStatsVisible(void) const
+{
+    return hudGroup->getChildValue(frameStatsGeode);
+}
+
+void
+Q3DWidget::requestRedraw(void)
+{
+    scheduleRedraw(fps);
+}
+
+void
+Q3DWidget::requestIdleRedraw(void)
+{
+    scheduleRedraw(idleFps);
+}
+
+void
+Q3DWidget::scheduleRedraw(float rate)
+{
+    redrawRequested = true;
+    if (!isVisible() || (timer.isActive() && scheduledRate >= rate)) {
+        return;
+    }
+
+    // a scene change does not wait for a poll scheduled at the idle rate
+    scheduledRate = rate;
+    int wait = static_cast<int>(1000.0f / rate) - lastFrame.elapsed();
+    timer.start(qMax(wait, 0));
+}
+
 void
 Q3DWidget::redraw(void)
 {
 #if (QGC_EVENTLOOP_DEBUG)
     qDebug() << "EVENTLOOP:" << __FILE__ << __LINE__;
 #endif
-    updateGL();
+    if (redrawRequested) {
+        updateGL();
+    }
 }
 
 int
@@ -290,19 +358,62 @@ Q3DWidget::resizeGL(int width, int height)
 
     osgGW->getEventQueue()->windowResize(0, 0, width, height);
     osgGW->resized(0 , 0, width, height);
+
+    if (frameStatsText.valid()) {
+        frameStatsText->setPosition(osg::Vec3(10, height - 40, -1.5));
+    }
 }
 
 void
 Q3DWidget::paintGL(void)
 {
+    redrawRequested = false;
+    frameInterval = 0.9 * frameInterval + 0.1 * lastFrame.restart();
+
     setDisplayMode3D();
 
     getCamera()->setClearColor(osg::Vec4f(0.0f, 0.0f, 0.0f, 0.0f));
     getCamera()->setClearMask(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+    osg::Timer_t displayStart = osg::Timer::instance()->tick();
     display();
+    double displayTime = osg::Timer::instance()->delta_m(displayStart,
+                         osg::Timer::instance()->tick());
 
     frame();
+
+    // keep drawing while the camera moves, e.g. after it was thrown
+    if (getCamera()->getViewMatrix() != lastViewMatrix) {
+        lastViewMatrix = getCamera()->getViewMatrix();
+        requestRedraw();
+    }
+
+    if (isFrameStatsVisible()) {
+        updateFrameStats(displayTime);
+    }
+}
+
+void
+Q3DWidget::updateFrameStats(double displayTime)
+{
+    // the traversal times are in seconds, averaged over the last frames
+    double updateTime = 0.0, cullTime = 0.0, drawTime = 0.0, gpuTime = 0.0;
+    getViewerStats()->getAveragedAttribute("Update traversal time taken", updateTime);
+    getCamera()->getStats()->getAveragedAttribute("Cull traversal time taken", cullTime);
+    getCamera()->getStats()->getAveragedAttribute("Draw traversal time taken", drawTime);
+    getCamera()->getStats()->getAveragedAttribute("GPU draw time taken", gpuTime);
+
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed, std::ios::floatfield);
+    oss.precision(1);
+    oss << "CPU: display " << displayTime << " ms"
+        << " update " << updateTime * 1000.0 << " ms"
+        << " cull " << cullTime * 1000.0 << " ms"
+        << " draw " << drawTime * 1000.0 << " ms"
+        << "  GPU: draw " << gpuTime * 1000.0 << " ms"
+        << "  " << ((frameInterval > 0.0) ? 1000.0 / frameInterval : 0.0) << " fps";
+
+    frameStatsText->setText(oss.str());
 }
 
 void
@@ -314,6 +425,8 @@ Q3DWidget::display(void)
 void
 Q3DWidget::keyPressEvent(QKeyEvent* event)
 {
+    requestRedraw();
+
     QWidget::keyPressEvent(event);
     if (event->isAccepted()) {
         return;
@@ -331,6 +444,8 @@ Q3DWidget::keyPressEvent(QKeyEvent* event)
 void
 Q3DWidget::keyReleaseEvent(QKeyEvent* event)
 {
+    requestRedraw();
+
     QWidget::keyReleaseEvent(event);
     if (event->isAccepted()) {
         return;
@@ -365,6 +480,7 @@ Q3DWidget::mousePressEvent(QMouseEvent* event)
     {}
     }
     osgGW->getEventQueue()->mouseButtonPress(event->x(), event->y(), button);
+    requestRedraw();
 }
 
 void
@@ -388,12 +504,14 @@ Q3DWidget::mouseReleaseEvent(QMouseEvent* event)
     {}
     }
     osgGW->getEventQueue()->mouseButtonRelease(event->x(), event->y(), button);
+    requestRedraw();
 }
 
 void
 Q3DWidget::mouseMoveEvent(QMouseEvent* event)
 {
     osgGW->getEventQueue()->mouseMotion(event->x(), event->y());
+    requestRedraw();
 }
 
 void
@@ -402,6 +520,7 @@ Q3DWidget::wheelEvent(QWheelEvent* event)
     osgGW->getEventQueue()->mouseScroll((event->delta() > 0) ?
                                         osgGA::GUIEventAdapter::SCROLL_UP :
                                         osgGA::GUIEventAdapter::SCROLL_DOWN);
+    requestRedraw();
 }
 
 osgGA::GUIEventAdapter::KeySymbol
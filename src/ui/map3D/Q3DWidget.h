@@ -38,6 +38,7 @@ This file is part of the QGROUNDCONTROL project
 #include <osg/LineSegment>
 #include <osg/PositionAttitudeTransform>
 #include <osgGA/TrackballManipulator>
+#include <osgText/Text>
 #include <osgViewer/Viewer>
 
 #include "GCManipulator.h"
@@ -49,6 +50,13 @@ This file is part of the QGROUNDCONTROL project
  * - x-axis points to the east
  * - y-axis points to the north
  * - z-axis points upwards
+ *
+ * Frames are only rendered on demand: subclasses call requestRedraw()
+ * whenever the scene changed, user input and camera motion request frames
+ * on their own. These frames are capped at fps. Work in progress which has
+ * not changed the scene yet, e.g. tiles that are still downloading, is
+ * polled with requestIdleRedraw() at idleFps. Nothing is rendered while the
+ * widget is hidden.
  */
 class Q3DWidget : public QGLWidget, public osgViewer::Viewer
 {
@@ -114,6 +122,25 @@ public:
             int32_t cursorY,
             double z);
 
+    /**
+     * @brief Shows or hides the frame times of the rendering passes.
+     */
+    void setFrameStatsVisible(bool visible);
+    bool isFrameStatsVisible(void) const;
+
+public slots:
+    /**
+     * @brief Schedules a frame for a scene change at up to fps, requests
+     * are merged until it is drawn.
+     */
+    void requestRedraw(void);
+
+    /**
+     * @brief Schedules a frame at up to idleFps, to poll work in progress
+     * which did not change the scene yet.
+     */
+    void requestIdleRedraw(void);
+
 protected slots:
     /**
      * @brief Updates the widget.
@@ -234,6 +261,18 @@ protected:
                                   const osg::LineSegment& line,
                                   osg::Vec3d& isect);
 
+    /**
+     * @brief Schedules the next frame at most 1000 / rate milliseconds
+     * after the last one, or earlier if a faster frame was requested.
+     */
+    void scheduleRedraw(float rate);
+
+    /**
+     * @brief Updates the frame time HUD with the times of the last frame.
+     * @param displayTime Time spent in display() in milliseconds.
+     */
+    void updateFrameStats(double displayTime);
+
     osg::ref_ptr<osg::Group> root; /**< Root node of scene graph. */
     osg::ref_ptr<osg::Switch> allocentricMap;
     osg::ref_ptr<osg::Switch> rollingMap;
@@ -248,7 +287,15 @@ protected:
 
     osg::ref_ptr<GCManipulator> cameraManipulator; /**< Camera manipulator. */
 
-    QTimer timer; /**< Timer which draws graphics based on specified fps. */
+    QTimer timer; /**< Single shot timer which draws the next requested frame. */
+    QTime lastFrame; /**< Time since the last frame was drawn. */
+    float scheduledRate; /**< Frame rate the pending frame was scheduled at. */
+    bool redrawRequested;
+    osg::Matrixd lastViewMatrix; /**< View matrix of the last frame, to detect camera motion. */
+
+    osg::ref_ptr<osg::Geode> frameStatsGeode;
+    osg::ref_ptr<osgText::Text> frameStatsText;
+    double frameInterval; /**< Smoothed time between frames in milliseconds. */
 
     struct CameraParams {
         float minZoomRange;
@@ -259,6 +306,7 @@ protected:
 
     CameraParams cameraParams; /**< Struct representing camera parameters. */
     float fps;
+    float idleFps; /**< Frame rate cap of requestIdleRedraw(). */
 };
 
 #endif // Q3DWIDGET_H
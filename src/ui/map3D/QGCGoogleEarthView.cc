@@ -7,6 +7,9 @@
 #include <QDebug>
 #include <QFile>
 #include <QTextStream>
+#include <QTime>
+#include <QStringList>
+#include <qnumeric.h>
 #include "UASManager.h"
 
 #ifdef Q_OS_MAC
@@ -31,10 +34,30 @@
 
 #define QGCGOOGLEEARTHVIEWSETTINGS QString("GoogleEarthViewSettings_")
 
+/** @brief Check if a value changed by at least the resolution it is sent with */
+static inline bool changed(double value, double last, double resolution)
+{
+    if (value != value && last != last) return false;
+    return !(qAbs(value - last) < resolution);
+}
+
+QGCGoogleEarthView::AircraftState::AircraftState() :
+    lat(qQNaN()),
+    lon(qQNaN()),
+    alt(qQNaN()),
+    roll(qQNaN()),
+    pitch(qQNaN()),
+    yaw(qQNaN()),
+    trail()
+{
+}
+
 QGCGoogleEarthView::QGCGoogleEarthView(QWidget *parent) :
     QWidget(parent),
     updateTimer(new QTimer(this)),
     refreshRateMs(100),
+    updateInterval(100),
+    updateTime(0.0f),
     mav(NULL),
     followCamera(true),
     trailEnabled(true),
@@ -122,6 +145,10 @@ void QGCGoogleEarthView::reloadHTML()
     webViewInitialized = false;
     jScriptInitialized = false;
     gEarthInitialized = false;
+    // The new page starts empty, all MAVs are added again once it is initialized
+    aircraftStates.clear();
+    pendingWaypointListLengths.clear();
+    pendingWaypoints.clear();
     show();
 }
 
@@ -205,6 +232,9 @@ void QGCGoogleEarthView::addUAS(UASInterface* uas)
 
     if (trailEnabled) javaScript(QString("showTrail(%1);").arg(uas->getUASID()));
 
+    // Start with an unknown state, the next update sends all fields
+    aircraftStates.insert(uas->getUASID(), AircraftState());
+
     // Automatically receive further position updates
     connect(uas, SIGNAL(globalPositionChanged(UASInterface*,double,double,double,quint64)), this, SLOT(updateGlobalPosition(UASInterface*,double,double,double,quint64)));
     // Receive waypoint updates
@@ -242,8 +272,8 @@ void QGCGoogleEarthView::updateWaypoint(int uas, Waypoint* wp)
         if (wpindex == -1) {
             return;
         } else {
-            javaScript(QString("updateWaypoint(%1,%2,%3,%4,%5,%6);").arg(uas).arg(wpindex).arg(wp->getLatitude(), 0, 'f', 18).arg(wp->getLongitude(), 0, 'f', 18).arg(wp->getAltitude(), 0, 'f', 18).arg(wp->getAction()));
-            //qDebug() << QString("updateWaypoint(%1,%2,%3,%4,%5,%6);").arg(uas).arg(wpindex).arg(wp->getLatitude(), 0, 'f', 18).arg(wp->getLongitude(), 0, 'f', 18).arg(wp->getAltitude(), 0, 'f', 18).arg(wp->getAction());
+            // Queue the waypoint for the next update, replacing an older queued version
+            pendingWaypoints.insert(qMakePair(uas, wpindex), QString("[%1,%2,%3,%4,%5,%6]").arg(uas).arg(wpindex).arg(jsonNumber(wp->getLatitude(), 7)).arg(jsonNumber(wp->getLongitude(), 7)).arg(jsonNumber(wp->getAltitude(), 2)).arg(wp->getAction()));
         }
     }
 }
@@ -261,10 +291,13 @@ void QGCGoogleEarthView::updateWaypointList(int uas)
         // Get all waypoints, including non-global waypoints
         QVector<Waypoint*> wpList = uasInstance->getWaypointManager()->getGlobalFrameAndNavTypeWaypointList();
 
-        // Trim internal list to number of global waypoints in the waypoint manager list
-        javaScript(QString("updateWaypointListLength(%1,%2);").arg(uas).arg(wpList.count()));
-
-        qDebug() << QString("updateWaypointListLength(%1,%2);").arg(uas).arg(wpList.count());
+        // Trim internal list to number of global waypoints in the waypoint manager list,
+        // queued waypoints beyond the new end are obsolete
+        pendingWaypointListLengths.insert(uas, wpList.count());
+        QMap<QPair<int, int>, QString>::iterator i = pendingWaypoints.lowerBound(qMakePair(uas, wpList.count()));
+        while (i != pendingWaypoints.end() && i.key().first == uas) {
+            i = pendingWaypoints.erase(i);
+        }
 
         // Load all existing waypoints into map view
         foreach (Waypoint* wp, wpList) {
@@ -276,9 +309,22 @@ void QGCGoogleEarthView::updateWaypointList(int uas)
 void QGCGoogleEarthView::updateGlobalPosition(UASInterface* uas, double lat, double lon, double alt, quint64 usec)
 {
     Q_UNUSED(usec);
-    javaScript(QString("addTrailPosition(%1, %2, %3, %4);").arg(uas->getUASID()).arg(lat, 0, 'f', 18).arg(lon, 0, 'f', 18).arg(alt, 0, 'f', 15));
-
-    //qDebug() << QString("addTrailPosition(%1, %2, %3, %4);").arg(uas->getUASID()).arg(lat, 0, 'f', 15).arg(lon, 0, 'f', 15).arg(alt, 0, 'f', 15);
+    // Positions are queued and sent to the page with the next update
+    QHash<int, AircraftState>::iterator state = aircraftStates.find(uas->getUASID());
+    if (state == aircraftStates.end()) return;
+
+    QVector<double>& trail = state.value().trail;
+    if (trail.size() >= 3 * maxQueuedTrailPositions) {
+        // No updates are sent while the view is hidden, keep every second position
+        int kept = 0;
+        for (int i = 0; i < trail.size(); i += 6) {
+            trail[kept++] = trail[i];
+            trail[kept++] = trail[i+1];
+            trail[kept++] = trail[i+2];
+        }
+        trail.resize(kept);
+    }
+    trail << lat << lon << alt;
 }
 
 void QGCGoogleEarthView::clearTrails()
@@ -405,7 +451,7 @@ void QGCGoogleEarthView::showEvent(QShowEvent* event)
 
         QTimer::singleShot(3000, this, SLOT(initializeGoogleEarth()));
     } else {
-        updateTimer->start(refreshRateMs);
+        updateTimer->start(updateInterval);
     }
 }
 
@@ -572,7 +618,7 @@ void QGCGoogleEarthView::initializeGoogleEarth()
             if (mav) updateWaypointList(mav->getUASID());
 
             // Start update timer
-            updateTimer->start(refreshRateMs);
+            updateTimer->start(updateInterval);
 
             // Set current view mode
             setViewMode(currentViewMode);
@@ -594,37 +640,17 @@ void QGCGoogleEarthView::updateState()
     qDebug() << "EVENTLOOP:" << __FILE__ << __LINE__;
 #endif
     if (gEarthInitialized) {
-        int uasId = 0;
-        double lat = 47.3769;
-        double lon = 8.549444;
-        double alt = 470.0;
+        // Send all changes of all MAVs with one script call. It is made even if
+        // nothing changed, the page keeps interpolating the current MAV with it.
+        QTime scriptTime;
+        scriptTime.start();
+        QString update = takeStateUpdate();
+        QVariant result = javaScript("applyState(" + (update.isEmpty() ? QString("{}") : update) + ");");
+        adaptRefreshRate(scriptTime.elapsed());
 
-        float roll = 0.0f;
-        float pitch = 0.0f;
-        float yaw = 0.0f;
-
-        // Update all MAVs
-        QList<UASInterface*> mavs = UASManager::instance()->getUASList();
-        foreach (UASInterface* currMav, mavs) {
-            uasId = currMav->getUASID();
-            lat = currMav->getLatitude();
-            lon = currMav->getLongitude();
-            alt = currMav->getAltitude();
-            roll = currMav->getRoll();
-            pitch = currMav->getPitch();
-            yaw = currMav->getYaw();
-
-            //qDebug() << "SETTING POSITION FOR" << uasId << lat << lon << alt << roll << pitch << yaw;
-
-            javaScript(QString("setAircraftPositionAttitude(%1, %2, %3, %4, %6, %7, %8);")
-                       .arg(uasId)
-                       .arg(lat, 0, 'f', 15)
-                       .arg(lon, 0, 'f', 15)
-                       .arg(alt, 0, 'f', 15)
-                       .arg(roll, 0, 'f', 9)
-                       .arg(pitch, 0, 'f', 9)
-                       .arg(yaw, 0, 'f', 9));
-        }
+        // The page returns whether user input is pending. Where the script host
+        // does not return values, the flag is read from the document instead.
+        bool inputPending = result.isValid() ? result.toBool() : documentElement("inputPending").toBool();
 
 
         // Read out new waypoint positions and waypoint create events
@@ -633,7 +659,7 @@ void QGCGoogleEarthView::updateState()
 
         // First check if a new WP should be created
 //        bool newWaypointPending = .to
-        bool newWaypointPending = documentElement("newWaypointPending").toBool();
+        bool newWaypointPending = inputPending && documentElement("newWaypointPending").toBool();
         if (newWaypointPending) {
             bool coordsOk = true;
             bool ok;
@@ -659,7 +685,7 @@ void QGCGoogleEarthView::updateState()
         }
 
         // Check if a waypoint should be moved
-        bool dragWaypointPending = documentElement("dragWaypointPending").toBool();
+        bool dragWaypointPending = inputPending && documentElement("dragWaypointPending").toBool();
 
         if (dragWaypointPending) {
             bool coordsOk = true;
@@ -705,6 +731,85 @@ void QGCGoogleEarthView::updateState()
     }
 }
 
+QString QGCGoogleEarthView::takeStateUpdate()
+{
+    // Resolution and decimals of latitude, longitude, altitude, roll, pitch and yaw
+    static const double resolution[6] = {1e-7, 1e-7, 0.01, 1e-4, 1e-4, 1e-4};
+    static const int precision[6] = {7, 7, 2, 4, 4, 4};
+
+    QStringList aircraft;
+    QStringList trails;
+    QHash<int, AircraftState>::iterator i;
+    for (i = aircraftStates.begin(); i != aircraftStates.end(); ++i) {
+        UASInterface* uas = UASManager::instance()->getUASForId(i.key());
+        if (!uas) continue;
+        AircraftState& state = i.value();
+
+        // Send only the fields that changed, null keeps the last value in the page
+        const double values[6] = {uas->getLatitude(), uas->getLongitude(), uas->getAltitude(),
+                                  uas->getRoll(), uas->getPitch(), uas->getYaw()};
+        double* last[6] = {&state.lat, &state.lon, &state.alt, &state.roll, &state.pitch, &state.yaw};
+        QString entry = QString::number(i.key());
+        bool modified = false;
+        for (int f = 0; f < 6; f++) {
+            if (changed(values[f], *last[f], resolution[f])) {
+                entry += "," + jsonNumber(values[f], precision[f]);
+                *last[f] = values[f];
+                modified = true;
+            } else {
+                entry += ",null";
+            }
+        }
+        if (modified) aircraft.append("[" + entry + "]");
+
+        if (!state.trail.isEmpty()) {
+            QString trail = QString::number(i.key());
+            for (int p = 0; p < state.trail.size(); p += 3) {
+                trail += "," + jsonNumber(state.trail[p], 7) + "," + jsonNumber(state.trail[p+1], 7) + "," + jsonNumber(state.trail[p+2], 2);
+            }
+            trails.append("[" + trail + "]");
+            state.trail.clear();
+        }
+    }
+
+    QStringList lengths;
+    QMap<int, int>::const_iterator l;
+    for (l = pendingWaypointListLengths.constBegin(); l != pendingWaypointListLengths.constEnd(); ++l) {
+        lengths.append(QString("[%1,%2]").arg(l.key()).arg(l.value()));
+    }
+    pendingWaypointListLengths.clear();
+
+    // Waypoints are sorted by system and index, so the page appends them in order
+    QStringList waypoints = pendingWaypoints.values();
+    pendingWaypoints.clear();
+
+    QStringList fields;
+    if (!aircraft.isEmpty()) fields.append("\"a\":[" + aircraft.join(",") + "]");
+    if (!trails.isEmpty()) fields.append("\"t\":[" + trails.join(",") + "]");
+    if (!lengths.isEmpty()) fields.append("\"l\":[" + lengths.join(",") + "]");
+    if (!waypoints.isEmpty()) fields.append("\"w\":[" + waypoints.join(",") + "]");
+    if (fields.isEmpty()) return QString();
+    return "{" + fields.join(",") + "}";
+}
+
+void QGCGoogleEarthView::adaptRefreshRate(int elapsed)
+{
+    // Keep the page below a fifth of the GUI thread's time. Stretch the interval
+    // quickly while the page is slow and recover slowly once it is fast again.
+    updateTime = updateTime * 0.8f + elapsed * 0.2f;
+    if (updateTime * 5 > updateInterval) {
+        updateInterval = qMin((int)maxUpdateInterval, (int)(updateInterval * 1.25f) + 1);
+    } else if (updateTime * 20 < updateInterval) {
+        updateInterval = qMax(refreshRateMs, (int)(updateInterval * 0.95f));
+    }
+    if (updateTimer->interval() != updateInterval) updateTimer->setInterval(updateInterval);
+}
+
+QString QGCGoogleEarthView::jsonNumber(double value, int precision)
+{
+    if (!qIsFinite(value)) return QString("null");
+    return QString::number(value, 'f', precision);
+}
 
 void QGCGoogleEarthView::changeEvent(QEvent *e)
 {
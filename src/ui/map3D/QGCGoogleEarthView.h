@@ -3,6 +3,10 @@
 
 #include <QWidget>
 #include <QTimer>
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QVector>
 #include <UASInterface.h>
 
 #if (defined Q_OS_MAC)
@@ -79,7 +83,7 @@ public:
     };
 
 public slots:
-    /** @brief Update the internal state. Does not trigger a redraw */
+    /** @brief Send all changes since the last update to the page in one batch and poll for user input */
     void updateState();
     /** @brief Add a new MAV/UAS to the visualization */
     void addUAS(UASInterface* uas);
@@ -138,9 +142,35 @@ public:
     QVariant documentElement(QString name);
 
 protected:
+    /** @brief Last state sent to the page and trail positions queued since, for one MAV */
+    struct AircraftState {
+        AircraftState();
+        double lat;
+        double lon;
+        double alt;
+        double roll;
+        double pitch;
+        double yaw;
+        QVector<double> trail; ///< Queued trail positions as latitude, longitude, altitude triples
+    };
+
     void changeEvent(QEvent *e);
+    /** @brief Serialize all changes since the last update as one JSON object, empty if nothing changed */
+    QString takeStateUpdate();
+    /** @brief Stretch or shrink the update interval depending on how long the last update blocked */
+    void adaptRefreshRate(int elapsed);
+    /** @brief Format a number for JSON, with null for NaN and infinity */
+    static QString jsonNumber(double value, int precision);
+
     QTimer* updateTimer;
-    int refreshRateMs;
+    int refreshRateMs;              ///< Shortest update interval, in milliseconds
+    int updateInterval;             ///< Current update interval, adapted to the page's responsiveness
+    float updateTime;               ///< Smoothed time one update blocks the GUI thread, in milliseconds
+    QHash<int, AircraftState> aircraftStates; ///< MAVs known to the page, by system id
+    QMap<int, int> pendingWaypointListLengths; ///< Queued waypoint list lengths, by system id
+    QMap<QPair<int, int>, QString> pendingWaypoints; ///< Queued waypoints in JSON, by system id and index
+    static const int maxUpdateInterval = 1000;   ///< Longest update interval, in milliseconds
+    static const int maxQueuedTrailPositions = 1000; ///< Trail positions queued per MAV before thinning
     UASInterface* mav;
     bool followCamera;
     bool trailEnabled;
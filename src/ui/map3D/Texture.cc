@@ -33,8 +33,9 @@ This file is part of the QGROUNDCONTROL project
 
 #include "Texture.h"
 
-Texture::Texture(unsigned int _id)
-    : id(_id)
+Texture::Texture(const QString& _sourceURL)
+    : state(REQUESTED)
+    , sourceURL(_sourceURL)
     , texture2D(new osg::Texture2D)
     , geometry(new osg::Geometry)
 {
@@ -81,30 +82,31 @@ Texture::getSourceURL(void) const
     return sourceURL;
 }
 
-void
-Texture::sync(const WebImagePtr& image)
+bool
+Texture::isReady(void) const
 {
-    state = static_cast<State>(image->getState());
-
-    if (image->getState() != WebImage::UNINITIALIZED &&
-            sourceURL != image->getSourceURL()) {
-        sourceURL = image->getSourceURL();
-    }
+    return state == READY;
+}
 
-    if (image->getState() == WebImage::READY && image->getSyncFlag()) {
-        image->setSyncFlag(false);
-
-        if (texture2D->getImage() != NULL) {
-            texture2D->getImage()->setImage(image->getWidth(),
-                                            image->getHeight(),
-                                            1,
-                                            GL_RGBA,
-                                            GL_RGBA,
-                                            GL_UNSIGNED_BYTE,
-                                            image->getImageData(),
-                                            osg::Image::NO_DELETE);
-            texture2D->getImage()->dirty();
-        }
+void
+Texture::upload(const QImage& image)
+{
+    // share the decoded pixels instead of copying them, the const
+    // overload of bits() keeps the image from detaching
+    imageData = image;
+    state = READY;
+
+    if (texture2D->getImage() != NULL) {
+        const QImage& pixels = imageData;
+        texture2D->getImage()->setImage(pixels.width(),
+                                        pixels.height(),
+                                        1,
+                                        GL_RGBA,
+                                        GL_RGBA,
+                                        GL_UNSIGNED_BYTE,
+                                        const_cast<uchar*>(pixels.bits()),
+                                        osg::Image::NO_DELETE);
+        texture2D->getImage()->dirty();
     }
 }
 
@@ -36,6 +36,7 @@ This file is part of the QGROUNDCONTROL project
 #include <osg/ref_ptr>
 #include <osg/Geometry>
 #include <osg/Texture2D>
+#include <QImage>
 #include <QSharedPointer>
 
 #include "WebImage.h"
@@ -43,13 +44,13 @@ This file is part of the QGROUNDCONTROL project
 class Texture
 {
 public:
-    explicit Texture(unsigned int _id);
+    explicit Texture(const QString& _sourceURL);
 
     const QString& getSourceURL(void) const;
 
-    void setId(unsigned int _id);
+    bool isReady(void) const;
 
-    void sync(const WebImagePtr& image);
+    void upload(const QImage& image);
 
     osg::ref_ptr<osg::Geometry> draw(double x1, double y1, double x2, double y2,
                                      double z,
@@ -68,7 +69,7 @@ private:
 
     State state;
     QString sourceURL;
-    unsigned int id;
+    QImage imageData;
     osg::ref_ptr<osg::Texture2D> texture2D;
     osg::ref_ptr<osg::Geometry> geometry;
 };
@@ -31,65 +31,101 @@ This file is part of the QGROUNDCONTROL project
 
 #include "TextureCache.h"
 
-TextureCache::TextureCache(uint32_t _cacheSize)
+TextureCache::TextureCache(uint32_t _cacheSize, uint32_t _uploadsPerFrame,
+                           const QString& diskCacheDir)
     : cacheSize(_cacheSize)
-    , imageCache(new WebImageCache(0, cacheSize))
+    , uploadsPerFrame(_uploadsPerFrame)
+    , imageCache(new WebImageCache(0, cacheSize, diskCacheDir))
 {
-    for (uint32_t i = 0; i < cacheSize; ++i) {
-        TexturePtr t(new Texture(i));
-
-        textures.push_back(t);
-    }
+    index.reserve(cacheSize);
 }
 
 TexturePtr
 TextureCache::get(const QString& tileURL)
 {
-    QPair<TexturePtr, int32_t> p1 = lookup(tileURL);
-    if (!p1.first.isNull()) {
-        return p1.first;
+    QHash<QString, QLinkedList<TexturePtr>::iterator>::iterator it =
+        index.find(tileURL);
+    if (it != index.end()) {
+        TexturePtr t = *it.value();
+
+        // move to the front of the LRU list
+        textures.erase(it.value());
+        it.value() = textures.insert(textures.begin(), t);
+
+        return t;
+    }
+
+    // failed images get no texture, their tile is looked up again later
+    WebImagePtr image = imageCache->lookup(tileURL);
+    if (image.isNull() || image->getState() == WebImage::UNINITIALIZED) {
+        return TexturePtr();
     }
 
-    QPair<WebImagePtr, int32_t> p2 = imageCache->lookup(tileURL);
-    if (!p2.first.isNull()) {
-        textures[p2.second]->sync(p2.first);
-        p1 = lookup(tileURL);
+    TexturePtr t(new Texture(tileURL));
+    index.insert(tileURL, textures.insert(textures.begin(), t));
 
-        return p1.first;
+    // images which are decoded later on are picked up by sync()
+    if (image->getState() == WebImage::READY) {
+        pendingUploads.enqueue(qMakePair(tileURL, image->getImage()));
     }
 
-    return TexturePtr();
+    evict();
+
+    return t;
 }
 
-void
+bool
 TextureCache::sync(void)
 {
-    if (requireSync()) {
-        for (int32_t i = 0; i < textures.size(); ++i) {
-            textures[i]->sync(imageCache->at(i));
+    WebImagePtr image;
+    while (!(image = imageCache->takeReady()).isNull()) {
+        if (index.contains(image->getSourceURL())) {
+            pendingUploads.enqueue(qMakePair(image->getSourceURL(),
+                                             image->getImage()));
         }
     }
-}
 
-QPair<TexturePtr, int32_t>
-TextureCache::lookup(const QString& tileURL)
-{
-    for (int32_t i = 0; i < textures.size(); ++i) {
-        if (textures[i]->getSourceURL() == tileURL) {
-            return qMakePair(textures[i], i);
+    // drop the textures of tiles which failed, they would wait forever
+    QString failedURL;
+    while (!(failedURL = imageCache->takeFailed()).isEmpty()) {
+        QHash<QString, QLinkedList<TexturePtr>::iterator>::iterator it =
+            index.find(failedURL);
+        if (it != index.end() && !(*it.value())->isReady()) {
+            textures.erase(it.value());
+            index.erase(it);
         }
     }
 
-    return qMakePair(TexturePtr(), -1);
+    // limit the texture uploads per frame so that a burst of tiles
+    // arriving while panning does not stall rendering
+    uint32_t uploads = 0;
+    while (uploads < uploadsPerFrame && !pendingUploads.isEmpty()) {
+        QPair<QString, QImage> upload = pendingUploads.dequeue();
+
+        QHash<QString, QLinkedList<TexturePtr>::iterator>::iterator it =
+            index.find(upload.first);
+        if (it == index.end() || (*it.value())->isReady()) {
+            continue;
+        }
+
+        (*it.value())->upload(upload.second);
+        ++uploads;
+    }
+
+    return !pendingUploads.isEmpty() || imageCache->isBusy();
 }
 
 bool
-TextureCache::requireSync(void) const
+TextureCache::isUploading(void) const
 {
-    for (uint32_t i = 0; i < cacheSize; ++i) {
-        if (imageCache->at(i)->getSyncFlag()) {
-            return true;
-        }
+    return !pendingUploads.isEmpty();
+}
+
+void
+TextureCache::evict(void)
+{
+    while (static_cast<uint32_t>(textures.size()) > cacheSize) {
+        index.remove(textures.last()->getSourceURL());
+        textures.removeLast();
     }
-    return false;
 }
@@ -32,7 +32,9 @@ This file is part of the QGROUNDCONTROL project
 #ifndef TEXTURECACHE_H
 #define TEXTURECACHE_H
 
-#include <QVector>
+#include <QHash>
+#include <QLinkedList>
+#include <QQueue>
 
 #include "Texture.h"
 #include "WebImageCache.h"
@@ -40,19 +42,29 @@ This file is part of the QGROUNDCONTROL project
 class TextureCache
 {
 public:
-    explicit TextureCache(uint32_t cacheSize);
+    explicit TextureCache(uint32_t cacheSize, uint32_t uploadsPerFrame = 4,
+                          const QString& diskCacheDir = QString());
 
     TexturePtr get(const QString& tileURL);
 
-    void sync(void);
+    // uploads at most uploadsPerFrame decoded tiles, call once per frame,
+    // returns true while tiles are still on their way
+    bool sync(void);
 
-private:
-    QPair<TexturePtr, int32_t> lookup(const QString& tileURL);
+    // true while decoded tiles wait for their upload
+    bool isUploading(void) const;
 
-    bool requireSync(void) const;
+private:
+    void evict(void);
 
     uint32_t cacheSize;
-    QVector<TexturePtr> textures;
+    uint32_t uploadsPerFrame;
+
+    // most recently used texture first
+    QLinkedList<TexturePtr> textures;
+    QHash<QString, QLinkedList<TexturePtr>::iterator> index;
+
+    QQueue< QPair<QString, QImage> > pendingUploads;
 
     QScopedPointer<WebImageCache> imageCache;
 };
@@ -0,0 +1,166 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the class TrailNode.
+ *
+ */
+
+#include "TrailNode.h"
+
+#include <osg/LineWidth>
+
+TrailNode::TrailNode(const osg::Vec4& _color, int _capacity)
+    : geode(new osg::Geode)
+    , color(new osg::Vec4Array)
+    , stateset(new osg::StateSet)
+    , capacity(_capacity)
+    , count(0)
+{
+    addChild(geode);
+
+    color->push_back(_color);
+
+    osg::ref_ptr<osg::LineWidth> linewidth(new osg::LineWidth());
+    linewidth->setWidth(1.0f);
+    stateset->setAttributeAndModes(linewidth, osg::StateAttribute::ON);
+    stateset->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
+}
+
+void
+TrailNode::addPoint(const osg::Vec3d& point)
+{
+    if (count == 0) {
+        origin = point;
+    }
+
+    osg::Geometry* chunk = NULL;
+    osg::Vec3Array* vertices = NULL;
+    if (geode->getNumDrawables() > 0) {
+        chunk = static_cast<osg::Geometry*>(
+                    geode->getDrawable(geode->getNumDrawables() - 1));
+        vertices = static_cast<osg::Vec3Array*>(chunk->getVertexArray());
+    }
+
+    if (chunk == NULL || static_cast<int>(vertices->size()) >= chunkSize) {
+        osg::ref_ptr<osg::Geometry> newChunk = createChunk();
+        osg::Vec3Array* newVertices =
+            static_cast<osg::Vec3Array*>(newChunk->getVertexArray());
+
+        // start where the previous chunk ended so the line is continuous
+        if (vertices != NULL) {
+            newVertices->push_back(vertices->back());
+            ++count;
+        }
+
+        geode->addDrawable(newChunk);
+        chunk = newChunk.get();
+        vertices = newVertices;
+    }
+
+    // vertices are relative to the first point to keep float precision
+    vertices->push_back(osg::Vec3(point - origin));
+    vertices->dirty();
+    ++count;
+
+    osg::DrawArrays* drawArrays =
+        static_cast<osg::DrawArrays*>(chunk->getPrimitiveSet(0));
+    drawArrays->setCount(vertices->size());
+    chunk->dirtyBound();
+
+    lastPoint = point;
+
+    trim();
+}
+
+const osg::Vec3d&
+TrailNode::getLastPoint(void) const
+{
+    return lastPoint;
+}
+
+bool
+TrailNode::isEmpty(void) const
+{
+    return count == 0;
+}
+
+void
+TrailNode::clear(void)
+{
+    if (geode->getNumDrawables() > 0) {
+        geode->removeDrawables(0, geode->getNumDrawables());
+    }
+    count = 0;
+}
+
+int
+TrailNode::getCapacity(void) const
+{
+    return capacity;
+}
+
+void
+TrailNode::setCapacity(int _capacity)
+{
+    capacity = _capacity;
+    trim();
+}
+
+void
+TrailNode::setOffset(const osg::Vec3d& robotPosition)
+{
+    setMatrix(osg::Matrix::translate(origin - robotPosition));
+}
+
+osg::ref_ptr<osg::Geometry>
+TrailNode::createChunk(void) const
+{
+    osg::ref_ptr<osg::Geometry> chunk(new osg::Geometry);
+    chunk->setUseDisplayList(false);
+    chunk->setUseVertexBufferObjects(true);
+
+    osg::ref_ptr<osg::Vec3Array> vertices(new osg::Vec3Array);
+    vertices->reserve(chunkSize);
+    chunk->setVertexArray(vertices);
+
+    chunk->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::LINE_STRIP, 0, 0));
+
+    chunk->setColorArray(color);
+    chunk->setColorBinding(osg::Geometry::BIND_OVERALL);
+    chunk->setStateSet(stateset);
+
+    return chunk;
+}
+
+void
+TrailNode::trim(void)
+{
+    // drop whole chunks, the newest chunk is always kept
+    while (count > capacity && geode->getNumDrawables() > 1) {
+        osg::Geometry* chunk = static_cast<osg::Geometry*>(geode->getDrawable(0));
+        count -= chunk->getVertexArray()->getNumElements();
+        geode->removeDrawables(0, 1);
+    }
+}
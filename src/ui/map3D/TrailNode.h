@@ -0,0 +1,81 @@
+/*=====================================================================
+
+QGroundControl Open Source Ground Control Station
+
+(c) 2009, 2010 QGROUNDCONTROL PROJECT <http://www.qgroundcontrol.org>
+
+This file is part of the QGROUNDCONTROL project
+
+    QGROUNDCONTROL is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    QGROUNDCONTROL is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with QGROUNDCONTROL. If not, see <http://www.gnu.org/licenses/>.
+
+======================================================================*/
+
+/**
+ * @file
+ *   @brief Definition of the class TrailNode.
+ *
+ */
+
+#ifndef TRAILNODE_H
+#define TRAILNODE_H
+
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/MatrixTransform>
+
+/**
+ * @brief Flight trail of one vehicle in the 3D view.
+ *
+ * The trail is stored in chunks of vertices relative to its first point.
+ * Only the newest chunk changes when a point is added, older chunks are
+ * left untouched on the GPU and the oldest chunk is dropped once the trail
+ * exceeds its capacity. Moving the trail relative to the robot only
+ * changes the transform, not the vertices.
+ */
+class TrailNode : public osg::MatrixTransform
+{
+public:
+    TrailNode(const osg::Vec4& color, int capacity);
+
+    /** @brief Append a point given in scene coordinates */
+    void addPoint(const osg::Vec3d& point);
+    /** @brief Last point of the trail in scene coordinates */
+    const osg::Vec3d& getLastPoint(void) const;
+    bool isEmpty(void) const;
+    void clear(void);
+
+    int getCapacity(void) const;
+    /** @brief Set the maximum number of vertices, the oldest ones are dropped */
+    void setCapacity(int capacity);
+
+    /** @brief Place the trail relative to the robot at the given scene position */
+    void setOffset(const osg::Vec3d& robotPosition);
+
+private:
+    osg::ref_ptr<osg::Geometry> createChunk(void) const;
+    void trim(void);
+
+    static const int chunkSize = 512;
+
+    osg::ref_ptr<osg::Geode> geode;
+    osg::ref_ptr<osg::Vec4Array> color;
+    osg::ref_ptr<osg::StateSet> stateset;
+
+    int capacity;
+    int count;
+    osg::Vec3d origin;
+    osg::Vec3d lastPoint;
+};
+
+#endif // TRAILNODE_H
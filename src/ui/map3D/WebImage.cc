@@ -38,8 +38,9 @@ WebImage::WebImage()
     : state(WebImage::UNINITIALIZED)
     , sourceURL("")
     , image(0)
-    , lastReference(0)
     , syncFlag(false)
+    , newer(0)
+    , older(0)
 {
 
 }
@@ -50,7 +51,6 @@ WebImage::clear(void)
     image.reset();
     sourceURL.clear();
     state = WebImage::UNINITIALIZED;
-    lastReference = 0;
 }
 
 WebImage::State
@@ -83,15 +83,30 @@ WebImage::getImageData(void) const
     return image->scanLine(0);
 }
 
+QImage
+WebImage::getImage(void) const
+{
+    if (image.isNull()) {
+        return QImage();
+    }
+    return *image;
+}
+
+void
+WebImage::setImage(const QImage& _image)
+{
+    if (image.isNull()) {
+        image.reset(new QImage);
+    }
+    *image = _image;
+}
+
 bool
 WebImage::setData(const QByteArray& data)
 {
-    QImage tempImage;
-    if (tempImage.loadFromData(data)) {
-        if (image.isNull()) {
-            image.reset(new QImage);
-        }
-        *image = QGLWidget::convertToGLFormat(tempImage);
+    QImage tempImage = decode(data);
+    if (!tempImage.isNull()) {
+        setImage(tempImage);
 
         return true;
     } else {
@@ -102,12 +117,9 @@ WebImage::setData(const QByteArray& data)
 bool
 WebImage::setData(const QString& filename)
 {
-    QImage tempImage;
-    if (tempImage.load(filename)) {
-        if (image.isNull()) {
-            image.reset(new QImage);
-        }
-        *image = QGLWidget::convertToGLFormat(tempImage);
+    QImage tempImage = decode(filename);
+    if (!tempImage.isNull()) {
+        setImage(tempImage);
 
         return true;
     } else {
@@ -115,6 +127,28 @@ WebImage::setData(const QString& filename)
     }
 }
 
+QImage
+WebImage::decode(const QByteArray& data)
+{
+    QImage tempImage;
+    if (tempImage.loadFromData(data)) {
+        return QGLWidget::convertToGLFormat(tempImage);
+    } else {
+        return QImage();
+    }
+}
+
+QImage
+WebImage::decode(const QString& filename)
+{
+    QImage tempImage;
+    if (tempImage.load(filename)) {
+        return QGLWidget::convertToGLFormat(tempImage);
+    } else {
+        return QImage();
+    }
+}
+
 int
 WebImage::getWidth(void) const
 {
@@ -133,18 +167,6 @@ WebImage::getByteCount(void) const
     return image->byteCount();
 }
 
-ulong
-WebImage::getLastReference(void) const
-{
-    return lastReference;
-}
-
-void
-WebImage::setLastReference(ulong value)
-{
-    lastReference = value;
-}
-
 bool
 WebImage::getSyncFlag(void) const
 {
@@ -35,10 +35,13 @@ This file is part of the QGROUNDCONTROL project
 #include <inttypes.h>
 #include <QImage>
 #include <QScopedPointer>
+#include <QTime>
 #include <QSharedPointer>
 
 class WebImage
 {
+    friend class WebImageCache;
+
 public:
     WebImage();
 
@@ -57,16 +60,18 @@ public:
     void setSourceURL(const QString& url);
 
     uchar* getImageData(void) const;
+    QImage getImage(void) const;
+    void setImage(const QImage& image);
     bool setData(const QByteArray& data);
     bool setData(const QString& filename);
 
+    static QImage decode(const QByteArray& data);
+    static QImage decode(const QString& filename);
+
     int getWidth(void) const;
     int getHeight(void) const;
     int getByteCount(void) const;
 
-    ulong getLastReference(void) const;
-    void setLastReference(ulong value);
-
     bool getSyncFlag(void) const;
     void setSyncFlag(bool onoff);
 
@@ -74,8 +79,14 @@ private:
     State state;
     QString sourceURL;
     QScopedPointer<QImage> image;
-    ulong lastReference;
     bool syncFlag;
+
+    // intrusive LRU list of WebImageCache
+    WebImage* newer;
+    WebImage* older;
+
+    // when the last request failed, see WebImageCache::setRetryInterval()
+    QTime failedTime;
 };
 
 typedef QSharedPointer<WebImage> WebImagePtr;
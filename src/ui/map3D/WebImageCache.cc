@@ -31,96 +31,142 @@ This file is part of the QGROUNDCONTROL project
 
 #include "WebImageCache.h"
 
+#include <QNetworkDiskCache>
 #include <QNetworkReply>
 #include <QPixmap>
+#include <QRunnable>
+#include <QThread>
 
-WebImageCache::WebImageCache(QObject* parent, uint32_t _cacheSize)
+namespace
+{
+
+class DecodeTask : public QRunnable
+{
+public:
+    DecodeTask(QObject* _cache, const QString& _url,
+               const QByteArray& _data, bool _fromFile)
+        : cache(_cache)
+        , url(_url)
+        , data(_data)
+        , fromFile(_fromFile)
+    {
+
+    }
+
+    void run(void)
+    {
+        QImage image = fromFile ? WebImage::decode(url) : WebImage::decode(data);
+
+        QMetaObject::invokeMethod(cache, "imageDecoded", Qt::QueuedConnection,
+                                  Q_ARG(QString, url), Q_ARG(QImage, image));
+    }
+
+private:
+    QObject* cache;
+    QString url;
+    QByteArray data;
+    bool fromFile;
+};
+
+}
+
+WebImageCache::WebImageCache(QObject* parent, uint32_t _cacheSize,
+                             const QString& diskCacheDir,
+                             qint64 diskCacheSize)
     : QObject(parent)
     , cacheSize(_cacheSize)
-    , currentReference(0)
+    , requestedImages(0)
+    , retryInterval(10000)
+    , newest(0)
+    , oldest(0)
     , networkManager(new QNetworkAccessManager)
 {
-    for (uint32_t i = 0; i < cacheSize; ++i) {
-        WebImagePtr image(new WebImage);
+    webImages.reserve(cacheSize);
 
-        webImages.push_back(image);
+    if (!diskCacheDir.isEmpty()) {
+        QNetworkDiskCache* diskCache = new QNetworkDiskCache(networkManager.data());
+        diskCache->setCacheDirectory(diskCacheDir);
+        diskCache->setMaximumCacheSize(diskCacheSize);
+        networkManager->setCache(diskCache);
     }
 
     connect(networkManager.data(), SIGNAL(finished(QNetworkReply*)),
             this, SLOT(downloadFinished(QNetworkReply*)));
+
+    decodePool.setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
 }
 
-QPair<WebImagePtr, int32_t>
-WebImageCache::lookup(const QString& url)
+WebImageCache::~WebImageCache()
 {
-    QPair<WebImagePtr, int32_t> cacheEntry;
+    // pending results are posted to this object, they are discarded
+    // together with it once all decode tasks have finished
+    decodePool.waitForDone();
+}
 
-    for (int32_t i = 0; i < webImages.size(); ++i) {
-        if (webImages[i]->getState() != WebImage::UNINITIALIZED &&
-                webImages[i]->getSourceURL() == url) {
-            cacheEntry.first = webImages[i];
-            cacheEntry.second = i;
-            break;
+WebImagePtr
+WebImageCache::lookup(const QString& url)
+{
+    QHash<QString, WebImagePtr>::iterator it = webImages.find(url);
+    if (it != webImages.end()) {
+        // requests which are still pending are not issued a second time
+        WebImage* image = it.value().data();
+        if (image->getState() == WebImage::READY) {
+            unlink(image);
+            link(image);
+        } else if (image->getState() == WebImage::UNINITIALIZED &&
+                   image->failedTime.elapsed() >= retryInterval) {
+            unlink(image);
+            fetch(image);
         }
+        return it.value();
     }
 
-    if (cacheEntry.first.isNull()) {
-        for (int32_t i = 0; i < webImages.size(); ++i) {
-            // get uninitialized image
-            if (webImages[i]->getState() == WebImage::UNINITIALIZED) {
-                cacheEntry.first = webImages[i];
-                cacheEntry.second = i;
-                break;
-            }
-            // get oldest image
-            else if (webImages[i]->getState() == WebImage::READY &&
-                     (cacheEntry.first.isNull() ||
-                      webImages[i]->getLastReference() <
-                      cacheEntry.first->getLastReference())) {
-                cacheEntry.first = webImages[i];
-                cacheEntry.second = i;
-            }
+    if (static_cast<uint32_t>(webImages.size()) >= cacheSize) {
+        if (oldest == 0) {
+            return WebImagePtr();
         }
 
-        if (cacheEntry.first.isNull()) {
-            return qMakePair(WebImagePtr(), -1);
-        } else {
-            if (cacheEntry.first->getState() == WebImage::READY) {
-                cacheEntry.first->clear();
-            }
-            cacheEntry.first->setSourceURL(url);
-            cacheEntry.first->setLastReference(currentReference);
-            ++currentReference;
-            cacheEntry.first->setState(WebImage::REQUESTED);
-
-            if (url.left(4).compare("http") == 0) {
-                networkManager->get(QNetworkRequest(QUrl(url)));
-            } else {
-                if (cacheEntry.first->setData(url)) {
-                    cacheEntry.first->setSyncFlag(true);
-                    cacheEntry.first->setState(WebImage::READY);
-                } else {
-                    cacheEntry.first->setState(WebImage::UNINITIALIZED);
-                }
-            }
-
-            return cacheEntry;
-        }
-    } else {
-        if (cacheEntry.first->getState() == WebImage::READY) {
-            cacheEntry.first->setLastReference(currentReference);
-            ++currentReference;
-            return cacheEntry;
-        } else {
-            return qMakePair(WebImagePtr(), -1);
-        }
+        WebImage* evicted = oldest;
+        unlink(evicted);
+        webImages.remove(evicted->getSourceURL());
     }
+
+    WebImagePtr image(new WebImage);
+    image->setSourceURL(url);
+    webImages.insert(url, image);
+    fetch(image.data());
+
+    return image;
 }
 
 WebImagePtr
-WebImageCache::at(int32_t index) const
+WebImageCache::takeReady(void)
+{
+    if (readyImages.isEmpty()) {
+        return WebImagePtr();
+    }
+    return readyImages.dequeue();
+}
+
+QString
+WebImageCache::takeFailed(void)
+{
+    if (failedImages.isEmpty()) {
+        return QString();
+    }
+    return failedImages.dequeue();
+}
+
+bool
+WebImageCache::isBusy(void) const
 {
-    return webImages[index];
+    return requestedImages > 0;
+}
+
+void
+WebImageCache::setRetryInterval(int msecs)
+{
+    retryInterval = msecs;
 }
 
 void
@@ -128,22 +174,125 @@ WebImageCache::downloadFinished(QNetworkReply* reply)
 {
     reply->deleteLater();
 
+    QString url = reply->request().attribute(QNetworkRequest::User).toString();
+
     if (reply->error() != QNetworkReply::NoError) {
+        failed(url);
         return;
     }
     QVariant attribute = reply->attribute(QNetworkRequest::RedirectionTargetAttribute);
     if (attribute.isValid()) {
+        failed(url);
         return;
     }
 
-    WebImagePtr image;
-    foreach(image, webImages) {
-        if (reply->url().toString() == image->getSourceURL()) {
-            image->setData(reply->readAll());
-            image->setSyncFlag(true);
-            image->setState(WebImage::READY);
+    decode(url, reply->readAll(), false);
+}
 
-            return;
-        }
+void
+WebImageCache::imageDecoded(const QString& url, const QImage& decodedImage)
+{
+    QHash<QString, WebImagePtr>::iterator it = webImages.find(url);
+    if (it == webImages.end() ||
+            it.value()->getState() != WebImage::REQUESTED) {
+        return;
+    }
+
+    if (decodedImage.isNull()) {
+        failed(url);
+        return;
+    }
+
+    WebImagePtr image = it.value();
+    --requestedImages;
+    image->setImage(decodedImage);
+    image->setSyncFlag(true);
+    image->setState(WebImage::READY);
+    link(image.data());
+
+    readyImages.enqueue(image);
+}
+
+void
+WebImageCache::fetch(WebImage* image)
+{
+    const QString& url = image->getSourceURL();
+    image->setState(WebImage::REQUESTED);
+    ++requestedImages;
+
+    if (url.left(4).compare("http") == 0) {
+        request(url);
+    } else {
+        decode(url, QByteArray(), true);
+    }
+}
+
+void
+WebImageCache::request(const QString& url)
+{
+    QNetworkRequest request = QNetworkRequest(QUrl(url));
+    // the original string identifies the entry, the URL may be normalized
+    request.setAttribute(QNetworkRequest::User, url);
+    // tiles do not change, serve them from the disk cache whenever possible
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute,
+                         QNetworkRequest::PreferCache);
+
+    networkManager->get(request);
+}
+
+void
+WebImageCache::decode(const QString& url, const QByteArray& data, bool fromFile)
+{
+    decodePool.start(new DecodeTask(this, url, data, fromFile));
+}
+
+void
+WebImageCache::failed(const QString& url)
+{
+    QHash<QString, WebImagePtr>::iterator it = webImages.find(url);
+    if (it == webImages.end() ||
+            it.value()->getState() != WebImage::REQUESTED) {
+        return;
+    }
+
+    // keep the failed entry so that it is not requested again on every
+    // lookup, it is retried after the retry interval or once it has been
+    // evicted
+    --requestedImages;
+    it.value()->setState(WebImage::UNINITIALIZED);
+    it.value()->failedTime.start();
+    link(it.value().data());
+
+    failedImages.enqueue(url);
+}
+
+void
+WebImageCache::link(WebImage* image)
+{
+    image->older = newest;
+    image->newer = 0;
+    if (newest != 0) {
+        newest->newer = image;
+    }
+    newest = image;
+    if (oldest == 0) {
+        oldest = image;
+    }
+}
+
+void
+WebImageCache::unlink(WebImage* image)
+{
+    if (image->newer != 0) {
+        image->newer->older = image->older;
+    } else if (newest == image) {
+        newest = image->older;
+    }
+    if (image->older != 0) {
+        image->older->newer = image->newer;
+    } else if (oldest == image) {
+        oldest = image->newer;
     }
+    image->newer = 0;
+    image->older = 0;
 }
@@ -32,9 +32,11 @@ This file is part of the QGROUNDCONTROL project
 #ifndef WEBIMAGECACHE_H
 #define WEBIMAGECACHE_H
 
+#include <QHash>
 #include <QNetworkAccessManager>
 #include <QObject>
-#include <QPair>
+#include <QQueue>
+#include <QThreadPool>
 
 #include "WebImage.h"
 
@@ -43,22 +45,61 @@ class WebImageCache : public QObject
     Q_OBJECT
 
 public:
-    WebImageCache(QObject* parent, uint32_t cacheSize);
+    // downloaded tiles are also kept in diskCacheDir if it is not empty
+    WebImageCache(QObject* parent, uint32_t cacheSize,
+                  const QString& diskCacheDir = QString(),
+                  qint64 diskCacheSize = 256 * 1024 * 1024);
+    ~WebImageCache();
 
-    QPair<WebImagePtr, int32_t> lookup(const QString& url);
+    // returns the cached image, requesting it if it is not cached yet,
+    // or a null pointer if all entries are busy with pending requests
+    WebImagePtr lookup(const QString& url);
 
-    WebImagePtr at(int32_t index) const;
+    // returns the next image that finished decoding, or a null pointer
+    WebImagePtr takeReady(void);
+
+    // returns the URL of the next image that could not be downloaded or
+    // decoded, or an empty string
+    QString takeFailed(void);
+
+    // true while images are being downloaded or decoded
+    bool isBusy(void) const;
+
+    // failed images are requested again when they are looked up at least
+    // msecs after they failed
+    void setRetryInterval(int msecs);
 
 private Q_SLOTS:
     void downloadFinished(QNetworkReply* reply);
+    void imageDecoded(const QString& url, const QImage& image);
 
 private:
+    void fetch(WebImage* image);
+    void request(const QString& url);
+    void decode(const QString& url, const QByteArray& data, bool fromFile);
+    void failed(const QString& url);
+
+    void link(WebImage* image);
+    void unlink(WebImage* image);
+
     uint32_t cacheSize;
+    int requestedImages;
+    int retryInterval;
 
-    QVector<WebImagePtr> webImages;
-    uint64_t currentReference;
+    // all entries by URL, only the ones which are not pending are in
+    // the LRU list and can be evicted. Failed entries are not moved
+    // to the front when they are looked up, so they age out while
+    // they wait to be retried.
+    QHash<QString, WebImagePtr> webImages;
+    WebImage* newest;
+    WebImage* oldest;
 
     QScopedPointer<QNetworkAccessManager> networkManager;
+
+    // images are decoded off the render thread
+    QThreadPool decodePool;
+    QQueue<WebImagePtr> readyImages;
+    QQueue<QString> failedImages;
 };
 
 #endif // WEBIMAGECACHE_H
@@ -37,6 +37,7 @@ This file is part of the PIXHAWK project
 #include "QGC.h"
 #include "MG.h"
 #include "UASManager.h"
+#include "QGCFrameScheduler.h"
 #include "UASView.h"
 #include "UASWaypointManager.h"
 #include "ui_UASView.h"
@@ -126,10 +127,8 @@ UASView::UASView(UASInterface* uas, QWidget *parent) :
 
     setBackgroundColor();
 
-    // Heartbeat fade
-    refreshTimer = new QTimer(this);
-    connect(refreshTimer, SIGNAL(timeout()), this, SLOT(refresh()));
-    refreshTimer->start(updateInterval);
+    // Heartbeat fade, refreshed continuously while visible
+    QGCFrameScheduler::instance()->registerWidget(this, updateInterval, "refresh", true);
 
     // Hide kill and shutdown buttons per default
     m_ui->killButton->hide();
@@ -248,15 +247,13 @@ void UASView::showEvent(QShowEvent* event)
     // React only to internal (pre-display)
     // events
     Q_UNUSED(event);
-    refreshTimer->start(updateInterval);
+    QGCFrameScheduler::instance()->markDirty(this);
 }
 
 void UASView::hideEvent(QHideEvent* event)
 {
-    // React only to internal (pre-display)
-    // events
+    // Hidden widgets are skipped by the frame scheduler
     Q_UNUSED(event);
-    refreshTimer->stop();
 }
 
 void UASView::receiveHeartbeat(UASInterface* uas)
@@ -94,7 +94,6 @@ public slots:
 
 protected:
     void changeEvent(QEvent *e);
-    QTimer* refreshTimer;
     QColor heartbeatColor;
     quint64 startTime;
     bool timeout;